@@ -71,6 +71,7 @@
 #include "libavutil/bprint.h"
 #include "libavutil/dict.h"
 #include "libavutil/mem.h"
+#include "libavutil/object_cache.h"
 #include "libavutil/time.h"
 
 #include "libavformat/avformat.h"
@@ -359,6 +360,7 @@ static void ffmpeg_cleanup(int ret)
     av_freep(&filter_nbthreads);
 
     av_freep(&print_graphs_file);
+    av_freep(&filter_thread_type);
     av_freep(&print_graphs_format);
 
     av_freep(&input_files);
@@ -1041,6 +1043,8 @@ int main(int argc, char **argv)
     android_binder_threadpool_init_if_required();
 #endif
 
+    av_object_cache_enable(object_cache);
+
     current_time = ti = get_benchmark_time_stamps();
     ret = transcode(sch);
     if (ret >= 0 && do_benchmark) {
@@ -1052,6 +1056,26 @@ int main(int argc, char **argv)
         av_log(NULL, AV_LOG_INFO,
                "bench: utime=%0.3fs stime=%0.3fs rtime=%0.3fs\n",
                utime / 1000000.0, stime / 1000000.0, rtime / 1000000.0);
+
+        if (object_cache) {
+            static const char * const names[AV_OBJECT_CACHE_NB] = {
+                [AV_OBJECT_CACHE_FRAME]      = "frame",
+                [AV_OBJECT_CACHE_PACKET]     = "packet",
+                [AV_OBJECT_CACHE_BUFFER_REF] = "bufref",
+            };
+
+            for (int i = 0; i < AV_OBJECT_CACHE_NB; i++) {
+                AVObjectCacheStats st;
+
+                if (av_object_cache_get_stats(i, &st) < 0)
+                    continue;
+
+                av_log(NULL, AV_LOG_INFO,
+                       "bench: %s cache hits=%"PRIu64" misses=%"PRIu64
+                       " cached=%"PRIu64" evicted=%"PRIu64"\n", names[i],
+                       st.hits, st.misses, st.cached, st.evicted);
+            }
+        }
     }
 
     ret = received_nb_signals                 ? 255 :
@@ -460,6 +460,10 @@ typedef struct Decoder {
     uint64_t         frames_decoded;
     uint64_t         samples_decoded;
     uint64_t         decode_errors;
+
+    // number of bytes of frame data that had to be copied after decoding,
+    // e.g. when downloading hardware frames
+    uint64_t         bytes_copied;
 } Decoder;
 
 typedef struct InputStream {
@@ -751,6 +755,7 @@ extern enum VideoSyncMethod video_sync_method;
 extern float frame_drop_threshold;
 extern int do_benchmark;
 extern int do_benchmark_all;
+extern int object_cache;
 extern int do_hex_dump;
 extern int do_pkt_dump;
 extern int copy_ts;
@@ -768,6 +773,7 @@ extern float max_error_rate;
 extern char *filter_nbthreads;
 extern int filter_complex_nbthreads;
 extern int filter_buffered_frames;
+extern char *filter_thread_type;
 extern int vstats_version;
 extern int print_graphs;
 extern char *print_graphs_file;
@@ -22,6 +22,7 @@
 #include "libavutil/avstring.h"
 #include "libavutil/dict.h"
 #include "libavutil/error.h"
+#include "libavutil/imgutils.h"
 #include "libavutil/log.h"
 #include "libavutil/mem.h"
 #include "libavutil/opt.h"
@@ -373,6 +374,10 @@ static int hwaccel_retrieve_data(AVCodecContext *avctx, AVFrame *input)
         goto fail;
     }
 
+    err = av_image_get_buffer_size(output->format, output->width, output->height, 1);
+    if (err > 0)
+        dp->dec.bytes_copied += err;
+
     av_frame_unref(input);
     av_frame_move_ref(input, output);
     av_frame_free(&output);
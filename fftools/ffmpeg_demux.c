@@ -978,6 +978,9 @@ static void demux_final_stats(Demuxer *d)
                    ist->decoder->frames_decoded, ist->decoder->decode_errors);
             if (type == AVMEDIA_TYPE_AUDIO)
                 av_log(f, AV_LOG_VERBOSE, " (%"PRIu64" samples)", ist->decoder->samples_decoded);
+            if (ist->decoder->bytes_copied)
+                av_log(f, AV_LOG_VERBOSE, "; %"PRIu64" bytes of decoded data copied",
+                       ist->decoder->bytes_copied);
             av_log(f, AV_LOG_VERBOSE, "; ");
         }
 
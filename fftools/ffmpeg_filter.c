@@ -2209,6 +2209,12 @@ static int configure_filtergraph(FilterGraph *fg, FilterGraphThread *fgt)
             return ret;
     }
 
+    if (filter_thread_type) {
+        ret = av_opt_set(fgt->graph, "thread_type", filter_thread_type, 0);
+        if (ret < 0)
+            return ret;
+    }
+
     hw_device = hw_device_for_filter();
 
     ret = graph_parse(fg, fgt->graph, graph_desc, &inputs, &outputs, hw_device);
@@ -3182,8 +3188,8 @@ static int send_frame(FilterGraph *fg, FilterGraphThread *fgt,
 {
     FilterGraphPriv *fgp = fgp_from_fg(fg);
     InputFilterPriv *ifp = ifp_from_ifilter(ifilter);
-    FrameData       *fd;
     AVFrameSideData *sd;
+    int buffersrc_flags = AV_BUFFERSRC_FLAG_PUSH;
     int need_reinit = 0, ret;
 
     /* determine if the parameters for this input changed */
@@ -3205,6 +3211,16 @@ static int send_frame(FilterGraph *fg, FilterGraphThread *fgt,
         break;
     }
 
+    /* The buffer source is configured with the same parameters we just
+     * compared against, or will be reconfigured with those of this frame
+     * below; there is no need for it to validate them again. Frames with
+     * an unspecified channel layout still need it to fill in the layout it
+     * was configured with. */
+    if (!(need_reinit & (AUDIO_CHANGED | VIDEO_CHANGED)) &&
+        (ifilter->type != AVMEDIA_TYPE_AUDIO ||
+         frame->ch_layout.order != AV_CHANNEL_ORDER_UNSPEC))
+        buffersrc_flags |= AV_BUFFERSRC_FLAG_NO_CHECK_FORMAT;
+
     if (sd = av_frame_get_side_data(frame, AV_FRAME_DATA_DISPLAYMATRIX)) {
         if (!ifp->displaymatrix_present ||
             memcmp(sd->data, ifp->displaymatrix, sizeof(ifp->displaymatrix)))
@@ -3327,13 +3343,17 @@ static int send_frame(FilterGraph *fg, FilterGraphThread *fgt,
     if (ifp->displaymatrix_applied)
         av_frame_remove_side_data(frame, AV_FRAME_DATA_DISPLAYMATRIX);
 
-    fd = frame_data(frame);
-    if (!fd)
-        return AVERROR(ENOMEM);
-    fd->wallclock[LATENCY_PROBE_FILTER_PRE] = av_gettime_relative();
+    /* The latency probes are only ever printed with -debug_ts. Making the
+     * frame data writable requires duplicating it when the decoded frame is
+     * also sent elsewhere, so avoid that for every frame otherwise. */
+    if (debug_ts) {
+        FrameData *fd = frame_data(frame);
+        if (!fd)
+            return AVERROR(ENOMEM);
+        fd->wallclock[LATENCY_PROBE_FILTER_PRE] = av_gettime_relative();
+    }
 
-    ret = av_buffersrc_add_frame_flags(ifilter->filter, frame,
-                                       AV_BUFFERSRC_FLAG_PUSH);
+    ret = av_buffersrc_add_frame_flags(ifilter->filter, frame, buffersrc_flags);
     if (ret < 0) {
         av_frame_unref(frame);
         if (ret != AVERROR_EOF)
@@ -42,6 +42,7 @@
 #include "libavutil/avassert.h"
 #include "libavutil/avstring.h"
 #include "libavutil/avutil.h"
+#include "libavutil/cpu.h"
 #include "libavutil/mathematics.h"
 #include "libavutil/mem.h"
 #include "libavutil/opt.h"
@@ -59,6 +60,7 @@ float dts_error_threshold   = 3600*30;
 float frame_drop_threshold = 0;
 int do_benchmark      = 0;
 int do_benchmark_all  = 0;
+int object_cache      = 0;
 int do_hex_dump       = 0;
 int do_pkt_dump       = 0;
 int copy_ts           = 0;
@@ -73,6 +75,7 @@ float max_error_rate  = 2.0/3;
 char *filter_nbthreads;
 int filter_complex_nbthreads = 0;
 int filter_buffered_frames = 0;
+char *filter_thread_type;
 int vstats_version = 2;
 int print_graphs = 0;
 char *print_graphs_file = NULL;
@@ -696,6 +699,31 @@ static int opt_sdp_file(void *optctx, const char *opt, const char *arg)
     return sch_sdp_filename(go->sch, arg);
 }
 
+static int opt_sched_trace(void *optctx, const char *opt, const char *arg)
+{
+    GlobalOptionsContext *go = optctx;
+    return sch_trace_filename(go->sch, arg);
+}
+
+static int opt_sched_workers(void *optctx, const char *opt, const char *arg)
+{
+    GlobalOptionsContext *go = optctx;
+    double nb_workers;
+    int ret;
+
+    if (!strcmp(arg, "auto")) {
+        sch_set_workers(go->sch, av_cpu_count());
+        return 0;
+    }
+
+    ret = parse_number(opt, arg, OPT_TYPE_INT, 0, INT_MAX, &nb_workers);
+    if (ret < 0)
+        return ret;
+
+    sch_set_workers(go->sch, nb_workers);
+    return 0;
+}
+
 #if CONFIG_VAAPI
 static int opt_vaapi_device(void *optctx, const char *opt, const char *arg)
 {
@@ -1650,6 +1678,9 @@ const OptionDef options[] = {
     { "benchmark_all",          OPT_TYPE_BOOL, OPT_EXPERT,
         { &do_benchmark_all },
       "add timings for each task" },
+    { "object_cache",           OPT_TYPE_BOOL, OPT_EXPERT,
+        { &object_cache },
+      "cache frame/packet/buffer reference structures per thread" },
     { "progress",               OPT_TYPE_FUNC, OPT_FUNC_ARG | OPT_EXPERT,
         { .func_arg = opt_progress },
       "write program-readable progress information", "url" },
@@ -1749,6 +1780,9 @@ const OptionDef options[] = {
     { "filter_buffered_frames", OPT_TYPE_INT, OPT_EXPERT,
         { &filter_buffered_frames },
         "maximum number of buffered frames in a filter graph" },
+    { "filter_thread_type",     OPT_TYPE_STRING, OPT_EXPERT,
+        { &filter_thread_type },
+        "allowed threading types in filter graphs", "flags" },
     { "reinit_filter",          OPT_TYPE_INT, OPT_PERSTREAM | OPT_INPUT | OPT_EXPERT,
         { .off = OFFSET(reinit_filters) },
         "reinit filtergraph on input parameter changes", "" },
@@ -2037,6 +2071,12 @@ const OptionDef options[] = {
     { "muxpreload", OPT_TYPE_FLOAT, OPT_EXPERT | OPT_OFFSET | OPT_OUTPUT,
         { .off = OFFSET(mux_preload) },
         "set the initial demux-decode delay", "seconds" },
+    { "sched_workers", OPT_TYPE_FUNC, OPT_FUNC_ARG | OPT_EXPERT,
+        { .func_arg = opt_sched_workers },
+        "maximum number of concurrently running transcoding tasks", "number" },
+    { "sched_trace", OPT_TYPE_FUNC, OPT_FUNC_ARG | OPT_EXPERT,
+        { .func_arg = opt_sched_trace },
+        "write a trace of the transcoding tasks to a file", "file" },
     { "sdp_file",   OPT_TYPE_FUNC, OPT_FUNC_ARG | OPT_EXPERT | OPT_OUTPUT,
         { .func_arg = opt_sdp_file },
         "specify a file in which to print sdp information", "file" },
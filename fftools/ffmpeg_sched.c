@@ -26,12 +26,14 @@
 #include "cmdutils.h"
 #include "ffmpeg_sched.h"
 #include "ffmpeg_utils.h"
+#include "sched_trace.h"
 #include "sync_queue.h"
 #include "thread_queue.h"
 
 #include "libavcodec/packet.h"
 
 #include "libavutil/avassert.h"
+#include "libavutil/avstring.h"
 #include "libavutil/error.h"
 #include "libavutil/fifo.h"
 #include "libavutil/frame.h"
@@ -69,6 +71,18 @@ typedef struct SchTask {
 
     pthread_t           thread;
     int                 thread_running;
+
+    // Nesting depth of task_park() calls; the task holds a run slot while
+    // this is zero (when the number of workers is limited, see
+    // sch_set_workers()). Only accessed from the task's own thread.
+    int                 parked;
+
+    // track index in the trace, unique for each task
+    int                 trace_id;
+    // state of the outermost task_park() call, only used when tracing
+    const char         *park_op;
+    int64_t             park_ts;
+    int64_t             park_cpu;
 } SchTask;
 
 typedef struct SchDecOutput {
@@ -309,6 +323,17 @@ struct Scheduler {
     pthread_mutex_t     schedule_lock;
 
     atomic_int_least64_t last_dts;
+
+    // run slots shared by all the tasks, 0 means unlimited
+    unsigned            nb_workers;
+    unsigned            nb_workers_free;
+    pthread_mutex_t     workers_lock;
+    pthread_cond_t      workers_cond;
+
+    unsigned         nb_tasks;
+
+    char               *trace_filename;
+    SchTrace           *trace;
 };
 
 /**
@@ -369,8 +394,89 @@ static void waiter_uninit(SchWaiter *w)
     pthread_cond_destroy(&w->cond);
 }
 
+/**
+ * Give up the run slot held by this task before it (potentially) blocks
+ * inside the scheduler, so that some other task may run in the meantime.
+ * Calls may be nested, each must be matched by task_unpark().
+ */
+static void task_park(Scheduler *sch, SchTask *task, const char *op)
+{
+    if (task->parked++)
+        return;
+
+    if (sch->trace) {
+        task->park_op  = op;
+        task->park_ts  = trace_now();
+        task->park_cpu = trace_thread_cpu_time();
+    }
+
+    if (!sch->nb_workers)
+        return;
+
+    pthread_mutex_lock(&sch->workers_lock);
+
+    sch->nb_workers_free++;
+    pthread_cond_signal(&sch->workers_cond);
+
+    pthread_mutex_unlock(&sch->workers_lock);
+}
+
+/**
+ * Wait until a run slot is available and take it, before returning control
+ * to the task code.
+ */
+static void task_unpark(Scheduler *sch, SchTask *task)
+{
+    if (--task->parked)
+        return;
+
+    if (sch->nb_workers) {
+        pthread_mutex_lock(&sch->workers_lock);
+
+        while (!sch->nb_workers_free)
+            pthread_cond_wait(&sch->workers_cond, &sch->workers_lock);
+        sch->nb_workers_free--;
+
+        pthread_mutex_unlock(&sch->workers_lock);
+    }
+
+    if (sch->trace) {
+        int64_t cpu = trace_thread_cpu_time();
+        trace_slice(sch->trace, task->trace_id, task->park_op, task->park_ts,
+                    trace_now(), cpu >= 0 ? cpu - task->park_cpu : -1);
+    }
+}
+
+static void task_name(const SchTask *task, char *buf, size_t size)
+{
+    static const char * const names[] = {
+        [SCH_NODE_TYPE_DEMUX]     = "demux",
+        [SCH_NODE_TYPE_MUX]       = "mux",
+        [SCH_NODE_TYPE_DEC]       = "dec",
+        [SCH_NODE_TYPE_ENC]       = "enc",
+        [SCH_NODE_TYPE_FILTER_IN] = "filter",
+    };
+
+    snprintf(buf, size, "%s%u", names[task->node.type], task->node.idx);
+}
+
+// record the current depth of the queue this task receives from
+static void trace_queue(Scheduler *sch, const SchTask *task, ThreadQueue *tq)
+{
+    char name[32];
+
+    if (!sch->trace)
+        return;
+
+    task_name(task, name, sizeof(name));
+    av_strlcat(name, " queue", sizeof(name));
+
+    trace_counter(sch->trace, task->trace_id, name, trace_now(),
+                  tq_nb_queued(tq));
+}
+
 static int queue_alloc(ThreadQueue **ptq, unsigned nb_streams, unsigned queue_size,
-                       enum QueueType type)
+                       enum QueueType type, int single_producer)
 {
     ThreadQueue *tq;
 
@@ -391,7 +497,8 @@ static int queue_alloc(ThreadQueue **ptq, unsigned nb_streams, unsigned queue_si
     }
 
     tq = tq_alloc(nb_streams, queue_size,
-                  (type == QUEUE_PACKETS) ? THREAD_QUEUE_PACKETS : THREAD_QUEUE_FRAMES);
+                  (type == QUEUE_PACKETS) ? THREAD_QUEUE_PACKETS : THREAD_QUEUE_FRAMES,
+                  single_producer ? THREAD_QUEUE_ALLOC_SINGLE_PRODUCER : 0);
     if (!tq)
         return AVERROR(ENOMEM);
 
@@ -433,6 +540,11 @@ static void task_init(Scheduler *sch, SchTask *task, enum SchedulerNodeType type
 
     task->func      = func;
     task->func_arg  = func_arg;
+
+    // the run slot is taken in task_wrapper(), once the thread is running
+    task->parked    = 1;
+
+    task->trace_id  = sch->nb_tasks++;
 }
 
 static int64_t trailing_dts(const Scheduler *sch)
@@ -597,6 +709,9 @@ void sch_free(Scheduler **psch)
 
     av_freep(&sch->sdp_filename);
 
+    trace_free(&sch->trace);
+    av_freep(&sch->trace_filename);
+
     pthread_mutex_destroy(&sch->schedule_lock);
 
     pthread_mutex_destroy(&sch->mux_ready_lock);
@@ -604,6 +719,9 @@ void sch_free(Scheduler **psch)
     pthread_mutex_destroy(&sch->finish_lock);
     pthread_cond_destroy(&sch->finish_cond);
 
+    pthread_mutex_destroy(&sch->workers_lock);
+    pthread_cond_destroy(&sch->workers_cond);
+
     av_freep(psch);
 }
 
@@ -640,12 +758,37 @@ Scheduler *sch_alloc(void)
     if (ret)
         goto fail;
 
+    ret = pthread_mutex_init(&sch->workers_lock, NULL);
+    if (ret)
+        goto fail;
+
+    ret = pthread_cond_init(&sch->workers_cond, NULL);
+    if (ret)
+        goto fail;
+
     return sch;
 fail:
     sch_free(&sch);
     return NULL;
 }
 
+void sch_set_workers(Scheduler *sch, unsigned nb_workers)
+{
+    av_assert0(sch->state == SCH_STATE_UNINIT);
+
+    sch->nb_workers      = nb_workers;
+    sch->nb_workers_free = nb_workers;
+}
+
+int sch_trace_filename(Scheduler *sch, const char *trace_filename)
+{
+    av_assert0(sch->state == SCH_STATE_UNINIT);
+
+    av_freep(&sch->trace_filename);
+    sch->trace_filename = av_strdup(trace_filename);
+    return sch->trace_filename ? 0 : AVERROR(ENOMEM);
+}
+
 int sch_sdp_filename(Scheduler *sch, const char *sdp_filename)
 {
     av_freep(&sch->sdp_filename);
@@ -799,10 +942,6 @@ int sch_add_dec(Scheduler *sch, SchThreadFunc func, void *ctx, int send_end_ts)
     if (ret < 0)
         return ret;
 
-    ret = queue_alloc(&dec->queue, 1, 0, QUEUE_PACKETS);
-    if (ret < 0)
-        return ret;
-
     if (send_end_ts) {
         ret = av_thread_message_queue_alloc(&dec->queue_end_ts, 1, sizeof(Timestamp));
         if (ret < 0)
@@ -843,7 +982,9 @@ int sch_add_enc(Scheduler *sch, SchThreadFunc func, void *ctx,
     if (!enc->send_pkt)
         return AVERROR(ENOMEM);
 
-    ret = queue_alloc(&enc->queue, 1, 0, QUEUE_FRAMES);
+    // frames are sent either from the single source thread, or from
+    // send_to_enc_sq() with the sync queue lock held
+    ret = queue_alloc(&enc->queue, 1, 0, QUEUE_FRAMES, 1);
     if (ret < 0)
         return ret;
 
@@ -891,7 +1032,7 @@ int sch_add_filtergraph(Scheduler *sch, unsigned nb_inputs, unsigned nb_outputs,
     if (ret < 0)
         return ret;
 
-    ret = queue_alloc(&fg->queue, fg->nb_inputs + 1, 0, QUEUE_FRAMES);
+    ret = queue_alloc(&fg->queue, fg->nb_inputs + 1, 0, QUEUE_FRAMES, 0);
     if (ret < 0)
         return ret;
 
@@ -1502,6 +1643,10 @@ static void schedule_update_locked(Scheduler *sch)
             SchWaiter *w = &sch->field[i].waiter;                              \
             if (w->choked_prev != w->choked_next) {                            \
                 waiter_set(w, w->choked_next);                                 \
+                if (sch->trace)                                                \
+                    trace_instant(sch->trace, sch->field[i].task.trace_id,     \
+                                  w->choked_next ? "choke" : "unchoke",        \
+                                  trace_now());                                \
                 if (offsetof(Scheduler, field) == offsetof(Scheduler, demux))  \
                     choke_demux(sch, i, w->choked_next);                       \
             }                                                                  \
@@ -1646,6 +1791,7 @@ static int start_prepare(Scheduler *sch)
 
     for (unsigned i = 0; i < sch->nb_dec; i++) {
         SchDec *dec = &sch->dec[i];
+        int single_producer = 1;
 
         if (!dec->src.type) {
             av_log(dec, AV_LOG_ERROR,
@@ -1653,6 +1799,24 @@ static int start_prepare(Scheduler *sch)
             return AVERROR(EINVAL);
         }
 
+        // subtitle heartbeat packets are sent from muxer threads, in
+        // addition to the packets from our source
+        for (unsigned j = 0; j < sch->nb_mux; j++) {
+            const SchMux *mux = &sch->mux[j];
+
+            for (unsigned k = 0; k < mux->nb_streams; k++) {
+                const SchMuxStream *ms = &mux->streams[k];
+
+                for (unsigned l = 0; l < ms->nb_sub_heartbeat_dst; l++)
+                    if (ms->sub_heartbeat_dst[l] == i)
+                        single_producer = 0;
+            }
+        }
+
+        ret = queue_alloc(&dec->queue, 1, 0, QUEUE_PACKETS, single_producer);
+        if (ret < 0)
+            return ret;
+
         for (unsigned j = 0; j < dec->nb_outputs; j++) {
             SchDecOutput *o = &dec->outputs[j];
 
@@ -1700,8 +1864,9 @@ static int start_prepare(Scheduler *sch)
             }
         }
 
+        // each muxed stream is fed by its own thread
         ret = queue_alloc(&mux->queue, mux->nb_streams, mux->queue_size,
-                          QUEUE_PACKETS);
+                          QUEUE_PACKETS, mux->nb_streams == 1);
         if (ret < 0)
             return ret;
     }
@@ -1747,6 +1912,13 @@ int sch_start(Scheduler *sch)
         return ret;
 
     av_assert0(sch->state == SCH_STATE_UNINIT);
+
+    if (sch->trace_filename) {
+        sch->trace = trace_alloc();
+        if (!sch->trace)
+            return AVERROR(ENOMEM);
+    }
+
     sch->state = SCH_STATE_STARTED;
 
     for (unsigned i = 0; i < sch->nb_mux; i++) {
@@ -2180,22 +2352,27 @@ int sch_demux_send(Scheduler *sch, unsigned demux_idx, AVPacket *pkt,
                    unsigned flags)
 {
     SchDemux *d;
-    int terminate;
+    int ret;
 
     av_assert0(demux_idx < sch->nb_demux);
     d = &sch->demux[demux_idx];
 
-    terminate = waiter_wait(sch, &d->waiter);
-    if (terminate)
-        return AVERROR_EXIT;
+    task_park(sch, &d->task, "send");
 
+    if (waiter_wait(sch, &d->waiter))
+        ret = AVERROR_EXIT;
     // flush the downstreams after seek
-    if (pkt->stream_index == -1)
-        return demux_flush(sch, d, pkt);
+    else if (pkt->stream_index == -1)
+        ret = demux_flush(sch, d, pkt);
+    else {
+        av_assert0(pkt->stream_index < d->nb_streams);
+        ret = demux_send_for_stream(sch, d, &d->streams[pkt->stream_index],
+                                    pkt, flags);
+    }
 
-    av_assert0(pkt->stream_index < d->nb_streams);
+    task_unpark(sch, &d->task);
 
-    return demux_send_for_stream(sch, d, &d->streams[pkt->stream_index], pkt, flags);
+    return ret;
 }
 
 static int demux_done(Scheduler *sch, unsigned demux_idx)
@@ -2228,7 +2405,11 @@ int sch_mux_receive(Scheduler *sch, unsigned mux_idx, AVPacket *pkt)
     av_assert0(mux_idx < sch->nb_mux);
     mux = &sch->mux[mux_idx];
 
+    task_park(sch, &mux->task, "receive");
+    trace_queue(sch, &mux->task, mux->queue);
     ret = tq_receive(mux->queue, &stream_idx, pkt, 0);
+    task_unpark(sch, &mux->task);
+
     pkt->stream_index = stream_idx;
     return ret;
 }
@@ -2271,7 +2452,9 @@ int sch_mux_sub_heartbeat(Scheduler *sch, unsigned mux_idx, unsigned stream_idx,
         if (ret < 0)
             return ret;
 
+        task_park(sch, &mux->task, "heartbeat");
         tq_send(dst->queue, 0, mux->sub_heartbeat_pkt);
+        task_unpark(sch, &mux->task);
     }
 
     return 0;
@@ -2312,12 +2495,15 @@ int sch_dec_receive(Scheduler *sch, unsigned dec_idx, AVPacket *pkt)
     av_assert0(dec_idx < sch->nb_dec);
     dec = &sch->dec[dec_idx];
 
+    task_park(sch, &dec->task, "receive");
+    trace_queue(sch, &dec->task, dec->queue);
+
     // the decoder should have given us post-flush end timestamp in pkt
     if (dec->expect_end_ts) {
         Timestamp ts = (Timestamp){ .ts = pkt->pts, .tb = pkt->time_base };
         ret = av_thread_message_queue_send(dec->queue_end_ts, &ts, 0);
         if (ret < 0)
-            return ret;
+            goto finish;
 
         dec->expect_end_ts = 0;
     }
@@ -2330,6 +2516,8 @@ int sch_dec_receive(Scheduler *sch, unsigned dec_idx, AVPacket *pkt)
     if (ret >= 0 && !pkt->data && !pkt->side_data_elems && dec->queue_end_ts)
         dec->expect_end_ts = 1;
 
+finish:
+    task_unpark(sch, &dec->task);
     return ret;
 }
 
@@ -2400,6 +2588,8 @@ int sch_dec_send(Scheduler *sch, unsigned dec_idx,
     av_assert0(out_idx < dec->nb_outputs);
     o = &dec->outputs[out_idx];
 
+    task_park(sch, &dec->task, "send");
+
     for (unsigned i = 0; i < o->nb_dst; i++) {
         uint8_t *finished = &o->dst_finished[i];
         AVFrame *to_send  = frame;
@@ -2413,7 +2603,7 @@ int sch_dec_send(Scheduler *sch, unsigned dec_idx,
             ret = frame->buf[0] ? av_frame_ref(to_send, frame) :
                                   av_frame_copy_props(to_send, frame);
             if (ret < 0)
-                return ret;
+                goto finish;
         }
 
         ret = dec_send_to_dst(sch, o->dst[i], finished, to_send);
@@ -2423,11 +2613,14 @@ int sch_dec_send(Scheduler *sch, unsigned dec_idx,
                 nb_done++;
                 continue;
             }
-            return ret;
+            goto finish;
         }
     }
 
-    return (nb_done == o->nb_dst) ? AVERROR_EOF : 0;
+    ret = (nb_done == o->nb_dst) ? AVERROR_EOF : 0;
+finish:
+    task_unpark(sch, &dec->task);
+    return ret;
 }
 
 static int dec_done(Scheduler *sch, unsigned dec_idx)
@@ -2463,7 +2656,10 @@ int sch_enc_receive(Scheduler *sch, unsigned enc_idx, AVFrame *frame)
     av_assert0(enc_idx < sch->nb_enc);
     enc = &sch->enc[enc_idx];
 
+    task_park(sch, &enc->task, "receive");
+    trace_queue(sch, &enc->task, enc->queue);
     ret = tq_receive(enc->queue, &dummy, frame, 0);
+    task_unpark(sch, &enc->task);
     av_assert0(dummy <= 0);
 
     return ret;
@@ -2507,6 +2703,8 @@ int sch_enc_send(Scheduler *sch, unsigned enc_idx, AVPacket *pkt)
     av_assert0(enc_idx < sch->nb_enc);
     enc = &sch->enc[enc_idx];
 
+    task_park(sch, &enc->task, "send");
+
     for (unsigned i = 0; i < enc->nb_dst; i++) {
         uint8_t *finished = &enc->dst_finished[i];
         AVPacket *to_send = pkt;
@@ -2517,7 +2715,7 @@ int sch_enc_send(Scheduler *sch, unsigned enc_idx, AVPacket *pkt)
 
             ret = av_packet_ref(to_send, pkt);
             if (ret < 0)
-                return ret;
+                goto finish;
         }
 
         ret = enc_send_to_dst(sch, enc->dst[i], finished, to_send);
@@ -2525,11 +2723,14 @@ int sch_enc_send(Scheduler *sch, unsigned enc_idx, AVPacket *pkt)
             av_packet_unref(to_send);
             if (ret == AVERROR_EOF)
                 continue;
-            return ret;
+            goto finish;
         }
     }
 
-    return 0;
+    ret = 0;
+finish:
+    task_unpark(sch, &enc->task);
+    return ret;
 }
 
 static int enc_done(Scheduler *sch, unsigned enc_idx)
@@ -2548,15 +2749,11 @@ static int enc_done(Scheduler *sch, unsigned enc_idx)
     return ret;
 }
 
-int sch_filter_receive(Scheduler *sch, unsigned fg_idx,
-                       unsigned *in_idx, AVFrame *frame)
+static int filter_receive(Scheduler *sch, SchFilterGraph *fg,
+                          unsigned *in_idx, AVFrame *frame)
 {
-    SchFilterGraph *fg;
     int ret, idx;
 
-    av_assert0(fg_idx < sch->nb_filters);
-    fg = &sch->filters[fg_idx];
-
     av_assert0(*in_idx <= fg->nb_inputs);
 
     // update scheduling to account for desired input stream, if it changed
@@ -2599,6 +2796,23 @@ int sch_filter_receive(Scheduler *sch, unsigned fg_idx,
     }
 }
 
+int sch_filter_receive(Scheduler *sch, unsigned fg_idx,
+                       unsigned *in_idx, AVFrame *frame)
+{
+    SchFilterGraph *fg;
+    int ret;
+
+    av_assert0(fg_idx < sch->nb_filters);
+    fg = &sch->filters[fg_idx];
+
+    task_park(sch, &fg->task, "receive");
+    trace_queue(sch, &fg->task, fg->queue);
+    ret = filter_receive(sch, fg, in_idx, frame);
+    task_unpark(sch, &fg->task);
+
+    return ret;
+}
+
 void sch_filter_receive_finish(Scheduler *sch, unsigned fg_idx, unsigned in_idx)
 {
     SchFilterGraph *fg;
@@ -2638,6 +2852,8 @@ int sch_filter_send(Scheduler *sch, unsigned fg_idx, unsigned out_idx, AVFrame *
     av_assert0(out_idx < fg->nb_outputs);
     dst = fg->outputs[out_idx].dst;
 
+    task_park(sch, &fg->task, "send");
+
     if (dst.type == SCH_NODE_TYPE_ENC) {
         ret = send_to_enc(sch, &sch->enc[dst.idx], frame);
         if (ret == AVERROR_EOF)
@@ -2647,6 +2863,9 @@ int sch_filter_send(Scheduler *sch, unsigned fg_idx, unsigned out_idx, AVFrame *
         if (ret == AVERROR_EOF)
             send_to_filter(sch, &sch->filters[dst.idx], dst.idx_stream, NULL);
     }
+
+    task_unpark(sch, &fg->task);
+
     return ret;
 }
 
@@ -2717,17 +2936,41 @@ static void *task_wrapper(void *arg)
 {
     SchTask  *task = arg;
     Scheduler *sch = task->parent;
+    int64_t start_ts = 0;
     int ret;
     int err = 0;
 
+    if (sch->trace) {
+        char name[32];
+
+        task_name(task, name, sizeof(name));
+        trace_track_name(sch->trace, task->trace_id, name);
+
+        start_ts = trace_now();
+
+        // the initial wait for a run slot
+        task->park_op  = "start";
+        task->park_ts  = start_ts;
+        task->park_cpu = trace_thread_cpu_time();
+    }
+
+    task_unpark(sch, task);
+
     ret = task->func(task->func_arg);
     if (ret < 0)
         av_log(task->func_arg, AV_LOG_ERROR,
                "Task finished with error: %s\n", av_err2str(ret));
 
+    // cleanup may block sending EOFs downstream
+    task_park(sch, task, "finish");
+
     err = task_cleanup(sch, task->node);
     ret = err_merge(ret, err);
 
+    if (sch->trace)
+        trace_slice(sch->trace, task->trace_id, "task", start_ts, trace_now(),
+                    trace_thread_cpu_time());
+
     // EOF is considered normal termination
     if (ret == AVERROR_EOF)
         ret = 0;
@@ -2828,6 +3071,11 @@ int sch_stop(Scheduler *sch, int64_t *finish_ts)
     if (finish_ts)
         *finish_ts = progressing_dts(sch, 1);
 
+    if (sch->trace) {
+        err = trace_write(sch->trace, sch->trace_filename);
+        ret = err_merge(ret, err);
+    }
+
     sch->state = SCH_STATE_STOPPED;
 
     return ret;
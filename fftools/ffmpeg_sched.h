@@ -291,6 +291,36 @@ void sch_mux_stream_buffering(Scheduler *sch, unsigned mux_idx, unsigned stream_
  */
 int sch_mux_stream_ready(Scheduler *sch, unsigned mux_idx, unsigned stream_idx);
 
+/**
+ * Limit the number of tasks that may execute their own code concurrently.
+ *
+ * Every task still runs in its own thread, but it has to hold one of
+ * nb_workers run slots while it is outside of the scheduler. A task gives up
+ * its slot whenever it calls into the scheduler (where it might block waiting
+ * for other tasks) and takes one again before returning. This avoids
+ * oversubscribing the CPU with transcodes that contain many more components
+ * than there are cores.
+ *
+ * Must be called before sch_start().
+ *
+ * @param nb_workers maximum number of concurrently running tasks,
+ *                   0 means no limit (the default)
+ */
+void sch_set_workers(Scheduler *sch, unsigned nb_workers);
+
+/**
+ * Record a timeline of the transcoding and write it to the given file in the
+ * Chrome trace-event JSON format when the scheduler is stopped.
+ *
+ * The trace contains one track per task, with the time each task spent
+ * inside the scheduler (waiting for input or output queues, or for being
+ * unchoked) and its total CPU time, the depths of the task input queues, and
+ * the choke/unchoke events.
+ *
+ * Must be called before sch_start().
+ */
+int sch_trace_filename(Scheduler *sch, const char *trace_filename);
+
 /**
  * Set the file path for the SDP.
  *
@@ -0,0 +1,276 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include "config.h"
+
+#include <inttypes.h>
+#include <stdint.h>
+#include <string.h>
+
+#if HAVE_CLOCK_GETTIME
+#include <time.h>
+#elif HAVE_GETPROCESSTIMES
+#include <windows.h>
+#endif
+
+#include "sched_trace.h"
+
+#include "libavformat/avio.h"
+
+#include "libavutil/avstring.h"
+#include "libavutil/error.h"
+#include "libavutil/log.h"
+#include "libavutil/mem.h"
+#include "libavutil/thread.h"
+#include "libavutil/time.h"
+
+enum TraceEventType {
+    TRACE_SLICE,
+    TRACE_COUNTER,
+    TRACE_INSTANT,
+};
+
+typedef struct TraceEvent {
+    enum TraceEventType type;
+    int                 tid;
+    int64_t             ts;
+    // duration for slices, value for counters
+    int64_t             val;
+    int64_t             cpu_us;
+    char                name[32];
+} TraceEvent;
+
+typedef struct TraceTrack {
+    int                 tid;
+    char                name[32];
+} TraceTrack;
+
+struct SchTrace {
+    int64_t             start;
+
+    TraceEvent         *events;
+    size_t           nb_events;
+    size_t              events_allocated;
+
+    TraceTrack         *tracks;
+    int              nb_tracks;
+
+    // set when we failed to allocate memory for an event, the trace
+    // is incomplete from that point on
+    int                 oom;
+
+    pthread_mutex_t     lock;
+};
+
+SchTrace *trace_alloc(void)
+{
+    SchTrace *tr = av_mallocz(sizeof(*tr));
+
+    if (!tr)
+        return NULL;
+
+    if (pthread_mutex_init(&tr->lock, NULL)) {
+        av_freep(&tr);
+        return NULL;
+    }
+
+    tr->start = av_gettime_relative();
+
+    return tr;
+}
+
+void trace_free(SchTrace **ptr)
+{
+    SchTrace *tr = *ptr;
+
+    if (!tr)
+        return;
+
+    av_freep(&tr->events);
+    av_freep(&tr->tracks);
+    pthread_mutex_destroy(&tr->lock);
+
+    av_freep(ptr);
+}
+
+int64_t trace_now(void)
+{
+    return av_gettime_relative();
+}
+
+int64_t trace_thread_cpu_time(void)
+{
+#if HAVE_CLOCK_GETTIME && defined(CLOCK_THREAD_CPUTIME_ID)
+    struct timespec ts;
+
+    if (clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts))
+        return -1;
+    return ts.tv_sec * 1000000LL + ts.tv_nsec / 1000;
+#elif HAVE_GETPROCESSTIMES
+    FILETIME c, e, k, u;
+
+    if (!GetThreadTimes(GetCurrentThread(), &c, &e, &k, &u))
+        return -1;
+    return (((int64_t)u.dwHighDateTime << 32 | u.dwLowDateTime) +
+            ((int64_t)k.dwHighDateTime << 32 | k.dwLowDateTime)) / 10;
+#else
+    return -1;
+#endif
+}
+
+void trace_track_name(SchTrace *tr, int tid, const char *name)
+{
+    TraceTrack *t;
+
+    pthread_mutex_lock(&tr->lock);
+
+    t = av_dynarray2_add((void**)&tr->tracks, &tr->nb_tracks,
+                         sizeof(*tr->tracks), NULL);
+    if (t) {
+        t->tid = tid;
+        av_strlcpy(t->name, name, sizeof(t->name));
+    } else
+        tr->oom = 1;
+
+    pthread_mutex_unlock(&tr->lock);
+}
+
+static void event_add(SchTrace *tr, enum TraceEventType type, int tid,
+                      const char *name, int64_t ts, int64_t val, int64_t cpu_us)
+{
+    TraceEvent *ev;
+
+    pthread_mutex_lock(&tr->lock);
+
+    if (tr->oom)
+        goto finish;
+
+    if (tr->nb_events == tr->events_allocated) {
+        size_t new_size = FFMAX(2 * tr->events_allocated, 1024);
+
+        ev = av_realloc_array(tr->events, new_size, sizeof(*tr->events));
+        if (!ev) {
+            tr->oom = 1;
+            goto finish;
+        }
+
+        tr->events           = ev;
+        tr->events_allocated = new_size;
+    }
+
+    ev = &tr->events[tr->nb_events++];
+
+    ev->type   = type;
+    ev->tid    = tid;
+    ev->ts     = ts;
+    ev->val    = val;
+    ev->cpu_us = cpu_us;
+    av_strlcpy(ev->name, name, sizeof(ev->name));
+
+finish:
+    pthread_mutex_unlock(&tr->lock);
+}
+
+void trace_slice(SchTrace *tr, int tid, const char *name,
+                 int64_t start, int64_t end, int64_t cpu_us)
+{
+    event_add(tr, TRACE_SLICE, tid, name, start, end - start, cpu_us);
+}
+
+void trace_counter(SchTrace *tr, int tid, const char *name,
+                   int64_t ts, int64_t value)
+{
+    event_add(tr, TRACE_COUNTER, tid, name, ts, value, -1);
+}
+
+void trace_instant(SchTrace *tr, int tid, const char *name, int64_t ts)
+{
+    event_add(tr, TRACE_INSTANT, tid, name, ts, 0, -1);
+}
+
+int trace_write(SchTrace *tr, const char *filename)
+{
+    AVIOContext *io;
+    const char *sep = "";
+    int ret;
+
+    ret = avio_open2(&io, filename, AVIO_FLAG_WRITE, NULL, NULL);
+    if (ret < 0) {
+        av_log(NULL, AV_LOG_ERROR, "Could not open trace file '%s': %s\n",
+               filename, av_err2str(ret));
+        return ret;
+    }
+
+    pthread_mutex_lock(&tr->lock);
+
+    if (tr->oom)
+        av_log(NULL, AV_LOG_WARNING, "Out of memory while tracing, the "
+               "trace written to '%s' is incomplete\n", filename);
+
+    avio_printf(io, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+
+    for (int i = 0; i < tr->nb_tracks; i++) {
+        const TraceTrack *t = &tr->tracks[i];
+
+        avio_printf(io, "%s{\"ph\":\"M\",\"pid\":1,\"tid\":%d,"
+                    "\"name\":\"thread_name\",\"args\":{\"name\":\"%s\"}}",
+                    sep, t->tid, t->name);
+        avio_printf(io, ",\n{\"ph\":\"M\",\"pid\":1,\"tid\":%d,"
+                    "\"name\":\"thread_sort_index\",\"args\":{\"sort_index\":%d}}",
+                    t->tid, t->tid);
+        sep = ",\n";
+    }
+
+    for (size_t i = 0; i < tr->nb_events; i++) {
+        const TraceEvent *ev = &tr->events[i];
+        int64_t ts = ev->ts - tr->start;
+
+        switch (ev->type) {
+        case TRACE_SLICE:
+            avio_printf(io, "%s{\"ph\":\"X\",\"pid\":1,\"tid\":%d,\"name\":\"%s\","
+                        "\"ts\":%"PRId64",\"dur\":%"PRId64,
+                        sep, ev->tid, ev->name, ts, ev->val);
+            if (ev->cpu_us >= 0)
+                avio_printf(io, ",\"args\":{\"cpu_us\":%"PRId64"}", ev->cpu_us);
+            avio_printf(io, "}");
+            break;
+        case TRACE_COUNTER:
+            avio_printf(io, "%s{\"ph\":\"C\",\"pid\":1,\"tid\":%d,\"name\":\"%s\","
+                        "\"ts\":%"PRId64",\"args\":{\"value\":%"PRId64"}}",
+                        sep, ev->tid, ev->name, ts, ev->val);
+            break;
+        case TRACE_INSTANT:
+            avio_printf(io, "%s{\"ph\":\"i\",\"s\":\"t\",\"pid\":1,\"tid\":%d,"
+                        "\"name\":\"%s\",\"ts\":%"PRId64"}",
+                        sep, ev->tid, ev->name, ts);
+            break;
+        }
+        sep = ",\n";
+    }
+
+    avio_printf(io, "\n]}\n");
+
+    pthread_mutex_unlock(&tr->lock);
+
+    ret = avio_closep(&io);
+    if (ret < 0)
+        av_log(NULL, AV_LOG_ERROR, "Error writing trace file '%s': %s\n",
+               filename, av_err2str(ret));
+
+    return ret;
+}
@@ -0,0 +1,78 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#ifndef FFTOOLS_SCHED_TRACE_H
+#define FFTOOLS_SCHED_TRACE_H
+
+#include <stdint.h>
+
+/**
+ * Collector for scheduler trace events, written out in the Chrome
+ * trace-event JSON format that can be loaded into chrome://tracing or
+ * Perfetto.
+ *
+ * Every track (tid) corresponds to one scheduler task. All the functions
+ * adding events may be called concurrently from any thread. Timestamps are
+ * in microseconds as returned by av_gettime_relative().
+ */
+typedef struct SchTrace SchTrace;
+
+SchTrace *trace_alloc(void);
+void      trace_free(SchTrace **ptr);
+
+/**
+ * Get the current trace timestamp.
+ */
+int64_t trace_now(void);
+
+/**
+ * Get the CPU time used so far by the calling thread in microseconds,
+ * or a negative value if not supported on this platform.
+ */
+int64_t trace_thread_cpu_time(void);
+
+/**
+ * Set the human-readable name of a track.
+ */
+void trace_track_name(SchTrace *tr, int tid, const char *name);
+
+/**
+ * Add a slice covering [start, end] on the given track.
+ *
+ * @param cpu_us CPU time spent during the slice, a negative value if unknown
+ */
+void trace_slice(SchTrace *tr, int tid, const char *name,
+                 int64_t start, int64_t end, int64_t cpu_us);
+
+/**
+ * Add a counter sample. Counters are grouped by name.
+ */
+void trace_counter(SchTrace *tr, int tid, const char *name,
+                   int64_t ts, int64_t value);
+
+/**
+ * Add an instant event to the given track.
+ */
+void trace_instant(SchTrace *tr, int tid, const char *name, int64_t ts);
+
+/**
+ * Write all the events collected so far to a file.
+ */
+int trace_write(SchTrace *tr, const char *filename);
+
+#endif // FFTOOLS_SCHED_TRACE_H
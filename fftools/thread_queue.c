@@ -16,6 +16,7 @@
  * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
  */
 
+#include <stdatomic.h>
 #include <stdint.h>
 #include <string.h>
 
@@ -37,9 +38,39 @@ enum {
     FINISHED_RECV = (1 << 1),
 };
 
+// bounds for the number of polling iterations before a thread goes to sleep
+#define SPIN_MIN 16
+#define SPIN_MAX 4096
+
+/*
+ * Lock-free ring used for single-producer queues. The producer only ever
+ * writes tail, the consumer only ever writes head; both are monotonically
+ * increasing counters, the slot index is obtained modulo size.
+ *
+ * The mutex/condition variable of the queue is only used for sleeping when
+ * the ring is full/empty and for the (rare) state changes done by
+ * tq_choke()/tq_*_finish().
+ */
+typedef struct Ring {
+    void          **items;
+    unsigned       *stream_index;
+    size_t          size;
+
+    atomic_size_t   head;
+    atomic_size_t   tail;
+
+    // set while the respective side is sleeping on ThreadQueue.cond
+    atomic_int      recv_waiting;
+    atomic_int      send_waiting;
+
+    // current spinning budget, only accessed by the respective side
+    int             recv_spin;
+    int             send_spin;
+} Ring;
+
 struct ThreadQueue {
-    int             choked;
-    int              *finished;
+    atomic_int      choked;
+    atomic_int     *finished;
     unsigned int    nb_streams;
 
     enum ThreadQueueType type;
@@ -47,10 +78,106 @@ struct ThreadQueue {
     AVContainerFifo *fifo;
     AVFifo          *fifo_stream_index;
 
+    // non-NULL iff allocated with THREAD_QUEUE_ALLOC_SINGLE_PRODUCER
+    Ring           *ring;
+
     pthread_mutex_t lock;
     pthread_cond_t  cond;
 };
 
+static void item_free(ThreadQueue *tq, void **item)
+{
+    if (tq->type == THREAD_QUEUE_FRAMES)
+        av_frame_free((AVFrame**)item);
+    else
+        av_packet_free((AVPacket**)item);
+}
+
+static void item_move(ThreadQueue *tq, void *dst, void *src)
+{
+    if (tq->type == THREAD_QUEUE_FRAMES)
+        av_frame_move_ref(dst, src);
+    else
+        av_packet_move_ref(dst, src);
+}
+
+static void item_unref(ThreadQueue *tq, void *item)
+{
+    if (tq->type == THREAD_QUEUE_FRAMES)
+        av_frame_unref(item);
+    else
+        av_packet_unref(item);
+}
+
+static void ring_free(ThreadQueue *tq)
+{
+    Ring *r = tq->ring;
+
+    if (!r)
+        return;
+
+    if (r->items) {
+        for (size_t i = 0; i < r->size; i++)
+            item_free(tq, &r->items[i]);
+    }
+    av_freep(&r->items);
+    av_freep(&r->stream_index);
+
+    av_freep(&tq->ring);
+}
+
+static int ring_alloc(ThreadQueue *tq, size_t size)
+{
+    Ring *r;
+
+    r = tq->ring = av_mallocz(sizeof(*r));
+    if (!r)
+        return AVERROR(ENOMEM);
+
+    r->items        = av_calloc(size, sizeof(*r->items));
+    r->stream_index = av_calloc(size, sizeof(*r->stream_index));
+    if (!r->items || !r->stream_index)
+        return AVERROR(ENOMEM);
+    r->size = size;
+
+    for (size_t i = 0; i < size; i++) {
+        r->items[i] = (tq->type == THREAD_QUEUE_FRAMES) ?
+                      (void*)av_frame_alloc() : (void*)av_packet_alloc();
+        if (!r->items[i])
+            return AVERROR(ENOMEM);
+    }
+
+    atomic_init(&r->head,         0);
+    atomic_init(&r->tail,         0);
+    atomic_init(&r->recv_waiting, 0);
+    atomic_init(&r->send_waiting, 0);
+
+    r->recv_spin = SPIN_MIN;
+    r->send_spin = SPIN_MIN;
+
+    return 0;
+}
+
+/* Wake up the other side if it is sleeping. The caller must have just
+ * published a change to head/tail, which is ordered before the load of
+ * *waiting, just like the sleeper's store to *waiting is ordered before its
+ * final check of head/tail. Hence at least one of them observes the other. */
+static void ring_wake(ThreadQueue *tq, atomic_int *waiting)
+{
+    if (!atomic_load(waiting))
+        return;
+
+    pthread_mutex_lock(&tq->lock);
+    pthread_cond_broadcast(&tq->cond);
+    pthread_mutex_unlock(&tq->lock);
+}
+
+// grow the spinning budget when spinning succeeded, shrink it otherwise
+static void spin_update(int *spin, int success)
+{
+    *spin = success ? FFMIN(*spin * 2, SPIN_MAX) : FFMAX(*spin / 2, SPIN_MIN);
+}
+
 void tq_free(ThreadQueue **ptq)
 {
     ThreadQueue *tq = *ptq;
@@ -60,6 +187,7 @@ void tq_free(ThreadQueue **ptq)
 
     av_container_fifo_free(&tq->fifo);
     av_fifo_freep2(&tq->fifo_stream_index);
+    ring_free(tq);
 
     av_freep(&tq->finished);
 
@@ -70,7 +198,7 @@ void tq_free(ThreadQueue **ptq)
 }
 
 ThreadQueue *tq_alloc(unsigned int nb_streams, size_t queue_size,
-                      enum ThreadQueueType type)
+                      enum ThreadQueueType type, unsigned flags)
 {
     ThreadQueue *tq;
     int ret;
@@ -95,10 +223,20 @@ ThreadQueue *tq_alloc(unsigned int nb_streams, size_t queue_size,
     tq->finished = av_calloc(nb_streams, sizeof(*tq->finished));
     if (!tq->finished)
         goto fail;
+    for (unsigned int i = 0; i < nb_streams; i++)
+        atomic_init(&tq->finished[i], 0);
     tq->nb_streams = nb_streams;
 
+    atomic_init(&tq->choked, 0);
+
     tq->type = type;
 
+    if (flags & THREAD_QUEUE_ALLOC_SINGLE_PRODUCER) {
+        if (ring_alloc(tq, queue_size) < 0)
+            goto fail;
+        return tq;
+    }
+
     tq->fifo = (type == THREAD_QUEUE_FRAMES) ?
                av_container_fifo_alloc_avframe(0) : av_container_fifo_alloc_avpacket(0);
     if (!tq->fifo)
@@ -114,12 +252,67 @@ fail:
     return NULL;
 }
 
+static int ring_can_send(ThreadQueue *tq, size_t tail, atomic_int *finished)
+{
+    return (atomic_load(finished) & FINISHED_RECV) ||
+           tail - atomic_load(&tq->ring->head) < tq->ring->size;
+}
+
+static int ring_send(ThreadQueue *tq, unsigned int stream_idx, void *data)
+{
+    Ring        *r = tq->ring;
+    atomic_int  *finished = &tq->finished[stream_idx];
+    size_t       tail = atomic_load_explicit(&r->tail, memory_order_relaxed);
+    size_t       slot;
+
+    if (atomic_load(finished) & FINISHED_SEND)
+        return AVERROR(EINVAL);
+
+    if (!ring_can_send(tq, tail, finished)) {
+        int i;
+
+        for (i = 0; i < r->send_spin; i++)
+            if (ring_can_send(tq, tail, finished))
+                break;
+        spin_update(&r->send_spin, i < r->send_spin);
+
+        if (i == r->send_spin) {
+            pthread_mutex_lock(&tq->lock);
+
+            atomic_store(&r->send_waiting, 1);
+            while (!ring_can_send(tq, tail, finished))
+                pthread_cond_wait(&tq->cond, &tq->lock);
+            atomic_store(&r->send_waiting, 0);
+
+            pthread_mutex_unlock(&tq->lock);
+        }
+    }
+
+    if (atomic_load(finished) & FINISHED_RECV) {
+        atomic_fetch_or(finished, FINISHED_SEND);
+        return AVERROR_EOF;
+    }
+
+    slot = tail % r->size;
+    item_move(tq, r->items[slot], data);
+    r->stream_index[slot] = stream_idx;
+
+    atomic_store(&r->tail, tail + 1);
+    ring_wake(tq, &r->recv_waiting);
+
+    return 0;
+}
+
 int tq_send(ThreadQueue *tq, unsigned int stream_idx, void *data)
 {
-    int *finished;
+    atomic_int *finished;
     int ret;
 
     av_assert0(stream_idx < tq->nb_streams);
+
+    if (tq->ring)
+        return ring_send(tq, stream_idx, data);
+
     finished = &tq->finished[stream_idx];
 
     pthread_mutex_lock(&tq->lock);
@@ -194,12 +387,113 @@ static int receive_locked(ThreadQueue *tq, int *stream_idx,
     return nb_finished == tq->nb_streams ? AVERROR_EOF : AVERROR(EAGAIN);
 }
 
+/* Same semantics as receive_locked(), but only needs the lock for sleeping.
+ * *consumed is set to 1 when at least one item was removed from the ring. */
+static int ring_receive_try(ThreadQueue *tq, int *stream_idx, void *data,
+                            int *consumed)
+{
+    Ring        *r = tq->ring;
+    size_t       head = atomic_load_explicit(&r->head, memory_order_relaxed);
+    unsigned int nb_finished = 0;
+
+    if (atomic_load(&tq->choked))
+        return AVERROR(EAGAIN);
+
+retry:
+    while (head != atomic_load(&r->tail)) {
+        size_t   slot = head % r->size;
+        unsigned idx  = r->stream_index[slot];
+
+        item_move(tq, data, r->items[slot]);
+        atomic_store(&r->head, ++head);
+        *consumed = 1;
+
+        if (atomic_load(&tq->finished[idx]) & FINISHED_RECV) {
+            item_unref(tq, data);
+            continue;
+        }
+
+        *stream_idx = idx;
+        return 0;
+    }
+
+    for (unsigned int i = 0; i < tq->nb_streams; i++) {
+        int finished = atomic_load(&tq->finished[i]);
+
+        if (!finished)
+            continue;
+
+        if (!(finished & FINISHED_RECV)) {
+            /* items sent before the stream was finished must be returned
+             * before the EOF; they are visible now that we have observed
+             * the finished flag */
+            if (head != atomic_load(&r->tail))
+                goto retry;
+
+            atomic_fetch_or(&tq->finished[i], FINISHED_RECV);
+            *stream_idx   = i;
+            return AVERROR_EOF;
+        }
+
+        nb_finished++;
+    }
+
+    return nb_finished == tq->nb_streams ? AVERROR_EOF : AVERROR(EAGAIN);
+}
+
+static int ring_receive(ThreadQueue *tq, int *stream_idx, void *data, int flags)
+{
+    Ring *r = tq->ring;
+    int consumed = 0;
+    int ret, i;
+
+    ret = ring_receive_try(tq, stream_idx, data, &consumed);
+    if (ret != AVERROR(EAGAIN) || (flags & THREAD_QUEUE_FLAG_NO_BLOCK))
+        goto finish;
+
+    for (i = 0; i < r->recv_spin; i++) {
+        ret = ring_receive_try(tq, stream_idx, data, &consumed);
+        if (ret != AVERROR(EAGAIN))
+            break;
+    }
+    spin_update(&r->recv_spin, i < r->recv_spin);
+    if (ret != AVERROR(EAGAIN))
+        goto finish;
+
+    pthread_mutex_lock(&tq->lock);
+
+    atomic_store(&r->recv_waiting, 1);
+    while (1) {
+        ret = ring_receive_try(tq, stream_idx, data, &consumed);
+        if (ret != AVERROR(EAGAIN))
+            break;
+        pthread_cond_wait(&tq->cond, &tq->lock);
+    }
+    atomic_store(&r->recv_waiting, 0);
+
+    // we hold the lock, so wake up the producer directly
+    if (consumed && atomic_load(&r->send_waiting))
+        pthread_cond_broadcast(&tq->cond);
+    consumed = 0;
+
+    pthread_mutex_unlock(&tq->lock);
+
+finish:
+    if (consumed)
+        ring_wake(tq, &r->send_waiting);
+
+    return ret;
+}
+
 int tq_receive(ThreadQueue *tq, int *stream_idx, void *data, int flags)
 {
     int ret;
 
     *stream_idx = -1;
 
+    if (tq->ring)
+        return ring_receive(tq, stream_idx, data, flags);
+
     pthread_mutex_lock(&tq->lock);
 
     while (1) {
@@ -266,3 +560,20 @@ void tq_choke(ThreadQueue *tq, int choked)
 
     pthread_mutex_unlock(&tq->lock);
 }
+
+size_t tq_nb_queued(ThreadQueue *tq)
+{
+    size_t ret;
+
+    if (tq->ring) {
+        // load head first, so that the result can never be negative
+        size_t head = atomic_load(&tq->ring->head);
+        return atomic_load(&tq->ring->tail) - head;
+    }
+
+    pthread_mutex_lock(&tq->lock);
+    ret = av_container_fifo_can_read(tq->fifo);
+    pthread_mutex_unlock(&tq->lock);
+
+    return ret;
+}
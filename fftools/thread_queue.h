@@ -32,6 +32,15 @@ enum ThreadQueueFlags {
     THREAD_QUEUE_FLAG_NO_BLOCK = (1 << 0),
 };
 
+enum ThreadQueueAllocFlags {
+    /* The caller guarantees that tq_send() is never called concurrently from
+     * more than one thread, e.g. because there is only one producer thread or
+     * all producers are serialized by an external lock. Items are then passed
+     * through a lock-free ring buffer and the queue lock is only taken to
+     * sleep when the ring is full/empty or to change the queue state. */
+    THREAD_QUEUE_ALLOC_SINGLE_PRODUCER = (1 << 0),
+};
+
 typedef struct ThreadQueue ThreadQueue;
 
 /**
@@ -41,9 +50,10 @@ typedef struct ThreadQueue ThreadQueue;
  *                   maintained
  * @param queue_size number of items that can be stored in the queue without
  *                   blocking
+ * @param flags combination of THREAD_QUEUE_ALLOC_*
  */
 ThreadQueue *tq_alloc(unsigned int nb_streams, size_t queue_size,
-                      enum ThreadQueueType type);
+                      enum ThreadQueueType type, unsigned flags);
 void         tq_free(ThreadQueue **tq);
 
 /**
@@ -73,6 +83,12 @@ void tq_send_finish(ThreadQueue *tq, unsigned int stream_idx);
  */
 void tq_choke(ThreadQueue *tq, int choked);
 
+/**
+ * Get the number of items currently waiting in the queue. Intended for
+ * diagnostics only, the value may be outdated by the time it is returned.
+ */
+size_t tq_nb_queued(ThreadQueue *tq);
+
 /**
  * Read the next item from the queue.
  *
@@ -20,6 +20,7 @@
 
 #include "config.h"
 
+#include <stdatomic.h>
 #include <stdbool.h>
 
 #include "libavutil/mem.h"
@@ -43,28 +44,51 @@
 
 #endif //!HAVE_THREADS
 
-typedef struct ThreadInfo {
-    FFExecutor *e;
-    ExecutorThread thread;
-} ThreadInfo;
-
 typedef struct Queue {
     FFTask *head;
     FFTask *tail;
 } Queue;
 
+/*
+ * With worker threads, every worker owns one queue per priority. New tasks are
+ * distributed round-robin over the workers, a worker takes tasks from its own
+ * queues first and steals from the other workers when those are empty. This
+ * way the workers do not all contend on a single lock, which otherwise limits
+ * scaling with many threads and many small tasks.
+ */
+typedef struct ThreadInfo {
+    FFExecutor *e;
+    ExecutorThread thread;
+
+    AVMutex lock;   // protects q
+    Queue *q;
+
+    // number of tasks in q, may be read without holding lock
+    atomic_int nb_tasks;
+} ThreadInfo;
+
 struct FFExecutor {
     FFTaskCallbacks cb;
     int thread_count;
     bool recursive;
 
     ThreadInfo *threads;
+    // number of threads with initialized queues, the workers may already run
+    // while thread_count is still being incremented
+    int nb_queues;
     uint8_t *local_contexts;
 
+    // protects die, workers sleep on cond
     AVMutex lock;
     AVCond cond;
     int die;
 
+    // number of workers sleeping on cond
+    atomic_int nb_idle;
+    // worker that receives the next task
+    atomic_uint next;
+
+    // used when thread_count is 0
     Queue *q;
 };
 
@@ -89,46 +113,96 @@ static void add_task(Queue *q, FFTask *t)
         q->tail = q->tail->next = t;
 }
 
-static int run_one_task(FFExecutor *e, void *lc)
+#if HAVE_THREADS
+static FFTask *take_task(ThreadInfo *ti, int priority)
 {
-    FFTaskCallbacks *cb = &e->cb;
-    FFTask *t = NULL;
+    FFTask *t;
 
-    for (int i = 0; i < e->cb.priorities && !t; i++)
-        t = remove_task(e->q + i);
+    if (!atomic_load(&ti->nb_tasks))
+        return NULL;
 
-    if (t) {
-        if (e->thread_count > 0)
-            ff_mutex_unlock(&e->lock);
-        cb->run(t, lc, cb->user_data);
-        if (e->thread_count > 0)
-            ff_mutex_lock(&e->lock);
-        return 1;
+    ff_mutex_lock(&ti->lock);
+    t = remove_task(ti->q + priority);
+    ff_mutex_unlock(&ti->lock);
+
+    if (t)
+        atomic_fetch_sub(&ti->nb_tasks, 1);
+
+    return t;
+}
+
+// find the highest priority task, preferring the worker's own queues
+static FFTask *find_task(FFExecutor *e, ThreadInfo *self)
+{
+    const int idx = self - e->threads;
+
+    for (int i = 0; i < e->cb.priorities; i++) {
+        for (int j = 0; j < e->nb_queues; j++) {
+            ThreadInfo *ti = e->threads + (idx + j) % e->nb_queues;
+            FFTask *t = take_task(ti, i);
+            if (t)
+                return t;
+        }
     }
+
+    return NULL;
+}
+
+static int have_tasks(FFExecutor *e)
+{
+    for (int i = 0; i < e->nb_queues; i++)
+        if (atomic_load(&e->threads[i].nb_tasks))
+            return 1;
     return 0;
 }
 
-#if HAVE_THREADS
 static void *executor_worker_task(void *data)
 {
     ThreadInfo *ti = (ThreadInfo*)data;
     FFExecutor *e  = ti->e;
     void *lc       = e->local_contexts + (ti - e->threads) * e->cb.local_context_size;
 
-    ff_mutex_lock(&e->lock);
     while (1) {
-        if (e->die) break;
+        FFTask *t = find_task(e, ti);
+
+        if (t) {
+            e->cb.run(t, lc, e->cb.user_data);
+            continue;
+        }
 
-        if (!run_one_task(e, lc)) {
-            //no task in one loop
+        //no task in one loop
+        ff_mutex_lock(&e->lock);
+        // pairs with the nb_tasks increment followed by the nb_idle check
+        // in ff_executor_execute()
+        atomic_fetch_add(&e->nb_idle, 1);
+        if (!e->die && !have_tasks(e))
             ff_cond_wait(&e->cond, &e->lock);
+        atomic_fetch_sub(&e->nb_idle, 1);
+        if (e->die) {
+            ff_mutex_unlock(&e->lock);
+            break;
         }
+        ff_mutex_unlock(&e->lock);
     }
-    ff_mutex_unlock(&e->lock);
     return NULL;
 }
 #endif
 
+static int run_one_task(FFExecutor *e, void *lc)
+{
+    FFTaskCallbacks *cb = &e->cb;
+    FFTask *t = NULL;
+
+    for (int i = 0; i < e->cb.priorities && !t; i++)
+        t = remove_task(e->q + i);
+
+    if (t) {
+        cb->run(t, lc, cb->user_data);
+        return 1;
+    }
+    return 0;
+}
+
 static av_cold void executor_free(FFExecutor *e, const int has_lock, const int has_cond)
 {
     if (e->thread_count) {
@@ -146,6 +220,11 @@ static av_cold void executor_free(FFExecutor *e, const int has_lock, const int h
     if (has_lock)
         ff_mutex_destroy(&e->lock);
 
+    for (int i = 0; i < e->nb_queues; i++) {
+        ff_mutex_destroy(&e->threads[i].lock);
+        av_free(e->threads[i].q);
+    }
+
     av_free(e->threads);
     av_free(e->q);
     av_free(e->local_contexts);
@@ -180,6 +259,21 @@ av_cold FFExecutor* ff_executor_alloc(const FFTaskCallbacks *cb, int thread_coun
     if (!thread_count)
         return e;
 
+    for (/* nothing */; e->nb_queues < thread_count; e->nb_queues++) {
+        ThreadInfo *ti = e->threads + e->nb_queues;
+
+        ti->q = av_calloc(e->cb.priorities, sizeof(Queue));
+        if (!ti->q)
+            goto free_executor;
+        if (ff_mutex_init(&ti->lock, NULL)) {
+            av_freep(&ti->q);
+            goto free_executor;
+        }
+        atomic_init(&ti->nb_tasks, 0);
+    }
+    atomic_init(&e->nb_idle, 0);
+    atomic_init(&e->next, 0);
+
     has_lock = !ff_mutex_init(&e->lock, NULL);
     has_cond = !ff_cond_init(&e->cond, NULL);
 
@@ -212,22 +306,35 @@ av_cold void ff_executor_free(FFExecutor **executor)
 
 void ff_executor_execute(FFExecutor *e, FFTask *t)
 {
-    if (e->thread_count)
-        ff_mutex_lock(&e->lock);
-    if (t)
-        add_task(e->q + t->priority % e->cb.priorities, t);
+#if HAVE_THREADS
     if (e->thread_count) {
-        ff_cond_signal(&e->cond);
-        ff_mutex_unlock(&e->lock);
-    }
+        if (t) {
+            ThreadInfo *ti = e->threads + atomic_fetch_add(&e->next, 1) % e->nb_queues;
 
-    if (!e->thread_count || !HAVE_THREADS) {
-        if (e->recursive)
-            return;
-        e->recursive = true;
-        // We are running in a single-threaded environment, so we must handle all tasks ourselves
-        while (run_one_task(e, e->local_contexts))
-            /* nothing */;
-        e->recursive = false;
+            ff_mutex_lock(&ti->lock);
+            add_task(ti->q + t->priority % e->cb.priorities, t);
+            ff_mutex_unlock(&ti->lock);
+            atomic_fetch_add(&ti->nb_tasks, 1);
+        }
+
+        // pairs with the nb_idle increment followed by the nb_tasks check
+        // in executor_worker_task()
+        if (!t || atomic_load(&e->nb_idle)) {
+            ff_mutex_lock(&e->lock);
+            ff_cond_signal(&e->cond);
+            ff_mutex_unlock(&e->lock);
+        }
+        return;
     }
+#endif
+
+    if (t)
+        add_task(e->q + t->priority % e->cb.priorities, t);
+    if (e->recursive)
+        return;
+    e->recursive = true;
+    // We are running in a single-threaded environment, so we must handle all tasks ourselves
+    while (run_one_task(e, e->local_contexts))
+        /* nothing */;
+    e->recursive = false;
 }
@@ -26,6 +26,7 @@
 #include "libavutil/container_fifo.h"
 #include "libavutil/mathematics.h"
 #include "libavutil/mem.h"
+#include "libavutil/object_cache_internal.h"
 #include "libavutil/rational.h"
 
 #include "defs.h"
@@ -62,7 +63,7 @@ static void get_packet_defaults(AVPacket *pkt)
 
 AVPacket *av_packet_alloc(void)
 {
-    AVPacket *pkt = av_malloc(sizeof(AVPacket));
+    AVPacket *pkt = avpriv_object_cache_alloc(AV_OBJECT_CACHE_PACKET, sizeof(AVPacket));
     if (!pkt)
         return pkt;
 
@@ -77,7 +78,8 @@ void av_packet_free(AVPacket **pkt)
         return;
 
     av_packet_unref(*pkt);
-    av_freep(pkt);
+    avpriv_object_cache_free(AV_OBJECT_CACHE_PACKET, *pkt);
+    *pkt = NULL;
 }
 
 static int packet_alloc(AVBufferRef **buf, int size)
@@ -222,14 +222,27 @@ static void update_link_current_pts(FilterLinkInternal *li, int64_t pts)
     li->l.current_pts = pts;
     li->l.current_pts_us = av_rescale_q(pts, link->time_base, AV_TIME_BASE_Q);
     /* TODO use duration */
-    if (li->l.graph && li->age_index >= 0)
-        ff_avfilter_graph_update_heap(li->l.graph, li);
+    if (li->l.graph && li->age_index >= 0) {
+        /* the heap is shared, it is updated after the batch completes */
+        if (fffiltergraph(li->l.graph)->nb_batch > 1)
+            li->age_update = 1;
+        else
+            ff_avfilter_graph_update_heap(li->l.graph, li);
+    }
 }
 
 void ff_filter_set_ready(AVFilterContext *filter, unsigned priority)
 {
     FFFilterContext *ctxi = fffilterctx(filter);
-    ctxi->ready = FFMAX(ctxi->ready, priority);
+    unsigned ready = atomic_load_explicit(&ctxi->ready, memory_order_relaxed);
+
+    /* Neighbours of a filter may be activated concurrently, see
+     * ff_filter_graph_run_once(). */
+    while (ready < priority &&
+           !atomic_compare_exchange_weak_explicit(&ctxi->ready, &ready, priority,
+                                                  memory_order_relaxed,
+                                                  memory_order_relaxed))
+        ;
 }
 
 /**
@@ -492,7 +505,7 @@ int ff_request_frame(AVFilterLink *link)
     if (li->status_in) {
         if (ff_framequeue_queued_frames(&li->fifo)) {
             av_assert1(!li->frame_wanted_out);
-            av_assert1(fffilterctx(link->dst)->ready >= 300);
+            av_assert1(atomic_load(&fffilterctx(link->dst)->ready) >= 300);
             return 0;
         } else {
             /* Acknowledge status change. Filters using ff_request_frame() will
@@ -663,8 +676,11 @@ static const AVClass *filter_child_class_iterate(void **iter)
 #define TFLAGS AV_OPT_FLAG_FILTERING_PARAM|AV_OPT_FLAG_RUNTIME_PARAM
 static const AVOption avfilter_options[] = {
     { "thread_type", "Allowed thread types", OFFSET(thread_type), AV_OPT_TYPE_FLAGS,
-        { .i64 = AVFILTER_THREAD_SLICE }, 0, INT_MAX, FLAGS, .unit = "thread_type" },
+        { .i64 = AVFILTER_THREAD_SLICE | AVFILTER_THREAD_GRAPH | AVFILTER_THREAD_FRAME },
+        0, INT_MAX, FLAGS, .unit = "thread_type" },
         { "slice", NULL, 0, AV_OPT_TYPE_CONST, { .i64 = AVFILTER_THREAD_SLICE }, .flags = FLAGS, .unit = "thread_type" },
+        { "graph", NULL, 0, AV_OPT_TYPE_CONST, { .i64 = AVFILTER_THREAD_GRAPH }, .flags = FLAGS, .unit = "thread_type" },
+        { "frame", NULL, 0, AV_OPT_TYPE_CONST, { .i64 = AVFILTER_THREAD_FRAME }, .flags = FLAGS, .unit = "thread_type" },
     { "enable", "set enable expression", OFFSET(enable_str), AV_OPT_TYPE_STRING, {.str=NULL}, .flags = TFLAGS },
     { "threads", "Allowed number of threads", OFFSET(nb_threads), AV_OPT_TYPE_INT,
         { .i64 = 0 }, 0, INT_MAX, FLAGS, .unit = "threads" },
@@ -838,6 +854,9 @@ void avfilter_free(AVFilterContext *filter)
         command_queue_pop(filter);
     av_opt_free(filter);
     av_expr_free(ctxi->enable);
+    av_freep(&ctxi->frames_in);
+    av_freep(&ctxi->frames_out);
+    av_freep(&ctxi->frames_ret);
     ctxi->enable = NULL;
     av_freep(&ctxi->var_values);
     av_free(filter);
@@ -919,7 +938,7 @@ int ff_filter_process_command(AVFilterContext *ctx, const char *cmd,
 int avfilter_init_dict(AVFilterContext *ctx, AVDictionary **options)
 {
     FFFilterContext *ctxi = fffilterctx(ctx);
-    int ret = 0;
+    int frame_threads, ret = 0;
 
     if (ctxi->state_flags & AV_CLASS_STATE_INITIALIZED) {
         av_log(ctx, AV_LOG_ERROR, "Filter already initialized\n");
@@ -932,15 +951,40 @@ int avfilter_init_dict(AVFilterContext *ctx, AVDictionary **options)
         return ret;
     }
 
+    frame_threads = ctx->thread_type & ctx->graph->thread_type & AVFILTER_THREAD_FRAME &&
+                    fffilter(ctx->filter)->flags_internal & FF_FILTER_FLAG_STATELESS &&
+                    fffiltergraph(ctx->graph)->thread_execute &&
+                    ff_filter_get_nb_threads(ctx) > 1;
+
     if (ctx->filter->flags & AVFILTER_FLAG_SLICE_THREADS &&
         ctx->thread_type & ctx->graph->thread_type & AVFILTER_THREAD_SLICE &&
         fffiltergraph(ctx->graph)->thread_execute) {
         ctx->thread_type       = AVFILTER_THREAD_SLICE;
         ctxi->execute    = fffiltergraph(ctx->graph)->thread_execute;
+    } else if (!frame_threads &&
+               ctx->thread_type & ctx->graph->thread_type & AVFILTER_THREAD_GRAPH &&
+               fffiltergraph(ctx->graph)->thread_execute &&
+               !(fffilter(ctx->filter)->flags_internal &
+                 (FF_FILTER_FLAG_HWFRAME_AWARE | FF_FILTER_FLAG_GRAPH_SERIAL))) {
+        /* slice threaded filters use the graph threads themselves, so they
+         * are always activated alone */
+        ctx->thread_type = AVFILTER_THREAD_GRAPH;
     } else {
         ctx->thread_type = 0;
     }
 
+    if (frame_threads) {
+        int nb_threads = ff_filter_get_nb_threads(ctx);
+
+        ctxi->frames_in  = av_calloc(nb_threads, sizeof(*ctxi->frames_in));
+        ctxi->frames_out = av_calloc(nb_threads, sizeof(*ctxi->frames_out));
+        ctxi->frames_ret = av_calloc(nb_threads, sizeof(*ctxi->frames_ret));
+        if (!ctxi->frames_in || !ctxi->frames_out || !ctxi->frames_ret)
+            return AVERROR(ENOMEM);
+        ctxi->nb_frame_threads = nb_threads;
+        ctx->thread_type      |= AVFILTER_THREAD_FRAME;
+    }
+
     if (fffilter(ctx->filter)->init)
         ret = fffilter(ctx->filter)->init(ctx);
     if (ret < 0)
@@ -1068,9 +1112,23 @@ fail:
 int ff_filter_frame(AVFilterLink *link, AVFrame *frame)
 {
     FilterLinkInternal * const li = ff_link_internal(link);
+    FFFilterContext * const srci = fffilterctx(link->src);
     int ret;
     FF_TPRINTF_START(NULL, filter_frame); ff_tlog_link(NULL, link, 1); ff_tlog(NULL, " "); tlog_ref(NULL, frame, 1);
 
+    if (srci->frames_capture) {
+        /* called from filter_frames_threaded(), the frames are queued once
+         * all the jobs are done */
+        int idx = atomic_fetch_add_explicit(&srci->nb_frames_out, 1,
+                                            memory_order_relaxed);
+        if (idx >= srci->nb_frame_threads) {
+            av_frame_free(&frame);
+            return AVERROR_BUG;
+        }
+        srci->frames_out[idx] = frame;
+        return 0;
+    }
+
     /* Consistency checks */
     if (link->type == AVMEDIA_TYPE_VIDEO) {
         if (strcmp(link->dst->filter->name, "buffersink") &&
@@ -1110,8 +1168,9 @@ int ff_filter_frame(AVFilterLink *link, AVFrame *frame)
     filter_unblock(link->dst);
     ret = ff_framequeue_add(&li->fifo, frame);
     if (ret < 0) {
-        const FFFrameQueueGlobal *global = li->fifo.global;
-        if (ret == AVERROR(ENOMEM) && global->queued >= global->max_queued)
+        FFFrameQueueGlobal *global = li->fifo.global;
+        if (ret == AVERROR(ENOMEM) &&
+            atomic_load_explicit(&global->queued, memory_order_relaxed) >= global->max_queued)
             av_log(link->dst, AV_LOG_ERROR, "Exhausted frame queue capacity (%zu frames)\n", global->max_queued);
         av_frame_free(&frame);
         return ret;
@@ -1192,6 +1251,118 @@ static int take_samples(FilterLinkInternal *li, unsigned min, unsigned max,
     return 0;
 }
 
+/**
+ * Return the number of frames queued on link that can be passed concurrently
+ * to the filter_frame() callback of its destination, 0 if it must be called
+ * for a single frame, or AVERROR(EAGAIN) if more frames should be queued
+ * first.
+ */
+static int frame_threads_batch_size(AVFilterLink *link)
+{
+    FilterLinkInternal * const li = ff_link_internal(link);
+    AVFilterContext *dst = link->dst;
+    FFFilterContext *dsti = fffilterctx(dst);
+    size_t nb_frames = ff_framequeue_queued_frames(&li->fifo);
+    int64_t pts = AV_NOPTS_VALUE;
+    int i;
+
+    /* The first frame is filtered alone, so that the output link buffer
+     * pool is not created concurrently. Commands and timeline expressions
+     * are evaluated per frame. */
+    if (!(dst->thread_type & AVFILTER_THREAD_FRAME) || !nb_frames ||
+        dst->nb_inputs != 1 || dst->nb_outputs != 1 ||
+        li->l.min_samples || li->fifo.samples_skipped ||
+        dsti->command_queue || dst->enable_str ||
+        !ff_filter_link(dst->outputs[0])->frame_count_in ||
+        ff_link_internal(dst->outputs[0])->status_in)
+        return 0;
+
+    /* output frames are put back in order using their pts */
+    nb_frames = FFMIN(nb_frames, dsti->nb_frame_threads);
+    for (i = 0; i < nb_frames; i++) {
+        const AVFrame *frame = ff_framequeue_peek(&li->fifo, i);
+        if (frame->pts == AV_NOPTS_VALUE ||
+            (pts != AV_NOPTS_VALUE && frame->pts <= pts))
+            break;
+        pts = frame->pts;
+    }
+    /* wait for a full batch unless the input is ending */
+    if (i == nb_frames && nb_frames < dsti->nb_frame_threads && !li->status_in)
+        return AVERROR(EAGAIN);
+    return i >= 2 ? i : 0;
+}
+
+static int filter_frame_job(AVFilterContext *ctx, void *arg, int jobnr, int nb_jobs)
+{
+    AVFilterLink *link = arg;
+    return link->dstpad->filter_frame(link, fffilterctx(ctx)->frames_in[jobnr]);
+}
+
+/**
+ * Pass nb_frames frames queued on link to the filter_frame() callback of a
+ * stateless filter concurrently, one frame per graph thread.
+ */
+static int filter_frames_threaded(AVFilterLink *link, int nb_frames)
+{
+    FilterLinkInternal * const li = ff_link_internal(link);
+    AVFilterContext *dst = link->dst;
+    FFFilterContext *dsti = fffilterctx(dst);
+    avfilter_execute_func *execute = dsti->execute;
+    int nb_out, ret = 0;
+
+    for (int i = 0; i < nb_frames; i++) {
+        ff_inlink_consume_frame(link, &dsti->frames_in[i]);
+        if (link->dstpad->flags & AVFILTERPAD_FLAG_NEEDS_WRITABLE && !ret)
+            ret = ff_inlink_make_frame_writable(link, &dsti->frames_in[i]);
+    }
+    if (ret < 0) {
+        for (int i = 0; i < nb_frames; i++)
+            av_frame_free(&dsti->frames_in[i]);
+        goto end;
+    }
+    filter_unblock(dst);
+
+    /* the graph threads run one frame each, slices are processed serially */
+    atomic_store_explicit(&dsti->nb_frames_out, 0, memory_order_relaxed);
+    dsti->frames_capture = 1;
+    dsti->execute        = default_execute;
+    fffiltergraph(dst->graph)->thread_execute(dst, filter_frame_job, link,
+                                              dsti->frames_ret, nb_frames);
+    dsti->execute        = execute;
+    dsti->frames_capture = 0;
+
+    for (int i = 0; i < nb_frames; i++) {
+        dsti->frames_in[i] = NULL;
+        if (dsti->frames_ret[i] < 0 && !ret)
+            ret = dsti->frames_ret[i];
+    }
+
+    nb_out = FFMIN(atomic_load_explicit(&dsti->nb_frames_out, memory_order_relaxed),
+                   dsti->nb_frame_threads);
+    for (int i = 1; i < nb_out; i++) {
+        AVFrame *frame = dsti->frames_out[i];
+        int j;
+
+        for (j = i; j > 0 && dsti->frames_out[j - 1]->pts > frame->pts; j--)
+            dsti->frames_out[j] = dsti->frames_out[j - 1];
+        dsti->frames_out[j] = frame;
+    }
+    for (int i = 0; i < nb_out; i++) {
+        if (ret >= 0)
+            ret = ff_filter_frame(dst->outputs[0], dsti->frames_out[i]);
+        else
+            av_frame_free(&dsti->frames_out[i]);
+        dsti->frames_out[i] = NULL;
+    }
+
+end:
+    if (ret < 0 && ret != li->status_out)
+        link_set_out_status(link, ret, AV_NOPTS_VALUE);
+    else
+        ff_filter_set_ready(dst, 300);
+    return ret;
+}
+
 static int filter_frame_to_filter(AVFilterLink *link)
 {
     FilterLinkInternal * const li = ff_link_internal(link);
@@ -1200,6 +1371,13 @@ static int filter_frame_to_filter(AVFilterLink *link)
     int ret;
 
     av_assert1(ff_framequeue_queued_frames(&li->fifo));
+    ret = frame_threads_batch_size(link);
+    if (ret == AVERROR(EAGAIN)) {
+        ff_inlink_request_frame(link);
+        return 0;
+    }
+    if (ret > 0)
+        return filter_frames_threaded(link, ret);
     ret = li->l.min_samples ?
           ff_inlink_consume_samples(link, li->l.min_samples, li->l.max_samples, &frame) :
           ff_inlink_consume_frame(link, &frame);
@@ -1457,7 +1635,7 @@ int ff_filter_activate(AVFilterContext *filter)
     /* Generic timeline support is not yet implemented but should be easy */
     av_assert1(!(fi->p.flags & AVFILTER_FLAG_SUPPORT_TIMELINE_GENERIC &&
                  fi->activate));
-    ctxi->ready = 0;
+    atomic_store_explicit(&ctxi->ready, 0, memory_order_relaxed);
     ret = fi->activate ? fi->activate(filter) : filter_activate_default(filter);
     if (ret == FFERROR_NOT_READY)
         ret = 0;
@@ -269,6 +269,20 @@ unsigned avfilter_filter_pad_count(const AVFilter *filter, int is_output);
  */
 #define AVFILTER_THREAD_SLICE (1 << 0)
 
+/**
+ * Activate independent filters of the graph concurrently, e.g. the filters
+ * of parallel chains. Filters using slice threading are still activated
+ * alone.
+ */
+#define AVFILTER_THREAD_GRAPH (1 << 1)
+
+/**
+ * Process several frames concurrently in filters that do not keep state
+ * between frames, e.g. to keep threads busy with frames too small to be
+ * split efficiently into slices.
+ */
+#define AVFILTER_THREAD_FRAME (1 << 2)
+
 /** An instance of a filter */
 typedef struct AVFilterContext {
     const AVClass *av_class;        ///< needed for av_log() and filters common options
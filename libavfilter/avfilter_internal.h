@@ -25,6 +25,7 @@
 #ifndef AVFILTER_AVFILTER_INTERNAL_H
 #define AVFILTER_AVFILTER_INTERNAL_H
 
+#include <stdatomic.h>
 #include <stdint.h>
 
 #include "avfilter.h"
@@ -83,12 +84,24 @@ typedef struct FilterLinkInternal {
      */
     int age_index;
 
+    /**
+     * Set if the position in the age array must be updated once the current
+     * graph-threaded batch is complete.
+     */
+    int age_update;
+
     /** stage of the initialization of the link properties (dimensions, etc) */
     enum {
         AVLINK_UNINIT = 0,      ///< not started
         AVLINK_STARTINIT,       ///< started, but incomplete
         AVLINK_INIT             ///< complete
     } init_state;
+
+    /**
+     * Number of the last graph-threaded batch that claimed this link,
+     * see FFFilterGraph.batch_id.
+     */
+    unsigned batch_id;
 } FilterLinkInternal;
 
 static inline FilterLinkInternal *ff_link_internal(AVFilterLink *link)
@@ -112,7 +125,7 @@ typedef struct FFFilterContext {
      * A non-0 value means that the filter needs activating;
      * a higher value suggests a more urgent activation.
      */
-    unsigned ready;
+    atomic_uint ready;
 
     /// parsed expression
     struct AVExpr *enable;
@@ -120,6 +133,22 @@ typedef struct FFFilterContext {
     double *var_values;
 
     struct AVFilterCommand *command_queue;
+
+    /**
+     * Frames passed concurrently to filter_frame() with
+     * AVFILTER_THREAD_FRAME, the return values, and the frames output.
+     * All arrays have nb_frame_threads entries.
+     */
+    AVFrame **frames_in;
+    int      *frames_ret;
+    AVFrame **frames_out;
+    atomic_int nb_frames_out;
+    int        nb_frame_threads;
+    /**
+     * If set, ff_filter_frame() stores the frames output by this filter in
+     * frames_out instead of queueing them on the output link.
+     */
+    int        frames_capture;
 } FFFilterContext;
 
 static inline FFFilterContext *fffilterctx(AVFilterContext *ctx)
@@ -149,6 +178,22 @@ typedef struct FFFilterGraph {
     void *thread;
     avfilter_execute_func *thread_execute;
     FFFrameQueueGlobal frame_queues;
+
+    /**
+     * Filters activated concurrently by ff_filter_graph_run_once() when
+     * AVFILTER_THREAD_GRAPH is in use, and their return values.
+     * Both arrays have nb_batch_max entries, nb_batch of which are in use
+     * while a batch is built and activated.
+     */
+    AVFilterContext **batch;
+    int *batch_rets;
+    int nb_batch;
+    int nb_batch_max;
+    /**
+     * Incremented for each batch; the links touched by the filters of the
+     * current batch are marked with this value.
+     */
+    unsigned batch_id;
 } FFFilterGraph;
 
 static inline FFFilterGraph *fffiltergraph(AVFilterGraph *graph)
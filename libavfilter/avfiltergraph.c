@@ -49,6 +49,8 @@ static const AVOption filtergraph_options[] = {
     { "thread_type", "Allowed thread types", OFFSET(thread_type), AV_OPT_TYPE_FLAGS,
         { .i64 = AVFILTER_THREAD_SLICE }, 0, INT_MAX, F|V|A, .unit = "thread_type" },
         { "slice", NULL, 0, AV_OPT_TYPE_CONST, { .i64 = AVFILTER_THREAD_SLICE }, .flags = F|V|A, .unit = "thread_type" },
+        { "graph", NULL, 0, AV_OPT_TYPE_CONST, { .i64 = AVFILTER_THREAD_GRAPH }, .flags = F|V|A, .unit = "thread_type" },
+        { "frame", NULL, 0, AV_OPT_TYPE_CONST, { .i64 = AVFILTER_THREAD_FRAME }, .flags = F|V|A, .unit = "thread_type" },
     { "threads",     "Maximum number of threads", OFFSET(nb_threads), AV_OPT_TYPE_INT,
         { .i64 = 0 }, 0, INT_MAX, F|V|A, .unit = "threads"},
         {"auto", "autodetect a suitable number of threads to use", 0, AV_OPT_TYPE_CONST, {.i64 = 0 }, .flags = F|V|A, .unit = "threads"},
@@ -130,6 +132,8 @@ void avfilter_graph_free(AVFilterGraph **graphp)
     ff_graph_thread_free(graphi);
 
     av_freep(&graphi->sink_links);
+    av_freep(&graphi->batch);
+    av_freep(&graphi->batch_rets);
 
     av_opt_free(graph);
 
@@ -1431,6 +1435,36 @@ static int graph_config_pointers(AVFilterGraph *graph, void *log_ctx)
     return 0;
 }
 
+/**
+ * Allocate the arrays used for activating filters concurrently, if any filter
+ * of the graph allows it.
+ */
+static int graph_config_batch(AVFilterGraph *graph)
+{
+    FFFilterGraph *graphi = fffiltergraph(graph);
+    int nb_eligible = 0;
+
+    av_freep(&graphi->batch);
+    av_freep(&graphi->batch_rets);
+    graphi->nb_batch_max = 0;
+
+    for (unsigned i = 0; i < graph->nb_filters; i++)
+        nb_eligible += !!(graph->filters[i]->thread_type & AVFILTER_THREAD_GRAPH);
+    if (nb_eligible < 2 || graph->nb_threads < 2 || !graphi->thread_execute)
+        return 0;
+
+    graphi->nb_batch_max = FFMIN(nb_eligible, graph->nb_threads);
+    graphi->batch      = av_calloc(graphi->nb_batch_max, sizeof(*graphi->batch));
+    graphi->batch_rets = av_calloc(graphi->nb_batch_max, sizeof(*graphi->batch_rets));
+    if (!graphi->batch || !graphi->batch_rets) {
+        av_freep(&graphi->batch);
+        av_freep(&graphi->batch_rets);
+        return AVERROR(ENOMEM);
+    }
+
+    return 0;
+}
+
 int avfilter_graph_config(AVFilterGraph *graphctx, void *log_ctx)
 {
     int ret;
@@ -1447,6 +1481,8 @@ int avfilter_graph_config(AVFilterGraph *graphctx, void *log_ctx)
         return ret;
     if ((ret = graph_config_pointers(graphctx, log_ctx)))
         return ret;
+    if ((ret = graph_config_batch(graphctx)))
+        return ret;
 
     return 0;
 }
@@ -1613,21 +1649,134 @@ int avfilter_graph_request_oldest(AVFilterGraph *graph)
     return 0;
 }
 
+/**
+ * Call fn on every link whose state may be modified when activating filter:
+ * its own links and, through filter_unblock(), the outputs of its downstream
+ * neighbours. The ready field of the neighbours is atomic, and updates of the
+ * sink links age heap are deferred until the batch is complete.
+ */
+static int batch_links(FFFilterGraph *graphi, AVFilterContext *filter,
+                       int (*fn)(FFFilterGraph *graphi, FilterLinkInternal *li))
+{
+    for (unsigned i = 0; i < filter->nb_inputs; i++)
+        if (!fn(graphi, ff_link_internal(filter->inputs[i])))
+            return 0;
+    for (unsigned i = 0; i < filter->nb_outputs; i++) {
+        AVFilterContext *dst = filter->outputs[i]->dst;
+
+        if (!fn(graphi, ff_link_internal(filter->outputs[i])))
+            return 0;
+        for (unsigned j = 0; j < dst->nb_outputs; j++)
+            if (!fn(graphi, ff_link_internal(dst->outputs[j])))
+                return 0;
+    }
+    return 1;
+}
+
+static int batch_link_free(FFFilterGraph *graphi, FilterLinkInternal *li)
+{
+    return li->batch_id != graphi->batch_id;
+}
+
+static int batch_link_claim(FFFilterGraph *graphi, FilterLinkInternal *li)
+{
+    li->batch_id = graphi->batch_id;
+    return 1;
+}
+
+static int batch_link_update_age(FFFilterGraph *graphi, FilterLinkInternal *li)
+{
+    if (li->age_update) {
+        li->age_update = 0;
+        ff_avfilter_graph_update_heap(&graphi->p, li);
+    }
+    return 1;
+}
+
+/**
+ * Add filter to the current batch if activating it can not touch any state
+ * touched by the filters already in the batch.
+ */
+static int batch_add(FFFilterGraph *graphi, AVFilterContext *filter)
+{
+    if (!batch_links(graphi, filter, batch_link_free))
+        return 0;
+    batch_links(graphi, filter, batch_link_claim);
+    graphi->batch[graphi->nb_batch++] = filter;
+    return 1;
+}
+
+static int batch_activate(AVFilterContext *ctx, void *arg, int jobnr, int nb_jobs)
+{
+    AVFilterContext **batch = arg;
+    return ff_filter_activate(batch[jobnr]);
+}
+
+/**
+ * Activate filter together with as many other ready filters as can be
+ * safely activated at the same time.
+ */
+static int graph_run_batch(AVFilterGraph *graph, AVFilterContext *filter)
+{
+    FFFilterGraph *graphi = fffiltergraph(graph);
+    int nb_batch, buffersrc_empty = 0, ret = 0;
+
+    graphi->batch_id++;
+    batch_add(graphi, filter);
+
+    for (unsigned i = 0; i < graph->nb_filters &&
+                         graphi->nb_batch < graphi->nb_batch_max; i++) {
+        AVFilterContext *f = graph->filters[i];
+
+        if (f != filter && f->thread_type & AVFILTER_THREAD_GRAPH &&
+            atomic_load_explicit(&fffilterctx(f)->ready, memory_order_relaxed))
+            batch_add(graphi, f);
+    }
+
+    nb_batch = graphi->nb_batch;
+    if (nb_batch == 1) {
+        graphi->nb_batch = 0;
+        return ff_filter_activate(filter);
+    }
+
+    graphi->thread_execute(filter, batch_activate, graphi->batch,
+                           graphi->batch_rets, nb_batch);
+    graphi->nb_batch = 0;
+
+    for (int i = 0; i < nb_batch; i++) {
+        int r = graphi->batch_rets[i];
+        batch_links(graphi, graphi->batch[i], batch_link_update_age);
+        if (r == FFERROR_BUFFERSRC_EMPTY)
+            buffersrc_empty = 1;
+        else if (r < 0 && !ret)
+            ret = r;
+    }
+    return ret ? ret : buffersrc_empty ? FFERROR_BUFFERSRC_EMPTY : 0;
+}
+
 int ff_filter_graph_run_once(AVFilterGraph *graph)
 {
     FFFilterContext *ctxi;
+    unsigned ready;
     unsigned i;
 
     av_assert0(graph->nb_filters);
-    ctxi = fffilterctx(graph->filters[0]);
+    ctxi  = fffilterctx(graph->filters[0]);
+    ready = atomic_load_explicit(&ctxi->ready, memory_order_relaxed);
     for (i = 1; i < graph->nb_filters; i++) {
         FFFilterContext *ctxi_other = fffilterctx(graph->filters[i]);
+        unsigned ready_other = atomic_load_explicit(&ctxi_other->ready,
+                                                    memory_order_relaxed);
 
-        if (ctxi_other->ready > ctxi->ready)
-            ctxi = ctxi_other;
+        if (ready_other > ready) {
+            ctxi  = ctxi_other;
+            ready = ready_other;
+        }
     }
 
-    if (!ctxi->ready)
+    if (!ready)
         return AVERROR(EAGAIN);
+    if (ctxi->p.thread_type & AVFILTER_THREAD_GRAPH && fffiltergraph(graph)->batch)
+        return graph_run_batch(graph, &ctxi->p);
     return ff_filter_activate(&ctxi->p);
 }
@@ -583,6 +583,7 @@ const FFFilter ff_vf_graphmonitor = {
     .p.description = NULL_IF_CONFIG_SMALL("Show various filtergraph stats."),
     .p.priv_class  = &graphmonitor_class,
     .priv_size     = sizeof(GraphMonitorContext),
+    .flags_internal = FF_FILTER_FLAG_GRAPH_SERIAL,
     .init          = init,
     .uninit        = uninit,
     .activate      = activate,
@@ -601,6 +602,7 @@ const FFFilter ff_avf_agraphmonitor = {
     .p.description = NULL_IF_CONFIG_SMALL("Show various filtergraph stats."),
     .p.priv_class  = &graphmonitor_class,
     .priv_size     = sizeof(GraphMonitorContext),
+    .flags_internal = FF_FILTER_FLAG_GRAPH_SERIAL,
     .init          = init,
     .uninit        = uninit,
     .activate      = activate,
@@ -207,6 +207,22 @@ static inline FilterLink* ff_filter_link(AVFilterLink *link)
  */
 #define FF_FILTER_FLAG_HWFRAME_AWARE (1 << 0)
 
+/**
+ * The filter accesses other filters of the graph, it must not be activated
+ * concurrently with any other filter (see AVFILTER_THREAD_GRAPH).
+ */
+#define FF_FILTER_FLAG_GRAPH_SERIAL  (1 << 1)
+
+/**
+ * The filter has a single input and a single output, and its output for a
+ * frame only depends on that frame and the filter options: filter_frame()
+ * does not modify the private context, and outputs at most one frame with
+ * the pts of its input. filter_frame() may then be called concurrently for
+ * consecutive frames (see AVFILTER_THREAD_FRAME), with ff_filter_execute()
+ * running the jobs serially.
+ */
+#define FF_FILTER_FLAG_STATELESS     (1 << 2)
+
 /**
  * Find the index of a link.
  *
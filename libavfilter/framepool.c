@@ -232,8 +232,12 @@ int ff_frame_pool_video_reinit(FFFramePool *pool,
         FFALIGN(pool->height, pool->align) == FFALIGN(height, align) &&
         pool->align == align)
     {
-        pool->width = width;
-        pool->height = height;
+        /* only written on change, the pool may be used by several threads
+         * with AVFILTER_THREAD_FRAME */
+        if (pool->width != width || pool->height != height) {
+            pool->width  = width;
+            pool->height = height;
+        }
         return 0;
     }
 
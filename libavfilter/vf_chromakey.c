@@ -374,6 +374,7 @@ const FFFilter ff_vf_chromakey = {
     .p.priv_class  = &chromakey_class,
     .p.flags       = AVFILTER_FLAG_SUPPORT_TIMELINE_GENERIC | AVFILTER_FLAG_SLICE_THREADS,
     .priv_size     = sizeof(ChromakeyContext),
+    .flags_internal = FF_FILTER_FLAG_STATELESS,
     FILTER_INPUTS(inputs),
     FILTER_OUTPUTS(outputs),
     FILTER_PIXFMTS_ARRAY(chromakey_fmts),
@@ -415,6 +416,7 @@ const FFFilter ff_vf_chromahold = {
     .p.priv_class  = &chromahold_class,
     .p.flags       = AVFILTER_FLAG_SUPPORT_TIMELINE_GENERIC | AVFILTER_FLAG_SLICE_THREADS,
     .priv_size     = sizeof(ChromakeyContext),
+    .flags_internal = FF_FILTER_FLAG_STATELESS,
     FILTER_INPUTS(inputs),
     FILTER_OUTPUTS(outputs),
     FILTER_PIXFMTS_ARRAY(hold_pixel_fmts),
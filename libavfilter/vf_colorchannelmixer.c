@@ -499,6 +499,7 @@ const FFFilter ff_vf_colorchannelmixer = {
     .p.priv_class  = &colorchannelmixer_class,
     .p.flags       = AVFILTER_FLAG_SUPPORT_TIMELINE_GENERIC | AVFILTER_FLAG_SLICE_THREADS,
     .priv_size     = sizeof(ColorChannelMixerContext),
+    .flags_internal = FF_FILTER_FLAG_STATELESS,
     .uninit        = uninit,
     FILTER_INPUTS(colorchannelmixer_inputs),
     FILTER_OUTPUTS(colorchannelmixer_outputs),
@@ -151,6 +151,7 @@ const FFFilter ff_vf_hflip = {
     .p.description = NULL_IF_CONFIG_SMALL("Horizontally flip the input video."),
     .p.flags       = AVFILTER_FLAG_SLICE_THREADS | AVFILTER_FLAG_SUPPORT_TIMELINE_GENERIC,
     .priv_size     = sizeof(FlipContext),
+    .flags_internal = FF_FILTER_FLAG_STATELESS,
     FILTER_INPUTS(avfilter_vf_hflip_inputs),
     FILTER_OUTPUTS(ff_video_default_filterpad),
     FILTER_QUERY_FUNC2(query_formats),
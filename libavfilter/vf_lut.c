@@ -597,6 +597,7 @@ static const AVFilterPad inputs[] = {
         .p.flags       = AVFILTER_FLAG_SUPPORT_TIMELINE_GENERIC |       \
                          AVFILTER_FLAG_SLICE_THREADS,                   \
         .priv_size     = sizeof(LutContext),                            \
+        .flags_internal = FF_FILTER_FLAG_STATELESS,                     \
         .init          = name_##_init,                                  \
         .uninit        = uninit,                                        \
         FILTER_INPUTS(inputs),                                          \
@@ -0,0 +1,355 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+/**
+ * @file
+ * scale one input to several output sizes at once
+ */
+
+#include <stdio.h>
+
+#include "libavutil/avstring.h"
+#include "libavutil/mem.h"
+#include "libavutil/opt.h"
+#include "libavutil/parseutils.h"
+#include "libavutil/pixdesc.h"
+#include "libswscale/swscale.h"
+
+#include "avfilter.h"
+#include "filters.h"
+#include "formats.h"
+#include "scale_eval.h"
+#include "video.h"
+
+typedef struct ScaleMultiContext {
+    const AVClass *class;
+    SwsContext *sws;
+
+    char *sizes_str;
+    char *flags_str;
+    int cascade;
+
+    int nb_sizes;
+    int *w, *h;       /* requested sizes, may be negative (keep aspect ratio) */
+    AVFrame **frames; /* temporary output frames, one per output */
+} ScaleMultiContext;
+
+static int parse_size(AVFilterContext *ctx, const char *str, int *w, int *h)
+{
+    char end;
+    if (sscanf(str, "%dx%d%c", w, h, &end) == 2)
+        return 0;
+
+    int ret = av_parse_video_size(w, h, str);
+    if (ret < 0)
+        av_log(ctx, AV_LOG_ERROR, "Invalid size '%s'\n", str);
+    return ret;
+}
+
+static av_cold int preinit(AVFilterContext *ctx)
+{
+    ScaleMultiContext *s = ctx->priv;
+
+    s->sws = sws_alloc_context();
+    if (!s->sws)
+        return AVERROR(ENOMEM);
+
+    // set threads=0, so we can later check whether the user modified it
+    s->sws->threads = 0;
+    return 0;
+}
+
+static int config_output(AVFilterLink *outlink);
+
+static av_cold int init(AVFilterContext *ctx)
+{
+    ScaleMultiContext *s = ctx->priv;
+    char *saveptr = NULL, *sizes;
+    int ret;
+
+    if (!s->sizes_str || !*s->sizes_str) {
+        av_log(ctx, AV_LOG_ERROR, "No output sizes specified\n");
+        return AVERROR(EINVAL);
+    }
+
+    sizes = av_strdup(s->sizes_str);
+    if (!sizes)
+        return AVERROR(ENOMEM);
+
+    for (char *tok = av_strtok(sizes, "|", &saveptr); tok;
+         tok = av_strtok(NULL, "|", &saveptr)) {
+        int *w = av_realloc_array(s->w, s->nb_sizes + 1, sizeof(*s->w));
+        if (w)
+            s->w = w;
+        int *h = av_realloc_array(s->h, s->nb_sizes + 1, sizeof(*s->h));
+        if (h)
+            s->h = h;
+        if (!w || !h) {
+            ret = AVERROR(ENOMEM);
+            goto fail;
+        }
+
+        ret = parse_size(ctx, tok, &s->w[s->nb_sizes], &s->h[s->nb_sizes]);
+        if (ret < 0)
+            goto fail;
+        s->nb_sizes++;
+    }
+    av_freep(&sizes);
+
+    s->frames = av_calloc(s->nb_sizes, sizeof(*s->frames));
+    if (!s->frames)
+        return AVERROR(ENOMEM);
+
+    for (int i = 0; i < s->nb_sizes; i++) {
+        AVFilterPad pad = {
+            .type         = AVMEDIA_TYPE_VIDEO,
+            .name         = av_asprintf("output%d", i),
+            .config_props = config_output,
+        };
+        if (!pad.name)
+            return AVERROR(ENOMEM);
+
+        if ((ret = ff_append_outpad_free_name(ctx, &pad)) < 0)
+            return ret;
+    }
+
+    if (s->flags_str && *s->flags_str) {
+        ret = av_opt_set(s->sws, "sws_flags", s->flags_str, 0);
+        if (ret < 0)
+            return ret;
+    }
+
+    // use generic thread-count if the user did not set it explicitly
+    if (!s->sws->threads)
+        s->sws->threads = ff_filter_get_nb_threads(ctx);
+
+    return 0;
+
+fail:
+    av_freep(&sizes);
+    return ret;
+}
+
+static av_cold void uninit(AVFilterContext *ctx)
+{
+    ScaleMultiContext *s = ctx->priv;
+    sws_free_context(&s->sws);
+    for (int i = 0; s->frames && i < s->nb_sizes; i++)
+        av_frame_free(&s->frames[i]);
+    av_freep(&s->frames);
+    av_freep(&s->w);
+    av_freep(&s->h);
+}
+
+static int query_formats(const AVFilterContext *ctx,
+                         AVFilterFormatsConfig **cfg_in,
+                         AVFilterFormatsConfig **cfg_out)
+{
+    const AVPixFmtDescriptor *desc = NULL;
+    AVFilterFormats *formats = NULL;
+    int ret;
+
+    /* All outputs share the input format, so that outputs can be cascaded */
+    while ((desc = av_pix_fmt_desc_next(desc))) {
+        enum AVPixelFormat pix_fmt = av_pix_fmt_desc_get_id(desc);
+        if (sws_test_format(pix_fmt, 0) && sws_test_format(pix_fmt, 1)) {
+            if ((ret = ff_add_format(&formats, pix_fmt)) < 0)
+                return ret;
+        }
+    }
+
+    return ff_set_common_formats2(ctx, cfg_in, cfg_out, formats);
+}
+
+static int config_output(AVFilterLink *outlink)
+{
+    AVFilterContext *ctx = outlink->src;
+    AVFilterLink *inlink = ctx->inputs[0];
+    ScaleMultiContext *s = ctx->priv;
+    const int idx = FF_OUTLINK_IDX(outlink);
+    int ret;
+
+    outlink->w = s->w[idx];
+    outlink->h = s->h[idx];
+    ret = ff_scale_adjust_dimensions(inlink, &outlink->w, &outlink->h,
+                                     SCALE_FORCE_OAR_DISABLE, 1, 1.0);
+    if (ret < 0)
+        return ret;
+
+    if (inlink->sample_aspect_ratio.num) {
+        AVRational q = av_div_q((AVRational){ inlink->w, inlink->h },
+                                (AVRational){ outlink->w, outlink->h });
+        outlink->sample_aspect_ratio = av_mul_q(q, inlink->sample_aspect_ratio);
+    } else {
+        outlink->sample_aspect_ratio = inlink->sample_aspect_ratio;
+    }
+
+    if (inlink->w != outlink->w || inlink->h != outlink->h) {
+        av_frame_side_data_remove_by_props(&outlink->side_data, &outlink->nb_side_data,
+                                           AV_SIDE_DATA_PROP_SIZE_DEPENDENT);
+    }
+
+    av_log(ctx, AV_LOG_VERBOSE, "output%d: w:%d h:%d -> w:%d h:%d fmt:%s\n",
+           idx, inlink->w, inlink->h, outlink->w, outlink->h,
+           av_get_pix_fmt_name(outlink->format));
+    return 0;
+}
+
+static int scale_frame(AVFilterContext *ctx, AVFrame *in)
+{
+    ScaleMultiContext *s = ctx->priv;
+    AVFrame **out = s->frames;
+    int nb_out = 0, ret = 0;
+
+    for (int i = 0; i < ctx->nb_outputs; i++) {
+        AVFilterLink *outlink = ctx->outputs[i];
+        if (ff_outlink_get_status(outlink))
+            continue;
+
+        AVFrame *frame = ff_get_video_buffer(outlink, outlink->w, outlink->h);
+        if (!frame) {
+            ret = AVERROR(ENOMEM);
+            goto fail;
+        }
+        out[nb_out++] = frame;
+
+        if ((ret = av_frame_copy_props(frame, in)) < 0)
+            goto fail;
+        frame->width  = outlink->w;
+        frame->height = outlink->h;
+        av_reduce(&frame->sample_aspect_ratio.num, &frame->sample_aspect_ratio.den,
+                  (int64_t) in->sample_aspect_ratio.num * outlink->h * in->width,
+                  (int64_t) in->sample_aspect_ratio.den * outlink->w * in->height,
+                  INT_MAX);
+        if (frame->width != in->width || frame->height != in->height) {
+            av_frame_side_data_remove_by_props(&frame->side_data, &frame->nb_side_data,
+                                               AV_SIDE_DATA_PROP_SIZE_DEPENDENT);
+        }
+    }
+
+    if (s->cascade) {
+        ret = sws_scale_frame_multi(s->sws, out, nb_out, in);
+    } else {
+        for (int i = 0; i < nb_out && ret >= 0; i++)
+            ret = sws_scale_frame(s->sws, out[i], in);
+    }
+    if (ret < 0)
+        goto fail;
+
+    for (int i = 0, n = 0; i < ctx->nb_outputs; i++) {
+        if (ff_outlink_get_status(ctx->outputs[i]))
+            continue;
+        ret = ff_filter_frame(ctx->outputs[i], out[n]);
+        out[n++] = NULL;
+        if (ret < 0)
+            goto fail;
+    }
+
+    av_frame_free(&in);
+    return 0;
+
+fail:
+    for (int i = 0; i < nb_out; i++)
+        av_frame_free(&out[i]);
+    av_frame_free(&in);
+    return ret;
+}
+
+static int activate(AVFilterContext *ctx)
+{
+    AVFilterLink *inlink = ctx->inputs[0];
+    AVFrame *in;
+    int status, ret, nb_eofs = 0;
+    int64_t pts;
+
+    for (int i = 0; i < ctx->nb_outputs; i++)
+        nb_eofs += ff_outlink_get_status(ctx->outputs[i]) == AVERROR_EOF;
+
+    if (nb_eofs == ctx->nb_outputs) {
+        ff_inlink_set_status(inlink, AVERROR_EOF);
+        return 0;
+    }
+
+    ret = ff_inlink_consume_frame(inlink, &in);
+    if (ret < 0)
+        return ret;
+    if (ret > 0)
+        return scale_frame(ctx, in);
+
+    if (ff_inlink_acknowledge_status(inlink, &status, &pts)) {
+        for (int i = 0; i < ctx->nb_outputs; i++) {
+            if (ff_outlink_get_status(ctx->outputs[i]))
+                continue;
+            ff_outlink_set_status(ctx->outputs[i], status, pts);
+        }
+        return 0;
+    }
+
+    FF_FILTER_FORWARD_WANTED_ANY(ctx, inlink);
+
+    return FFERROR_NOT_READY;
+}
+
+static const AVClass *child_class_iterate(void **iter)
+{
+    const AVClass *c = *iter ? NULL : sws_get_class();
+    *iter = (void*)(uintptr_t)c;
+    return c;
+}
+
+static void *child_next(void *obj, void *prev)
+{
+    ScaleMultiContext *s = obj;
+    if (!prev)
+        return s->sws;
+    return NULL;
+}
+
+#define OFFSET(x) offsetof(ScaleMultiContext, x)
+#define FLAGS AV_OPT_FLAG_VIDEO_PARAM|AV_OPT_FLAG_FILTERING_PARAM
+
+static const AVOption scale_multi_options[] = {
+    { "sizes",   "'|'-separated list of output sizes", OFFSET(sizes_str), AV_OPT_TYPE_STRING, { .str = NULL }, .flags = FLAGS },
+    { "flags",   "Flags to pass to libswscale",        OFFSET(flags_str), AV_OPT_TYPE_STRING, { .str = "" },   .flags = FLAGS },
+    { "cascade", "derive smaller outputs from larger ones", OFFSET(cascade), AV_OPT_TYPE_BOOL, { .i64 = 0 }, 0, 1, FLAGS },
+    { NULL }
+};
+
+static const AVClass scale_multi_class = {
+    .class_name          = "scale_multi",
+    .item_name           = av_default_item_name,
+    .option              = scale_multi_options,
+    .version             = LIBAVUTIL_VERSION_INT,
+    .category            = AV_CLASS_CATEGORY_FILTER,
+    .child_class_iterate = child_class_iterate,
+    .child_next          = child_next,
+};
+
+const FFFilter ff_vf_scale_multi = {
+    .p.name          = "scale_multi",
+    .p.description   = NULL_IF_CONFIG_SMALL("Scale the input video to multiple output sizes."),
+    .p.priv_class    = &scale_multi_class,
+    .p.flags         = AVFILTER_FLAG_DYNAMIC_OUTPUTS,
+    .preinit         = preinit,
+    .init            = init,
+    .uninit          = uninit,
+    .priv_size       = sizeof(ScaleMultiContext),
+    .activate        = activate,
+    FILTER_INPUTS(ff_video_default_filterpad),
+    FILTER_QUERY_FUNC2(query_formats),
+};
@@ -438,6 +438,7 @@ const FFFilter ff_vf_vibrance = {
     .p.priv_class  = &vibrance_class,
     .p.flags       = AVFILTER_FLAG_SUPPORT_TIMELINE_GENERIC | AVFILTER_FLAG_SLICE_THREADS,
     .priv_size     = sizeof(VibranceContext),
+    .flags_internal = FF_FILTER_FLAG_STATELESS,
     FILTER_INPUTS(vibrance_inputs),
     FILTER_OUTPUTS(ff_video_default_filterpad),
     FILTER_PIXFMTS_ARRAY(pixel_fmts),
@@ -522,6 +522,8 @@ int ffio_fdopen(AVIOContext **sp, URLContext *h)
             s->seekable |= AVIO_SEEKABLE_TIME;
     }
     ((FFIOContext*)s)->short_seek_get = ffurl_get_short_seek;
+    if (!(h->flags & AVIO_FLAG_WRITE))
+        ffurl_get_mapping(h, &((FFIOContext*)s)->mapping);
     s->av_class = &ff_avio_class;
     return 0;
 }
@@ -912,6 +914,13 @@ int ffurl_get_short_seek(void *urlcontext)
     return h->prot->url_get_short_seek(h);
 }
 
+int ffurl_get_mapping(URLContext *h, AVBufferRef **buf)
+{
+    if (!h || !h->prot || !h->prot->url_get_mapping)
+        return AVERROR(ENOSYS);
+    return h->prot->url_get_mapping(h, buf);
+}
+
 int ffurl_shutdown(URLContext *h, int flags)
 {
     if (!h || !h->prot || !h->prot->url_shutdown)
@@ -21,6 +21,7 @@
 
 #include "avio.h"
 
+#include "libavutil/buffer.h"
 #include "libavutil/log.h"
 
 typedef struct AVFormatContext AVFormatContext;
@@ -78,6 +79,12 @@ typedef struct FFIOContext {
      * is updated each time a successful writeout ends up further position-wise
      */
     int64_t written_output_size;
+
+    /**
+     * Read-only memory mapping of the whole resource, if the protocol
+     * provides one; see ffio_read_mapped().
+     */
+    AVBufferRef *mapping;
 } FFIOContext;
 
 static av_always_inline FFIOContext *ffiocontext(AVIOContext *ctx)
@@ -121,6 +128,33 @@ void ffio_init_write_context(FFIOContext *s, uint8_t *buffer, int buffer_size);
  */
 int ffio_read_indirect(AVIOContext *s, unsigned char *buf, int size, const unsigned char **data);
 
+/**
+ * Read size bytes from a read-only AVIOContext backed by a memory mapping,
+ * returning a reference to the mapping instead of copying the data.
+ * At least AV_INPUT_BUFFER_PADDING_SIZE readable bytes follow the data, but
+ * they are the following bytes of the resource, not zeroes.
+ * Any data buffered in s is dropped if the read does not fit in it, so this
+ * is only worth it for reads larger than the I/O buffer.
+ *
+ * @param s IO context
+ * @param size number of bytes requested
+ * @param buf if not NULL, set to a new reference to the mapping
+ * @param data set to the address of the requested bytes inside the mapping
+ * @return size on success, AVERROR(ENOSYS) if the request cannot be served
+ *    from a mapping (in which case s is left untouched) or another AVERROR
+ */
+int ffio_read_mapped(AVIOContext *s, int size, AVBufferRef **buf, const uint8_t **data);
+
+/**
+ * Get the data following the current position that is already in the I/O
+ * buffer. Nothing is consumed: reading up to the returned number of bytes
+ * with ffio_read_indirect() afterwards is guaranteed not to copy them.
+ *
+ * @param data set to the address of the data
+ * @return number of bytes available at *data, possibly 0
+ */
+int ffio_peek_direct(AVIOContext *s, const uint8_t **data);
+
 void ffio_fill(AVIOContext *s, int b, int64_t count);
 
 static av_always_inline void ffio_wfourcc(AVIOContext *pb, const uint8_t *s)
@@ -127,6 +127,7 @@ void avio_context_free(AVIOContext **ps)
 {
     AVIOContext *s = *ps;
     if (s) {
+        av_buffer_unref(&ffiocontext(s)->mapping);
         av_freep(&s->protocol_whitelist);
         av_freep(&s->protocol_blacklist);
     }
@@ -678,12 +679,58 @@ int ffio_read_indirect(AVIOContext *s, unsigned char *buf, int size, const unsig
         *data = s->buf_ptr;
         s->buf_ptr += size;
         return size;
+    } else if (size > s->buffer_size &&
+               ffio_read_mapped(s, size, NULL, data) == size) {
+        return size;
     } else {
         *data = buf;
         return avio_read(s, buf, size);
     }
 }
 
+int ffio_read_mapped(AVIOContext *s, int size, AVBufferRef **buf, const uint8_t **data)
+{
+    FFIOContext *const ctx = ffiocontext(s);
+    const AVBufferRef *map = ctx->mapping;
+    int64_t pos = avio_tell(s);
+
+    if (!map || s->write_flag || s->update_checksum || size <= 0 || pos < 0 ||
+        pos + size + AV_INPUT_BUFFER_PADDING_SIZE > (int64_t)map->size)
+        return AVERROR(ENOSYS);
+
+    if (buf && !(*buf = av_buffer_ref(ctx->mapping)))
+        return AVERROR(ENOMEM);
+
+    if (s->buf_end - s->buf_ptr >= size) {
+        s->buf_ptr += size;
+    } else {
+        /* Drop the buffered data instead of reading through it */
+        int64_t res = s->seek(s->opaque, pos + size, SEEK_SET);
+        if (res < 0) {
+            if (buf)
+                av_buffer_unref(buf);
+            return res;
+        }
+        s->buf_end = s->buffer;
+        s->checksum_ptr = s->buf_ptr = s->buf_ptr_max = s->buffer;
+        s->pos = pos + size;
+        s->eof_reached = 0;
+    }
+
+    ctx->bytes_read += size;
+    *data = map->data + pos;
+    return size;
+}
+
+int ffio_peek_direct(AVIOContext *s, const uint8_t **data)
+{
+    if (s->write_flag)
+        return 0;
+
+    *data = s->buf_ptr;
+    return s->buf_end - s->buf_ptr;
+}
+
 int avio_read_partial(AVIOContext *s, unsigned char *buf, int size)
 {
     int len;
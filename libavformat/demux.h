@@ -378,6 +378,24 @@ int ff_generate_avci_extradata(AVStream *st);
  */
 int ff_get_extradata(void *logctx, AVCodecParameters *par, AVIOContext *pb, int size);
 
+/**
+ * Like av_get_packet(), but if pb is backed by a memory mapping of the
+ * input, make the packet reference the mapped data instead of copying it.
+ *
+ * The padding following mapped data holds the next bytes of the input
+ * instead of zeroes, so this is only done for codecs whose decoders never
+ * read past the end of a packet (raw video and plain PCM); packets of other
+ * codecs are read with av_get_packet().
+ * Mapped packet data is not writable; demuxers that modify packet data in
+ * place must call av_packet_make_writable() first. Accessing it after the
+ * input file has been truncated raises SIGBUS.
+ *
+ * @param par parameters of the stream the packet belongs to
+ * @return number of bytes read or AVERROR_xxx on error
+ */
+int ff_get_mapped_packet(AVIOContext *pb, const AVCodecParameters *par,
+                         AVPacket *pkt, int size);
+
 /**
  * Find stream index based on format-specific stream ID
  * @return stream index, or < 0 on error
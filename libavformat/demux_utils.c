@@ -356,6 +356,34 @@ int ff_get_extradata(void *logctx, AVCodecParameters *par, AVIOContext *pb, int
     return ret;
 }
 
+/* Decoders of these codecs never read past the end of their packets */
+static int ignores_padding(enum AVCodecID codec_id)
+{
+    return codec_id == AV_CODEC_ID_RAWVIDEO ||
+           codec_id >= AV_CODEC_ID_FIRST_AUDIO &&
+           codec_id <  AV_CODEC_ID_ADPCM_IMA_QT &&
+           av_get_exact_bits_per_sample(codec_id) > 0;
+}
+
+int ff_get_mapped_packet(AVIOContext *pb, const AVCodecParameters *par,
+                         AVPacket *pkt, int size)
+{
+    int64_t pos = avio_tell(pb);
+    const uint8_t *data;
+    AVBufferRef *buf;
+
+    if (!ignores_padding(par->codec_id) ||
+        ffio_read_mapped(pb, size, &buf, &data) < 0)
+        return av_get_packet(pb, pkt, size);
+
+    av_packet_unref(pkt);
+    pkt->buf  = buf;
+    pkt->data = (uint8_t *)data;
+    pkt->size = size;
+    pkt->pos  = pos;
+    return size;
+}
+
 int ff_find_stream_index(const AVFormatContext *s, int id)
 {
     for (unsigned i = 0; i < s->nb_streams; i++)
@@ -24,6 +24,7 @@
 #include "config_components.h"
 
 #include "libavutil/avstring.h"
+#include "libavutil/buffer.h"
 #include "libavutil/error.h"
 #include "libavutil/file_open.h"
 #include "libavutil/internal.h"
@@ -41,9 +42,15 @@
 #include <unistd.h>
 #endif
 #include <sys/stat.h>
+#if HAVE_MMAP
+#include <sys/mman.h>
+#endif
 #include <stdlib.h>
 #include "os_support.h"
 #include "url.h"
+#if HAVE_IO_URING
+#include "uring.h"
+#endif
 
 /* Some systems may not have S_ISFIFO */
 #ifndef S_ISFIFO
@@ -90,6 +97,10 @@
 #  endif
 #endif
 
+/* Reads kept in flight with io_uring, and their size */
+#define URING_DEPTH    4
+#define URING_BUF_SIZE (256 << 10)
+
 /* standard file protocol */
 
 typedef struct FileContext {
@@ -100,6 +111,13 @@ typedef struct FileContext {
     int pkt_size;
     int follow;
     int seekable;
+    int mmap;
+    AVBufferRef *map;   ///< read-only mapping of the whole file, if any
+    int64_t map_pos;    ///< read position inside the mapping
+    int io_uring;
+#if HAVE_IO_URING
+    FFURing *ring;
+#endif
 #if HAVE_DIRENT_H
     DIR *dir;
 #endif
@@ -111,6 +129,8 @@ static const AVOption file_options[] = {
     { "follow", "Follow a file as it is being written", offsetof(FileContext, follow), AV_OPT_TYPE_INT, { .i64 = 0 }, 0, 1, AV_OPT_FLAG_DECODING_PARAM },
     { "seekable", "Sets if the file is seekable", offsetof(FileContext, seekable), AV_OPT_TYPE_INT, { .i64 = -1 }, -1, 0, AV_OPT_FLAG_DECODING_PARAM | AV_OPT_FLAG_ENCODING_PARAM },
     { "pkt_size", "Maximum packet size", offsetof(FileContext, pkt_size), AV_OPT_TYPE_INT, { .i64 = 0 }, 0, INT_MAX, AV_OPT_FLAG_DECODING_PARAM | AV_OPT_FLAG_ENCODING_PARAM },
+    { "mmap", "Read regular files through a memory mapping", offsetof(FileContext, mmap), AV_OPT_TYPE_BOOL, { .i64 = 0 }, 0, 1, AV_OPT_FLAG_DECODING_PARAM },
+    { "io_uring", "Keep several reads in flight using io_uring", offsetof(FileContext, io_uring), AV_OPT_TYPE_BOOL, { .i64 = 0 }, 0, 1, AV_OPT_FLAG_DECODING_PARAM },
     { NULL }
 };
 
@@ -146,6 +166,19 @@ static int file_read(URLContext *h, unsigned char *buf, int size)
     FileContext *c = h->priv_data;
     int ret;
     size = FFMIN(size, c->blocksize);
+    if (c->map) {
+        int64_t left = c->map->size - c->map_pos;
+        if (left <= 0)
+            return AVERROR_EOF;
+        size = FFMIN(size, left);
+        memcpy(buf, c->map->data + c->map_pos, size);
+        c->map_pos += size;
+        return size;
+    }
+#if HAVE_IO_URING
+    if (c->ring)
+        return ff_uring_read(c->ring, buf, size, 0);
+#endif
     ret = read(c->fd, buf, size);
     if (ret == 0 && c->follow)
         return AVERROR(EAGAIN);
@@ -226,7 +259,12 @@ static int fd_dup(URLContext *h, int oldfd)
 static int file_close(URLContext *h)
 {
     FileContext *c = h->priv_data;
-    int ret = close(c->fd);
+    int ret;
+    av_buffer_unref(&c->map);
+#if HAVE_IO_URING
+    ff_uring_free(&c->ring);
+#endif
+    ret = close(c->fd);
     return (ret == -1) ? AVERROR(errno) : 0;
 }
 
@@ -245,6 +283,34 @@ static int64_t file_seek(URLContext *h, int64_t pos, int whence)
         return ret < 0 ? AVERROR(errno) : (S_ISFIFO(st.st_mode) ? 0 : st.st_size);
     }
 
+    if (c->map) {
+        if (whence == SEEK_CUR)
+            pos += c->map_pos;
+        else if (whence == SEEK_END)
+            pos += c->map->size;
+        if (pos < 0)
+            return AVERROR(EINVAL);
+        c->map_pos = pos;
+        return pos;
+    }
+
+#if HAVE_IO_URING
+    if (c->ring) {
+        if (whence == SEEK_CUR) {
+            pos += ff_uring_tell(c->ring);
+        } else if (whence == SEEK_END) {
+            struct stat st;
+            if (fstat(c->fd, &st) < 0)
+                return AVERROR(errno);
+            pos += st.st_size;
+        }
+        if (pos < 0)
+            return AVERROR(EINVAL);
+        ret = ff_uring_seek(c->ring, pos);
+        return ret < 0 ? ret : pos;
+    }
+#endif
+
     ret = lseek(c->fd, pos, whence);
 
     return ret < 0 ? AVERROR(errno) : ret;
@@ -252,6 +318,47 @@ static int64_t file_seek(URLContext *h, int64_t pos, int whence)
 
 #if CONFIG_FILE_PROTOCOL
 
+#if HAVE_MMAP
+static void file_unmap(void *opaque, uint8_t *data)
+{
+    munmap(data, (size_t)(uintptr_t)opaque);
+}
+
+static void file_map(URLContext *h, const struct stat *st)
+{
+    FileContext *c = h->priv_data;
+    size_t size = st->st_size;
+    void *data;
+
+    if (!S_ISREG(st->st_mode) || !size || size != st->st_size)
+        return;
+
+    data = mmap(NULL, size, PROT_READ, MAP_SHARED, c->fd, 0);
+    if (data == MAP_FAILED) {
+        av_log(h, AV_LOG_WARNING, "Could not map file: %s\n", av_err2str(AVERROR(errno)));
+        return;
+    }
+#if HAVE_POSIX_MADVISE
+    posix_madvise(data, size, POSIX_MADV_SEQUENTIAL);
+#endif
+
+    c->map = av_buffer_create(data, size, file_unmap, (void *)(uintptr_t)size,
+                              AV_BUFFER_FLAG_READONLY);
+    if (!c->map)
+        munmap(data, size);
+}
+
+static int file_get_mapping(URLContext *h, AVBufferRef **buf)
+{
+    FileContext *c = h->priv_data;
+
+    if (!c->map)
+        return AVERROR(ENOSYS);
+    *buf = av_buffer_ref(c->map);
+    return *buf ? 0 : AVERROR(ENOMEM);
+}
+#endif /* HAVE_MMAP */
+
 static int file_delete(URLContext *h)
 {
 #if HAVE_UNISTD_H
@@ -292,7 +399,7 @@ static int file_open(URLContext *h, const char *filename, int flags)
 {
     FileContext *c = h->priv_data;
     int access;
-    int fd;
+    int fd, ret;
     struct stat st;
 
     av_strstart(filename, "file:", &filename);
@@ -316,7 +423,22 @@ static int file_open(URLContext *h, const char *filename, int flags)
         return AVERROR(errno);
     c->fd = fd;
 
-    h->is_streamed = !fstat(fd, &st) && S_ISFIFO(st.st_mode);
+    ret = fstat(fd, &st);
+    h->is_streamed = !ret && S_ISFIFO(st.st_mode);
+
+#if HAVE_MMAP
+    /* Files being written to may grow or shrink underneath the mapping */
+    if (c->mmap && !ret && !c->follow && !(flags & AVIO_FLAG_WRITE))
+        file_map(h, &st);
+#endif
+#if HAVE_IO_URING
+    if (c->io_uring && !c->map && !ret && !c->follow &&
+        S_ISREG(st.st_mode) && !(flags & AVIO_FLAG_WRITE)) {
+        ret = ff_uring_alloc(&c->ring, fd, 0, 0, URING_DEPTH, URING_BUF_SIZE);
+        if (ret < 0)
+            av_log(h, AV_LOG_WARNING, "Could not set up io_uring: %s\n", av_err2str(ret));
+    }
+#endif
 
     if (c->pkt_size) {
         h->max_packet_size = c->pkt_size;
@@ -429,6 +551,9 @@ const URLProtocol ff_file_protocol = {
     .url_seek            = file_seek,
     .url_close           = file_close,
     .url_get_file_handle = file_get_handle,
+#if HAVE_MMAP
+    .url_get_mapping     = file_get_mapping,
+#endif
     .url_check           = file_check,
     .url_delete          = file_delete,
     .url_move            = file_move,
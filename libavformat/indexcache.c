@@ -0,0 +1,289 @@
+/*
+ * Persistent cache of demuxer seek indexes
+ *
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include <string.h>
+
+#include "libavutil/avstring.h"
+#include "libavutil/intreadwrite.h"
+#include "libavutil/mem.h"
+#include "libavutil/rational.h"
+#include "libavutil/sha.h"
+#include "avformat.h"
+#include "avio.h"
+#include "indexcache.h"
+#include "internal.h"
+#include "os_support.h"
+
+/*
+ * Cache file layout, integers are little-endian:
+ *
+ *   'FFIC' version:32 demuxer name (zero terminated)
+ *   size:64 mtime:64 head hash:160
+ *   nb_streams:32
+ *   nb_streams times:
+ *       id:32 time base num:32 den:32 nb_entries:32
+ *       nb_entries times:
+ *           pos:64 timestamp:64 size:32 min_distance:32 flags:32
+ *   private data size:32 private data
+ *   'FFIE'
+ */
+#define INDEX_CACHE_TAG         MKBETAG('F','F','I','C')
+#define INDEX_CACHE_END_TAG     MKBETAG('F','F','I','E')
+#define INDEX_CACHE_VERSION     2
+#define INDEX_CACHE_ENTRY_SIZE  28
+#define INDEX_CACHE_HEAD_SIZE   (64 * 1024)
+
+int ff_index_cache_key(AVFormatContext *s, FFIndexCacheKey *key)
+{
+    AVIOContext *pb = s->pb;
+    const char *proto = avio_find_protocol_name(s->url);
+    struct AVSHA *sha;
+    uint8_t buf[4096];
+    int64_t pos, left;
+    int ret = 0;
+
+    memset(key, 0, sizeof(*key));
+    if (!pb || !(pb->seekable & AVIO_SEEKABLE_NORMAL))
+        return AVERROR(ENOSYS);
+
+    key->size = avio_size(pb);
+    if (key->size < 0)
+        return key->size;
+
+    if (proto && !strcmp(proto, "file")) {
+        const char *path = s->url;
+        struct stat st;
+
+        av_strstart(path, "file:", &path);
+        if (!stat(path, &st))
+            key->mtime = st.st_mtime;
+    }
+
+    sha = av_sha_alloc();
+    if (!sha)
+        return AVERROR(ENOMEM);
+    av_sha_init(sha, 160);
+
+    pos = avio_tell(pb);
+    if ((ret = avio_seek(pb, 0, SEEK_SET)) >= 0) {
+        ret = 0;
+        for (left = FFMIN(key->size, INDEX_CACHE_HEAD_SIZE); left > 0; left -= ret) {
+            ret = avio_read(pb, buf, FFMIN(left, sizeof(buf)));
+            if (ret <= 0) {
+                ret = ret < 0 ? ret : AVERROR_EOF;
+                break;
+            }
+            av_sha_update(sha, buf, ret);
+        }
+        ret = FFMIN(ret, 0);
+    }
+    av_sha_final(sha, key->head_hash);
+    av_free(sha);
+
+    if (avio_seek(pb, pos, SEEK_SET) < 0 && !ret)
+        ret = AVERROR(EIO);
+    return ret;
+}
+
+int ff_index_cache_load(AVFormatContext *s, const char *path,
+                        const FFIndexCacheKey *key,
+                        uint8_t **priv, int *priv_size)
+{
+    AVIOContext *pb = NULL;
+    FFIndexCacheKey cached;
+    char name[256];
+    int64_t file_size, streams_pos;
+    unsigned int nb_streams, size;
+    uint8_t *data = NULL;
+    int added = 0;
+
+    if (priv) {
+        *priv      = NULL;
+        *priv_size = 0;
+    }
+
+    if (s->io_open(s, &pb, path, AVIO_FLAG_READ, NULL) < 0) {
+        av_log(s, AV_LOG_VERBOSE, "No index cache at '%s'\n", path);
+        return 0;
+    }
+    file_size = avio_size(pb);
+
+    if (avio_rb32(pb) != INDEX_CACHE_TAG || avio_rl32(pb) != INDEX_CACHE_VERSION)
+        goto stale;
+    avio_get_str(pb, INT_MAX, name, sizeof(name));
+    if (strcmp(name, s->iformat->name))
+        goto stale;
+
+    cached.size  = avio_rl64(pb);
+    cached.mtime = avio_rl64(pb);
+    if (avio_read(pb, cached.head_hash, sizeof(cached.head_hash)) != sizeof(cached.head_hash) ||
+        cached.size != key->size || cached.mtime != key->mtime ||
+        memcmp(cached.head_hash, key->head_hash, sizeof(key->head_hash)))
+        goto stale;
+
+    /* Check the layout up to the end tag before using anything */
+    nb_streams  = avio_rl32(pb);
+    streams_pos = avio_tell(pb);
+    for (unsigned int i = 0; i < nb_streams; i++) {
+        unsigned int nb_entries;
+
+        avio_skip(pb, 12);
+        nb_entries = avio_rl32(pb);
+        if (avio_feof(pb) || file_size < 0 ||
+            nb_entries > (file_size - avio_tell(pb)) / INDEX_CACHE_ENTRY_SIZE)
+            goto truncated;
+        avio_skip(pb, (int64_t)nb_entries * INDEX_CACHE_ENTRY_SIZE);
+    }
+
+    size = avio_rl32(pb);
+    if (avio_feof(pb) || size > INT_MAX || size > file_size - avio_tell(pb))
+        goto truncated;
+    if (size && priv) {
+        data = av_malloc(size);
+        if (!data)
+            goto fail;
+        if (avio_read(pb, data, size) != size)
+            goto truncated;
+    } else {
+        avio_skip(pb, size);
+    }
+    if (avio_rb32(pb) != INDEX_CACHE_END_TAG ||
+        avio_seek(pb, streams_pos, SEEK_SET) < 0)
+        goto truncated;
+
+    for (unsigned int i = 0; i < nb_streams; i++) {
+        AVStream *st = i < s->nb_streams ? s->streams[i] : NULL;
+        int id = avio_rl32(pb);
+        AVRational time_base;
+        unsigned int nb_entries;
+        int match;
+
+        time_base.num = avio_rl32(pb);
+        time_base.den = avio_rl32(pb);
+        nb_entries    = avio_rl32(pb);
+        match = st && st->id == id && !av_cmp_q(st->time_base, time_base);
+        if (!match) {
+            avio_skip(pb, (int64_t)nb_entries * INDEX_CACHE_ENTRY_SIZE);
+            continue;
+        }
+
+        for (unsigned int j = 0; j < nb_entries; j++) {
+            int64_t pos       = avio_rl64(pb);
+            int64_t timestamp = avio_rl64(pb);
+            int size          = avio_rl32(pb);
+            int distance      = avio_rl32(pb);
+            int flags         = avio_rl32(pb);
+
+            if (pos >= 0 && pos < key->size &&
+                av_add_index_entry(st, pos, timestamp, size, distance, flags) >= 0)
+                added++;
+        }
+    }
+
+    av_log(s, AV_LOG_VERBOSE, "Loaded %d index entries from '%s'\n", added, path);
+    ff_format_io_close(s, &pb);
+    if (priv) {
+        *priv      = data;
+        *priv_size = data ? size : 0;
+    }
+    return added;
+
+truncated:
+    av_log(s, AV_LOG_WARNING, "Corrupt index cache '%s'\n", path);
+    goto fail;
+stale:
+    av_log(s, AV_LOG_VERBOSE, "Index cache '%s' does not match the input\n", path);
+fail:
+    av_free(data);
+    ff_format_io_close(s, &pb);
+    return 0;
+}
+
+int ff_index_cache_save(AVFormatContext *s, const char *path,
+                        const FFIndexCacheKey *key, int flags,
+                        const uint8_t *priv, int priv_size)
+{
+    AVIOContext *pb = NULL;
+    char *tmp = av_asprintf("%s.tmp", path);
+    int ret;
+
+    if (!tmp)
+        return AVERROR(ENOMEM);
+
+    ret = s->io_open(s, &pb, tmp, AVIO_FLAG_WRITE, NULL);
+    if (ret < 0) {
+        av_log(s, AV_LOG_WARNING, "Could not open index cache '%s' for writing\n", tmp);
+        av_free(tmp);
+        return ret;
+    }
+
+    avio_wb32(pb, INDEX_CACHE_TAG);
+    avio_wl32(pb, INDEX_CACHE_VERSION);
+    avio_put_str(pb, s->iformat->name);
+    avio_wl64(pb, key->size);
+    avio_wl64(pb, key->mtime);
+    avio_write(pb, key->head_hash, sizeof(key->head_hash));
+
+    avio_wl32(pb, s->nb_streams);
+    for (unsigned int i = 0; i < s->nb_streams; i++) {
+        const AVStream *st = s->streams[i];
+        const FFStream *sti = cffstream(st);
+        int nb_entries = flags & FF_INDEX_CACHE_NO_ENTRIES ? 0 : sti->nb_index_entries;
+
+        avio_wl32(pb, st->id);
+        avio_wl32(pb, st->time_base.num);
+        avio_wl32(pb, st->time_base.den);
+        avio_wl32(pb, nb_entries);
+        for (int j = 0; j < nb_entries; j++) {
+            const AVIndexEntry *e = &sti->index_entries[j];
+            avio_wl64(pb, e->pos);
+            avio_wl64(pb, e->timestamp);
+            avio_wl32(pb, e->size);
+            avio_wl32(pb, e->min_distance);
+            avio_wl32(pb, e->flags);
+        }
+    }
+    avio_wl32(pb, priv_size);
+    if (priv_size)
+        avio_write(pb, priv, priv_size);
+    avio_wb32(pb, INDEX_CACHE_END_TAG);
+
+    avio_flush(pb);
+    ret = pb->error;
+    ff_format_io_close(s, &pb);
+    if (ret >= 0)
+        ret = ff_rename(tmp, path, s);
+    if (ret < 0)
+        av_log(s, AV_LOG_WARNING, "Could not write index cache '%s'\n", path);
+    else
+        av_log(s, AV_LOG_VERBOSE, "Wrote %"PRId64" index entries to '%s'\n",
+               flags & FF_INDEX_CACHE_NO_ENTRIES ? 0 : ff_index_cache_nb_entries(s), path);
+    av_free(tmp);
+    return ret;
+}
+
+int64_t ff_index_cache_nb_entries(const AVFormatContext *s)
+{
+    int64_t nb_entries = 0;
+
+    for (unsigned int i = 0; i < s->nb_streams; i++)
+        nb_entries += cffstream(s->streams[i])->nb_index_entries;
+    return nb_entries;
+}
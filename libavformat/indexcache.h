@@ -0,0 +1,85 @@
+/*
+ * Persistent cache of demuxer seek indexes
+ *
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#ifndef AVFORMAT_INDEXCACHE_H
+#define AVFORMAT_INDEXCACHE_H
+
+#include <stdint.h>
+
+#include "avformat.h"
+
+/**
+ * Identity of an input, stored in an index cache and checked when it is
+ * loaded again.
+ */
+typedef struct FFIndexCacheKey {
+    int64_t size;
+    int64_t mtime;          ///< modification time of a local file, 0 otherwise
+    uint8_t head_hash[20];  ///< SHA-1 of the first bytes of the input
+} FFIndexCacheKey;
+
+/**
+ * Compute the identity of the input of s. The input must be seekable; its
+ * position is restored.
+ *
+ * @return 0 on success, AVERROR(ENOSYS) if the input is not seekable or
+ *         another negative AVERROR code
+ */
+int ff_index_cache_key(AVFormatContext *s, FFIndexCacheKey *key);
+
+/**
+ * Do not store the index entries of the streams, only the private data.
+ */
+#define FF_INDEX_CACHE_NO_ENTRIES (1 << 0)
+
+/**
+ * Add the index entries stored in the cache file at path to the streams of
+ * s, if the cache was written by the same demuxer for the same input.
+ * Streams are matched by index, id and time base.
+ *
+ * @param priv      if not NULL, set to the demuxer private data stored with
+ *                  the cache, or to NULL if there is no usable cache or no
+ *                  such data; must be freed with av_free()
+ * @param priv_size set to the size of *priv
+ * @return number of entries added, 0 if there is no usable cache
+ */
+int ff_index_cache_load(AVFormatContext *s, const char *path,
+                        const FFIndexCacheKey *key,
+                        uint8_t **priv, int *priv_size);
+
+/**
+ * Write the index entries of all the streams of s to the cache file at path.
+ * The file is replaced atomically where the protocol supports renaming.
+ *
+ * @param flags     a combination of FF_INDEX_CACHE_* flags
+ * @param priv      demuxer private data to store with the index, may be NULL
+ * @param priv_size size of priv
+ * @return 0 on success, a negative AVERROR code on failure
+ */
+int ff_index_cache_save(AVFormatContext *s, const char *path,
+                        const FFIndexCacheKey *key, int flags,
+                        const uint8_t *priv, int priv_size);
+
+/**
+ * @return the total number of index entries of the streams of s
+ */
+int64_t ff_index_cache_nb_entries(const AVFormatContext *s);
+
+#endif /* AVFORMAT_INDEXCACHE_H */
@@ -36,6 +36,7 @@
 #include "avio.h"
 #include "internal.h"
 #include "dv.h"
+#include "indexcache.h"
 
 /* isom.c */
 extern const AVCodecTag ff_mp4_obj_type[];
@@ -176,6 +177,21 @@ typedef struct MOVIndexRange {
     int64_t end;
 } MOVIndexRange;
 
+/**
+ * Position in the sample tables of a track using the lazy index.
+ */
+typedef struct MOVSampleCursor {
+    unsigned int sample;        ///< sample described by entry
+    unsigned int chunk;         ///< chunk containing the sample
+    unsigned int chunk_sample;  ///< index of the sample in its chunk
+    unsigned int stsc_index;
+    unsigned int tts_index;
+    unsigned int tts_sample;
+    unsigned int stss_index;    ///< next stss entry not before the sample
+    unsigned int stps_index;    ///< next stps entry not before the sample
+    AVIndexEntry entry;
+} MOVSampleCursor;
+
 typedef struct MOVStreamContext {
     AVIOContext *pb;
     int refcount;
@@ -288,6 +304,16 @@ typedef struct MOVStreamContext {
 
     struct IAMFDemuxContext *iamf;
     int iamf_stream_offset;
+
+    /** lazy index: samples are resolved from the sample tables when needed */
+    int lazy_index;
+    unsigned int lazy_count;    ///< number of samples in the lazy index
+    unsigned int lazy_discard;  ///< number of leading samples to discard (edit list)
+    int64_t lazy_first_dts;
+    unsigned int *lazy_tts_first;   ///< first sample of each time to sample run
+    int64_t *lazy_tts_dts;          ///< dts of each run, relative to lazy_first_dts
+    unsigned int *lazy_stsc_first;  ///< first sample of each sample to chunk run
+    MOVSampleCursor cursor;
 } MOVStreamContext;
 
 typedef struct HEIFItemRef {
@@ -389,6 +415,13 @@ typedef struct MOVContext {
     int nb_heif_grid;
     int64_t idat_offset;
     int interleaved_read;
+    int lazy_index;
+    char *index_cache;          ///< sidecar file caching the fragment index
+    FFIndexCacheKey index_cache_key;
+    int index_cache_checked;
+    int index_cache_valid;      ///< index_cache_key identifies the input
+    uint8_t *index_cache_data;  ///< cached data of a cache hit, until the end of the header
+    int index_cache_size;
     AVDictionary* decryption_keys;
     unsigned heif_icc_profile_items;
 } MOVContext;
@@ -63,6 +63,7 @@
 #include "avio_internal.h"
 #include "demux.h"
 #include "dovi_isom.h"
+#include "indexcache.h"
 #include "internal.h"
 #include "isom.h"
 #include "matroska.h"
@@ -439,6 +440,9 @@ typedef struct MatroskaDemuxContext {
 
     /* Bandwidth value for WebM DASH Manifest */
     int bandwidth;
+
+    /* Sidecar file caching the index built from the cues */
+    char *index_cache;
 } MatroskaDemuxContext;
 
 #define CHILD_OF(parent) { .def = { .n = parent } }
@@ -2047,6 +2051,31 @@ static void matroska_parse_cues(MatroskaDemuxContext *matroska) {
     matroska_add_index_entries(matroska);
 }
 
+/*
+ * Take the index from the cache file instead of reading the cues, which are
+ * usually at the end of the file. On a cache miss, read the cues now and
+ * write the cache for the next time the file is opened.
+ */
+static void matroska_load_index_cache(MatroskaDemuxContext *matroska)
+{
+    AVFormatContext *s = matroska->ctx;
+    FFIndexCacheKey key;
+
+    if (matroska->cues_parsing_deferred <= 0 || (s->flags & AVFMT_FLAG_IGNIDX) ||
+        ff_index_cache_key(s, &key) < 0)
+        return;
+
+    if (ff_index_cache_load(s, matroska->index_cache, &key, NULL, NULL) > 0) {
+        matroska->cues_parsing_deferred = 0;
+        return;
+    }
+
+    matroska->cues_parsing_deferred = 0;
+    matroska_parse_cues(matroska);
+    if (matroska->cues_parsing_deferred >= 0 && ff_index_cache_nb_entries(s))
+        ff_index_cache_save(s, matroska->index_cache, &key, 0, NULL, 0);
+}
+
 static int matroska_parse_content_encodings(MatroskaTrackEncoding *encodings,
                                             unsigned nb_encodings,
                                             MatroskaTrack *track,
@@ -3563,6 +3592,8 @@ static int matroska_read_header(AVFormatContext *s)
         }
 
     matroska_add_index_entries(matroska);
+    if (matroska->index_cache)
+        matroska_load_index_cache(matroska);
 
     matroska_convert_tags(s);
 
@@ -5035,11 +5066,24 @@ const FFInputFormat ff_webm_dash_manifest_demuxer = {
 };
 #endif
 
+static const AVOption matroska_options[] = {
+    { "index_cache", "cache the seek index in the given file", offsetof(MatroskaDemuxContext, index_cache), AV_OPT_TYPE_STRING, {.str = NULL}, 0, 0, AV_OPT_FLAG_DECODING_PARAM },
+    { NULL },
+};
+
+static const AVClass matroska_class = {
+    .class_name = "matroska,webm demuxer",
+    .item_name  = av_default_item_name,
+    .option     = matroska_options,
+    .version    = LIBAVUTIL_VERSION_INT,
+};
+
 const FFInputFormat ff_matroska_demuxer = {
     .p.name         = "matroska,webm",
     .p.long_name    = NULL_IF_CONFIG_SMALL("Matroska / WebM"),
     .p.extensions   = "mkv,mk3d,mka,mks,webm",
     .p.mime_type    = "audio/webm,audio/x-matroska,video/webm,video/x-matroska",
+    .p.priv_class   = &matroska_class,
     .priv_data_size = sizeof(MatroskaDemuxContext),
     .flags_internal = FF_INFMT_FLAG_INIT_CLEANUP,
     .read_probe     = matroska_probe,
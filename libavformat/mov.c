@@ -1943,6 +1943,156 @@ static void fix_frag_index_entries(MOVFragmentIndex *frag_index, int index,
     }
 }
 
+/*
+ * The index cache of a fragmented file keeps what mov_read_header() learns by
+ * reading every moof: the decode time of each fragment, and the stream
+ * parameters derived from all the fragments. With it, the moofs are read on
+ * demand, as for files with a complete sidx or mfra. Layout, little-endian:
+ *
+ *   nb_streams:32
+ *   nb_streams times: track id:32 duration:64 avg_frame_rate:32/32 bit_rate:64
+ *   nb_fragments:32
+ *   nb_fragments times: moof offset:64, nb_streams times tfdt:64
+ */
+#define MOV_INDEX_CACHE_STREAM_SIZE 28
+
+static void mov_load_index_cache(MOVContext *c)
+{
+    AVFormatContext *s = c->fc;
+    const uint8_t *p;
+    unsigned int nb_streams, nb_items;
+    int64_t last_offset = -1;
+    uint8_t *data;
+    int size;
+
+    if ((s->flags & AVFMT_FLAG_IGNIDX) || c->frag_index.complete ||
+        ff_index_cache_key(s, &c->index_cache_key) < 0)
+        return;
+    c->index_cache_valid = 1;
+
+    ff_index_cache_load(s, c->index_cache, &c->index_cache_key, &data, &size);
+    if (!data)
+        return;
+
+    nb_streams = size >= 4 ? AV_RL32(data) : 0;
+    if (nb_streams != s->nb_streams ||
+        size < 8 + (int64_t)nb_streams * MOV_INDEX_CACHE_STREAM_SIZE)
+        goto invalid;
+    for (unsigned int i = 0; i < nb_streams; i++) {
+        MOVStreamContext *sc = s->streams[i]->priv_data;
+        if ((int)AV_RL32(data + 4 + i * MOV_INDEX_CACHE_STREAM_SIZE) != sc->id)
+            goto invalid;
+    }
+
+    p = data + 4 + nb_streams * MOV_INDEX_CACHE_STREAM_SIZE;
+    nb_items = AV_RL32(p);
+    p += 4;
+    if (!nb_items || size - (p - data) != nb_items * (8 + 8LL * nb_streams))
+        goto invalid;
+    for (unsigned int i = 0; i < nb_items; i++) {
+        int64_t offset = AV_RL64(p + i * (8 + 8LL * nb_streams));
+        if (offset <= last_offset || offset >= c->index_cache_key.size)
+            goto invalid;
+        last_offset = offset;
+    }
+
+    for (unsigned int i = 0; i < nb_items; i++) {
+        int index = update_frag_index(c, AV_RL64(p));
+        if (index < 0)
+            goto invalid;
+        p += 8;
+        for (unsigned int j = 0; j < nb_streams; j++, p += 8) {
+            MOVStreamContext *sc = s->streams[j]->priv_data;
+            MOVFragmentStreamInfo *frag_stream_info =
+                get_frag_stream_info(&c->frag_index, index, sc->id);
+            if (frag_stream_info)
+                frag_stream_info->tfdt_dts = AV_RL64(p);
+        }
+    }
+
+    c->frag_index.complete = 1;
+    c->index_cache_data    = data;
+    c->index_cache_size    = size;
+    return;
+
+invalid:
+    av_log(s, AV_LOG_WARNING, "Invalid fragment index in index cache '%s'\n",
+           c->index_cache);
+    av_free(data);
+}
+
+/* Set the stream parameters a full read of the fragments would have found */
+static void mov_apply_index_cache(MOVContext *c)
+{
+    AVFormatContext *s = c->fc;
+
+    for (int i = 0; i < s->nb_streams; i++) {
+        AVStream *st = s->streams[i];
+        const uint8_t *p = c->index_cache_data + 4 + i * MOV_INDEX_CACHE_STREAM_SIZE;
+
+        st->duration           = AV_RL64(p + 4);
+        st->avg_frame_rate.num = AV_RL32(p + 12);
+        st->avg_frame_rate.den = AV_RL32(p + 16);
+        st->codecpar->bit_rate = AV_RL64(p + 20);
+    }
+    av_freep(&c->index_cache_data);
+    c->index_cache_size = 0;
+}
+
+static void mov_save_index_cache(MOVContext *c)
+{
+    AVFormatContext *s = c->fc;
+    AVIOContext *dyn;
+    uint8_t *data;
+    int size;
+
+    if (!c->frag_index.nb_items)
+        return;
+    for (int i = 0; i < c->frag_index.nb_items; i++) {
+        const MOVFragmentIndexItem *item = &c->frag_index.item[i];
+        for (int j = 0; j < item->nb_stream_info; j++) {
+            const MOVFragmentStreamInfo *frag_stream_info = &item->stream_info[j];
+            /* fragments can only be located again through their tfdt */
+            if (frag_stream_info->sidx_pts != AV_NOPTS_VALUE ||
+                frag_stream_info->index_base >= 0 &&
+                frag_stream_info->tfdt_dts == AV_NOPTS_VALUE) {
+                av_log(s, AV_LOG_VERBOSE, "Fragments without tfdt, "
+                       "not writing index cache '%s'\n", c->index_cache);
+                return;
+            }
+        }
+    }
+
+    if (avio_open_dyn_buf(&dyn) < 0)
+        return;
+    avio_wl32(dyn, s->nb_streams);
+    for (int i = 0; i < s->nb_streams; i++) {
+        const AVStream *st = s->streams[i];
+        const MOVStreamContext *sc = st->priv_data;
+
+        avio_wl32(dyn, sc->id);
+        avio_wl64(dyn, st->duration);
+        avio_wl32(dyn, st->avg_frame_rate.num);
+        avio_wl32(dyn, st->avg_frame_rate.den);
+        avio_wl64(dyn, st->codecpar->bit_rate);
+    }
+    avio_wl32(dyn, c->frag_index.nb_items);
+    for (int i = 0; i < c->frag_index.nb_items; i++) {
+        avio_wl64(dyn, c->frag_index.item[i].moof_offset);
+        for (int j = 0; j < s->nb_streams; j++) {
+            const MOVStreamContext *sc = s->streams[j]->priv_data;
+            const MOVFragmentStreamInfo *frag_stream_info =
+                get_frag_stream_info(&c->frag_index, i, sc->id);
+            avio_wl64(dyn, frag_stream_info ? frag_stream_info->tfdt_dts : AV_NOPTS_VALUE);
+        }
+    }
+    size = avio_close_dyn_buf(dyn, &data);
+    if (data && size > 0)
+        ff_index_cache_save(s, c->index_cache, &c->index_cache_key,
+                            FF_INDEX_CACHE_NO_ENTRIES, data, size);
+    av_free(data);
+}
+
 static int mov_read_moof(MOVContext *c, AVIOContext *pb, MOVAtom atom)
 {
     // Set by mov_read_tfhd(). mov_read_trun() will reject files missing tfhd.
@@ -1963,6 +2113,10 @@ static int mov_read_moof(MOVContext *c, AVIOContext *pb, MOVAtom atom)
                     "seekable, can not look for mfra\n");
         }
     }
+    if (c->index_cache && !c->index_cache_checked) {
+        c->index_cache_checked = 1;
+        mov_load_index_cache(c);
+    }
     c->fragment.moof_offset = c->fragment.implicit_offset = avio_tell(pb) - 8;
     av_log(c->fc, AV_LOG_TRACE, "moof offset %"PRIx64"\n", c->fragment.moof_offset);
     c->frag_index.current = update_frag_index(c, c->fragment.moof_offset);
@@ -4397,11 +4551,371 @@ static int add_tts_entry(MOVTimeToSample **tts_data, unsigned int *tts_count, un
     return 0;
 }
 
+/*
+ * Lazy index
+ *
+ * With the lazy_index option, the samples of simple tracks are not expanded
+ * into the index entries of the stream. The sample tables are kept in their
+ * compact form instead, and samples are resolved on demand by a cursor which
+ * advances to the following sample in constant time. The time to sample
+ * table is kept as runs of samples sharing the same duration and offset.
+ * The first sample and dts of each time to sample run, and the first sample
+ * of each sample to chunk run, are stored so that seeks are resolved with
+ * binary searches over the runs.
+ */
+
+#define MOV_LAZY_MAX_STEPS 32
+
+static int mov_lazy_key_off(const MOVStreamContext *sc)
+{
+    return (sc->keyframe_count && sc->keyframes[0] > 0) || (sc->stps_count && sc->stps_data[0] > 0);
+}
+
+/* Return the index of the first element of a sorted list not below value. */
+static unsigned int mov_lazy_lower_bound(const unsigned int *list, unsigned int count,
+                                         unsigned int value)
+{
+    unsigned int lo = 0, hi = count;
+
+    while (lo < hi) {
+        unsigned int mid = lo + (hi - lo) / 2;
+        if (list[mid] < value)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    return lo;
+}
+
+/* Return the time to sample run of sample; the last run extends to the end. */
+static unsigned int mov_lazy_tts_run(const MOVStreamContext *sc, unsigned int sample)
+{
+    return mov_lazy_lower_bound(sc->lazy_tts_first + 1, sc->tts_count - 1, sample + 1);
+}
+
+static int64_t mov_lazy_sample_dts(const MOVStreamContext *sc, unsigned int sample)
+{
+    unsigned int run = mov_lazy_tts_run(sc, sample);
+
+    return sc->lazy_first_dts + sc->lazy_tts_dts[run] +
+           (int64_t)(sample - sc->lazy_tts_first[run]) * sc->tts_data[run].duration;
+}
+
+/* Same rules as mov_build_index(). */
+static int mov_lazy_is_stss_key(const MOVStreamContext *sc, const MOVSampleCursor *cur)
+{
+    return !sc->keyframe_absent &&
+           (!sc->keyframe_count ||
+            cur->sample + mov_lazy_key_off(sc) == sc->keyframes[cur->stss_index]);
+}
+
+static int mov_lazy_is_stps_key(const MOVStreamContext *sc, const MOVSampleCursor *cur)
+{
+    return sc->stps_count && cur->sample + mov_lazy_key_off(sc) == sc->stps_data[cur->stps_index];
+}
+
+static void mov_lazy_update_entry(AVStream *st)
+{
+    MOVStreamContext *sc = st->priv_data;
+    MOVSampleCursor *cur = &sc->cursor;
+    int keyframe = mov_lazy_is_stss_key(sc, cur) || mov_lazy_is_stps_key(sc, cur) ||
+                   (sc->keyframe_absent && !sc->stps_count &&
+                    (st->codecpar->codec_type == AVMEDIA_TYPE_AUDIO || (!cur->chunk && !cur->chunk_sample)));
+
+    cur->entry.size  = sc->stsz_sample_size > 0 ? sc->stsz_sample_size : sc->sample_sizes[cur->sample];
+    cur->entry.flags = (keyframe ? AVINDEX_KEYFRAME : 0) |
+                       (cur->sample < sc->lazy_discard ? AVINDEX_DISCARD_FRAME : 0);
+    if (keyframe)
+        cur->entry.min_distance = 0;
+}
+
+/* Move the cursor to the first sample of the next chunk holding samples. */
+static void mov_lazy_next_chunk(const MOVStreamContext *sc, MOVSampleCursor *cur)
+{
+    cur->chunk_sample = 0;
+    while (++cur->chunk < sc->chunk_count) {
+        while (mov_stsc_index_valid(cur->stsc_index, sc->stsc_count) &&
+               cur->chunk + 1 == sc->stsc_data[cur->stsc_index + 1].first)
+            cur->stsc_index++;
+        if (sc->stsc_data[cur->stsc_index].count)
+            break;
+    }
+    if (cur->chunk < sc->chunk_count)
+        cur->entry.pos = sc->chunk_offsets[cur->chunk];
+}
+
+static void mov_lazy_reset(AVStream *st)
+{
+    MOVStreamContext *sc = st->priv_data;
+    MOVSampleCursor *cur = &sc->cursor;
+
+    memset(cur, 0, sizeof(*cur));
+    cur->chunk = UINT_MAX;
+    mov_lazy_next_chunk(sc, cur);
+    cur->entry.timestamp = sc->lazy_first_dts;
+    mov_lazy_update_entry(st);
+}
+
+static void mov_lazy_next(AVStream *st)
+{
+    MOVStreamContext *sc = st->priv_data;
+    MOVSampleCursor *cur = &sc->cursor;
+
+    if (mov_lazy_is_stss_key(sc, cur)) {
+        if (cur->stss_index + 1 < sc->keyframe_count)
+            cur->stss_index++;
+    } else if (mov_lazy_is_stps_key(sc, cur)) {
+        if (cur->stps_index + 1 < sc->stps_count)
+            cur->stps_index++;
+    }
+
+    cur->entry.pos       += cur->entry.size;
+    cur->entry.timestamp += sc->tts_data[cur->tts_index].duration;
+    cur->entry.min_distance++;
+    cur->tts_sample++;
+    if (cur->tts_index + 1 < sc->tts_count && cur->tts_sample == sc->tts_data[cur->tts_index].count) {
+        cur->tts_sample = 0;
+        cur->tts_index++;
+    }
+
+    cur->sample++;
+    if (++cur->chunk_sample >= sc->stsc_data[cur->stsc_index].count)
+        mov_lazy_next_chunk(sc, cur);
+    if (cur->sample < sc->lazy_count)
+        mov_lazy_update_entry(st);
+}
+
+/*
+ * Return the closest keyframe at or before (backward) or at or after sample,
+ * or -1 if there is none.
+ */
+static int64_t mov_lazy_find_keyframe(const AVStream *st, unsigned int sample, int backward)
+{
+    const MOVStreamContext *sc = st->priv_data;
+    int key_off = mov_lazy_key_off(sc);
+    int64_t best = -1;
+
+    if (!sc->keyframe_absent && !sc->keyframe_count)
+        return sample;
+    if (sc->keyframe_absent && !sc->stps_count) {
+        if (st->codecpar->codec_type == AVMEDIA_TYPE_AUDIO)
+            return sample;
+        /* only the first sample of the first chunk is a keyframe */
+        return sc->stsc_data[0].count && (backward || !sample) ? 0 : -1;
+    }
+
+    for (int i = 0; i < 2; i++) {
+        const unsigned int *list = i ? sc->stps_data : (const unsigned int *)sc->keyframes;
+        unsigned int count = i ? sc->stps_count : sc->keyframe_absent ? 0 : sc->keyframe_count;
+        unsigned int k;
+        int64_t key;
+
+        if (!count)
+            continue;
+        k = mov_lazy_lower_bound(list, count, sample + key_off);
+        if (backward) {
+            if (k < count && list[k] == sample + key_off)
+                key = sample;
+            else if (k)
+                key = (int64_t)list[k - 1] - key_off;
+            else
+                continue;
+            best = FFMAX(best, key);
+        } else {
+            if (k == count)
+                continue;
+            key = (int64_t)list[k] - key_off;
+            if (best < 0 || key < best)
+                best = key;
+        }
+    }
+
+    return best < sc->lazy_count ? best : -1;
+}
+
+/* Move the cursor to sample, which must be below lazy_count. */
+static void mov_lazy_seek(AVStream *st, unsigned int sample)
+{
+    MOVStreamContext *sc = st->priv_data;
+    MOVSampleCursor *cur = &sc->cursor;
+    int key_off = mov_lazy_key_off(sc);
+    unsigned int n;
+
+    if (sample >= cur->sample && sample - cur->sample <= MOV_LAZY_MAX_STEPS) {
+        while (cur->sample < sample)
+            mov_lazy_next(st);
+        return;
+    }
+
+    memset(cur, 0, sizeof(*cur));
+    cur->sample = sample;
+
+    cur->tts_index  = mov_lazy_tts_run(sc, sample);
+    cur->tts_sample = sample - sc->lazy_tts_first[cur->tts_index];
+    cur->entry.timestamp = mov_lazy_sample_dts(sc, sample);
+
+    /* last sample to chunk run starting at or before sample */
+    cur->stsc_index = mov_lazy_lower_bound(sc->lazy_stsc_first + 1, sc->stsc_count - 1, sample + 1);
+    n = sample - sc->lazy_stsc_first[cur->stsc_index];
+    cur->chunk        = sc->stsc_data[cur->stsc_index].first - 1 + n / sc->stsc_data[cur->stsc_index].count;
+    cur->chunk_sample = n % sc->stsc_data[cur->stsc_index].count;
+
+    cur->entry.pos = sc->chunk_offsets[cur->chunk];
+    if (sc->stsz_sample_size > 0)
+        cur->entry.pos += (int64_t)cur->chunk_sample * sc->stsz_sample_size;
+    else
+        for (unsigned int i = sample - cur->chunk_sample; i < sample; i++)
+            cur->entry.pos += sc->sample_sizes[i];
+
+    if (sc->keyframe_count)
+        cur->stss_index = FFMIN(mov_lazy_lower_bound((const unsigned int *)sc->keyframes,
+                                                     sc->keyframe_count, sample + key_off),
+                                sc->keyframe_count - 1);
+    if (sc->stps_count)
+        cur->stps_index = FFMIN(mov_lazy_lower_bound(sc->stps_data, sc->stps_count, sample + key_off),
+                                sc->stps_count - 1);
+
+    mov_lazy_update_entry(st);
+    if (!(cur->entry.flags & AVINDEX_KEYFRAME)) {
+        int64_t key = mov_lazy_find_keyframe(st, sample, 1);
+        cur->entry.min_distance = sample - FFMAX(key, 0);
+    }
+}
+
+/*
+ * Same as av_index_search_timestamp() over the samples of a track using the
+ * lazy index, with the same handling of the discarded samples.
+ */
+static int mov_lazy_search_timestamp(AVStream *st, int64_t wanted, int flags)
+{
+    MOVStreamContext *sc = st->priv_data;
+    int64_t a = -1, b = sc->lazy_count, m;
+
+    if (mov_lazy_sample_dts(sc, b - 1) < wanted)
+        a = b - 1;
+
+    while (b - a > 1) {
+        int64_t timestamp;
+
+        m = (a + b) >> 1;
+        /* the discarded samples are all at the start */
+        while (m < sc->lazy_discard && m < b && m < sc->lazy_count - 1) {
+            m++;
+            if (m == b && mov_lazy_sample_dts(sc, m) >= wanted) {
+                m = b - 1;
+                break;
+            }
+        }
+
+        timestamp = mov_lazy_sample_dts(sc, m);
+        if (timestamp >= wanted)
+            b = m;
+        if (timestamp <= wanted)
+            a = m;
+    }
+
+    m = (flags & AVSEEK_FLAG_BACKWARD) ? a : b;
+    if (m < 0 || m >= sc->lazy_count)
+        return -1;
+    if (!(flags & AVSEEK_FLAG_ANY))
+        m = mov_lazy_find_keyframe(st, m, flags & AVSEEK_FLAG_BACKWARD);
+    return m;
+}
+
+/*
+ * Return the index entry of sample, or NULL if it does not exist. With the
+ * lazy index, the entry is only valid until the next lookup on the track.
+ */
+static AVIndexEntry *mov_get_sample(AVStream *st, int sample)
+{
+    MOVStreamContext *sc = st->priv_data;
+    FFStream *const sti = ffstream(st);
+
+    if (!sc->lazy_index)
+        return sample >= 0 && sample < sti->nb_index_entries ? &sti->index_entries[sample] : NULL;
+    if (sample < 0 || sample >= sc->lazy_count)
+        return NULL;
+    mov_lazy_seek(st, sample);
+    return &sc->cursor.entry;
+}
+
+static int mov_nb_samples(AVStream *st)
+{
+    MOVStreamContext *sc = st->priv_data;
+    return sc->lazy_index ? sc->lazy_count : ffstream(st)->nb_index_entries;
+}
+
+static int mov_search_sample(AVStream *st, int64_t timestamp, int flags)
+{
+    MOVStreamContext *sc = st->priv_data;
+    if (sc->lazy_index)
+        return mov_lazy_search_timestamp(st, timestamp, flags);
+    return av_index_search_timestamp(st, timestamp, flags);
+}
+
+/*
+ * Build the index entries and expand the time to sample runs of a track
+ * using the lazy index, for code that needs the full index.
+ */
+static int mov_lazy_index_expand(AVStream *st)
+{
+    MOVStreamContext *sc = st->priv_data;
+    FFStream *const sti = ffstream(st);
+    MOVTimeToSample *tts_data;
+    AVIndexEntry *entries;
+    unsigned int nb_tts = 0, tts_index = 0;
+
+    if (!sc->lazy_index)
+        return 0;
+
+    entries  = av_malloc_array(sc->lazy_count, sizeof(*entries));
+    tts_data = av_malloc_array(sc->sample_count, sizeof(*tts_data));
+    if (!entries || !tts_data) {
+        av_free(entries);
+        av_free(tts_data);
+        return AVERROR(ENOMEM);
+    }
+
+    for (unsigned int i = 0; i < sc->tts_count && nb_tts < sc->sample_count; i++) {
+        if (i == sc->tts_index)
+            tts_index = nb_tts + sc->tts_sample;
+        for (unsigned int j = 0; j < sc->tts_data[i].count && nb_tts < sc->sample_count; j++) {
+            tts_data[nb_tts] = sc->tts_data[i];
+            tts_data[nb_tts++].count = 1;
+        }
+    }
+    if (sc->tts_index >= sc->tts_count)
+        tts_index = nb_tts;
+
+    mov_lazy_reset(st);
+    for (unsigned int i = 0; i < sc->lazy_count; i++) {
+        entries[i] = sc->cursor.entry;
+        mov_lazy_next(st);
+    }
+
+    av_free(sti->index_entries);
+    sti->index_entries = entries;
+    sti->nb_index_entries = sc->lazy_count;
+    sti->index_entries_allocated_size = sc->lazy_count * sizeof(*entries);
+
+    av_free(sc->tts_data);
+    sc->tts_data = tts_data;
+    sc->tts_count = nb_tts;
+    sc->tts_allocated_size = sc->sample_count * sizeof(*tts_data);
+    sc->tts_index = tts_index;
+    sc->tts_sample = 0;
+
+    av_freep(&sc->lazy_tts_first);
+    av_freep(&sc->lazy_tts_dts);
+    av_freep(&sc->lazy_stsc_first);
+    sc->lazy_index = 0;
+    return 0;
+}
+
 #define MAX_REORDER_DELAY 16
 static void mov_estimate_video_delay(MOVContext *c, AVStream* st)
 {
     MOVStreamContext *msc = st->priv_data;
-    FFStream *const sti = ffstream(st);
     int ctts_ind = 0;
     int ctts_sample = 0;
     int64_t pts_buf[MAX_REORDER_DELAY + 1]; // Circular buffer to sort pts.
@@ -4414,14 +4928,14 @@ static void mov_estimate_video_delay(MOVContext *c, AVStream* st)
     if (st->codecpar->video_delay <= 0 && msc->ctts_count &&
         st->codecpar->codec_id == AV_CODEC_ID_H264) {
         st->codecpar->video_delay = 0;
-        for (int ind = 0; ind < sti->nb_index_entries && ctts_ind < msc->tts_count; ++ind) {
+        for (int ind = 0; ind < mov_nb_samples(st) && ctts_ind < msc->tts_count; ++ind) {
             // Point j to the last elem of the buffer and insert the current pts there.
             j = buf_start;
             buf_start = (buf_start + 1);
             if (buf_start == MAX_REORDER_DELAY + 1)
                 buf_start = 0;
 
-            pts_buf[j] = sti->index_entries[ind].timestamp + msc->tts_data[ctts_ind].offset;
+            pts_buf[j] = mov_get_sample(st, ind)->timestamp + msc->tts_data[ctts_ind].offset;
 
             // The timestamps that are already in the sorted buffer, and are greater than the
             // current pts, are exactly the timestamps that need to be buffered to output PTS
@@ -4957,6 +5471,295 @@ static int mov_merge_tts_data(MOVContext *mov, AVStream *st, int flags)
     return 0;
 }
 
+/*
+ * Check that mov_fix_index() would keep all the samples of a track using the
+ * lazy index, with their timestamps, for the single edit of the track.
+ */
+static int mov_lazy_edit_is_noop(AVStream *st, int64_t edit_time, int64_t edit_duration)
+{
+    MOVStreamContext *sc = st->priv_data;
+    MOVSampleCursor *cur = &sc->cursor;
+    int64_t edit_end = edit_time + edit_duration;
+    int video = st->codecpar->codec_type == AVMEDIA_TYPE_VIDEO;
+    int found_keyframe_after_edit = 0;
+
+    for (mov_lazy_reset(st); cur->sample < sc->lazy_count; mov_lazy_next(st)) {
+        const MOVTimeToSample *tts = &sc->tts_data[cur->tts_index];
+        int64_t pts = cur->entry.timestamp + tts->offset;
+        int64_t duration = cur->sample + 1 < sc->lazy_count ? tts->duration : edit_duration;
+        int keyframe = cur->entry.flags & AVINDEX_KEYFRAME;
+
+        if (pts < edit_time || pts >= edit_end)
+            return 0;
+        /* decoding has to start with the first sample */
+        if (!cur->sample ? pts != edit_time || !keyframe
+                         : keyframe && cur->entry.timestamp <= edit_time)
+            return 0;
+        /* and must not stop before the last one */
+        if (pts + duration >= edit_end && (keyframe || !video) &&
+            cur->sample + 1 < sc->lazy_count) {
+            if (!sc->ctts_count || !video || found_keyframe_after_edit)
+                return 0;
+            found_keyframe_after_edit = 1;
+        }
+    }
+    return 1;
+}
+
+/*
+ * Check that the single edit of an audio track only trims the start of the
+ * samples, like the encoder delay of AAC, and set up the lazy index the way
+ * mov_fix_index() would: the samples ending before the edit are discarded,
+ * the start of the next one is skipped by the decoder, and the samples after
+ * the one reaching the end of the edit are dropped. The caller shifts the
+ * timestamps by edit_time.
+ */
+static int mov_lazy_edit_audio_start(AVStream *st, int64_t edit_time, int64_t edit_duration)
+{
+    MOVStreamContext *sc = st->priv_data;
+    MOVSampleCursor *cur = &sc->cursor;
+    int64_t edit_end = edit_time + edit_duration;
+    int64_t min_pts = -1;
+    unsigned int discard = 0, count = sc->lazy_count;
+    int started = 0;
+
+    /* mov_fix_index() starts decoding up to one second before the edit */
+    if (st->codecpar->codec_type != AVMEDIA_TYPE_AUDIO ||
+        st->codecpar->codec_id == AV_CODEC_ID_VORBIS ||
+        sc->lazy_first_dts > edit_time || edit_time - sc->time_scale > sc->lazy_first_dts)
+        return 0;
+    for (unsigned int i = 0; i < sc->tts_count; i++)
+        if (sc->tts_data[i].offset || !sc->tts_data[i].duration)
+            return 0;
+
+    for (mov_lazy_reset(st); cur->sample < sc->lazy_count; mov_lazy_next(st)) {
+        int64_t dts = cur->entry.timestamp;
+        int64_t duration = cur->sample + 1 < sc->lazy_count ? sc->tts_data[cur->tts_index].duration
+                                                            : edit_duration;
+
+        if (dts + duration > edit_time)
+            started = 1;
+        else
+            discard = cur->sample + 1;
+        if (dts >= edit_time && min_pts < 0)
+            min_pts = dts - edit_time;
+        if (dts + duration >= edit_end) {
+            count = cur->sample + 1;
+            break;
+        }
+    }
+    if (!started)
+        return 0;
+
+    sc->lazy_discard      = discard;
+    sc->lazy_count        = count;
+    sc->min_corrected_pts = min_pts;
+    return 1;
+}
+
+/*
+ * Set up the lazy index of a track. Return 1 if the samples of the track are
+ * resolved from its sample tables, 0 if the full index has to be built.
+ */
+static int mov_build_lazy_index(MOVContext *mov, AVStream *st, int64_t first_dts)
+{
+    MOVStreamContext *sc = st->priv_data;
+    FFStream *const sti = ffstream(st);
+    int video = st->codecpar->codec_type == AVMEDIA_TYPE_VIDEO;
+    int64_t edit_time = 0, edit_duration = 0;
+    int single_edit = 0, audio_start = 0;
+    unsigned int stsc_index = 0, nb_tts = 0;
+    unsigned int stts_index = 0, stts_used = 0, ctts_index = 0, ctts_used = 0;
+    uint64_t nb_samples = 0, stream_size = 0, stts_total = 0, ctts_total = 0;
+    MOVTimeToSample *tts_data;
+
+    if (!mov->lazy_index ||
+        (!video && st->codecpar->codec_type != AVMEDIA_TYPE_AUDIO) ||
+        sc->iamf || sc->dv_audio_container ||
+        !sc->chunk_count || !sc->stsc_count || !sc->stts_data ||
+        sc->rap_group_count || sc->sample_offsets_count || sc->sample_count > INT_MAX ||
+        /* durations rewritten by mov_update_sample_durations() */
+        (video && sc->ctts_count && sc->stts_count >= 2))
+        return 0;
+
+    if (sc->elst_count && !mov->ignore_editlist && mov->advanced_editlist) {
+        /* mov_fix_index() needs the full index, unless it has nothing to do */
+        if (sc->elst_count != 1 || sc->dts_shift || sc->elst_data[0].time < 0 ||
+            !get_edit_list_entry(mov, sc, 0, &edit_time, &edit_duration, mov->time_scale) ||
+            edit_duration <= 0)
+            return 0;
+        single_edit = 1;
+    }
+
+    for (unsigned int i = 0; i < sc->stsc_count; i++)
+        if (sc->stsc_data[i].count < 0 || (unsigned)sc->stsc_data[i].first > sc->chunk_count ||
+            (i ? sc->stsc_data[i].first <= sc->stsc_data[i - 1].first : sc->stsc_data[i].first != 1) ||
+            (sc->pseudo_stream_id != -1 && sc->stsc_data[i].id - 1 != sc->pseudo_stream_id))
+            return 0;
+    for (unsigned int i = 1; i < sc->keyframe_count; i++)
+        if ((unsigned)sc->keyframes[i] <= (unsigned)sc->keyframes[i - 1])
+            return 0;
+    for (unsigned int i = 1; i < sc->stps_count; i++)
+        if (sc->stps_data[i] <= sc->stps_data[i - 1])
+            return 0;
+
+    for (unsigned int i = 0; i < sc->chunk_count; i++) {
+        int64_t next_offset = i + 1 < sc->chunk_count ? sc->chunk_offsets[i + 1] : INT64_MAX;
+
+        while (mov_stsc_index_valid(stsc_index, sc->stsc_count) &&
+               i + 1 == sc->stsc_data[stsc_index + 1].first)
+            stsc_index++;
+
+        /* leave the sample size corrections to mov_build_index() */
+        if ((next_offset > sc->chunk_offsets[i] && sc->sample_size > 0 &&
+             sc->sample_size < sc->stsz_sample_size &&
+             sc->stsc_data[stsc_index].count * (int64_t)sc->stsz_sample_size > next_offset - sc->chunk_offsets[i]) ||
+            (sc->stsz_sample_size > 0 && sc->stsz_sample_size < sc->sample_size))
+            return 0;
+
+        nb_samples += sc->stsc_data[stsc_index].count;
+    }
+    if (!nb_samples || nb_samples > sc->sample_count)
+        return 0;
+
+    if (sc->stsz_sample_size > 0) {
+        if (sc->stsz_sample_size > 0x3FFFFFFF)
+            return 0;
+        stream_size = nb_samples * sc->stsz_sample_size;
+    } else {
+        if (!sc->sample_sizes)
+            return 0;
+        for (unsigned int i = 0; i < nb_samples; i++) {
+            if (sc->sample_sizes[i] > 0x3FFFFFFF)
+                return 0;
+            stream_size += sc->sample_sizes[i];
+        }
+    }
+
+    for (unsigned int i = 0; i < sc->stts_count; i++)
+        stts_total += sc->stts_data[i].count;
+    for (unsigned int i = 0; sc->ctts_data && i < sc->ctts_count; i++)
+        ctts_total += sc->ctts_data[i].count;
+    if (stts_total < sc->sample_count || (sc->ctts_data && ctts_total < sc->sample_count))
+        return 0;
+
+    /*
+     * Merge stts and ctts into runs. The last sample gets a run of its own,
+     * so that the checks on all the durations but the last one keep working.
+     */
+    tts_data = av_malloc_array(sc->stts_count + sc->ctts_count + 1, sizeof(*tts_data));
+    if (!tts_data)
+        return 0;
+    for (unsigned int n = 0; n < sc->sample_count;) {
+        unsigned int count, duration;
+        int offset = 0;
+
+        while (stts_used == sc->stts_data[stts_index].count) {
+            stts_index++;
+            stts_used = 0;
+        }
+        count    = sc->stts_data[stts_index].count - stts_used;
+        duration = sc->stts_data[stts_index].duration;
+        if (sc->ctts_data) {
+            while (ctts_used == sc->ctts_data[ctts_index].count) {
+                ctts_index++;
+                ctts_used = 0;
+            }
+            count  = FFMIN(count, sc->ctts_data[ctts_index].count - ctts_used);
+            offset = sc->ctts_data[ctts_index].offset;
+        }
+        count = FFMIN(count, (n + 1 < sc->sample_count ? sc->sample_count - 1 : sc->sample_count) - n);
+
+        if (nb_tts && n + 1 < sc->sample_count &&
+            tts_data[nb_tts - 1].duration == duration && tts_data[nb_tts - 1].offset == offset) {
+            tts_data[nb_tts - 1].count += count;
+        } else {
+            tts_data[nb_tts].count    = count;
+            tts_data[nb_tts].duration = duration;
+            tts_data[nb_tts++].offset = offset;
+        }
+        stts_used += count;
+        ctts_used += count;
+        n         += count;
+    }
+
+    sc->tts_data           = tts_data;
+    sc->tts_count          = nb_tts;
+    sc->tts_allocated_size = nb_tts * sizeof(*tts_data);
+    sc->lazy_count         = nb_samples;
+    sc->lazy_discard       = 0;
+    sc->lazy_first_dts     = first_dts;
+    sc->lazy_index         = 1;
+
+    sc->lazy_tts_first  = av_malloc_array(nb_tts, sizeof(*sc->lazy_tts_first));
+    sc->lazy_tts_dts    = av_malloc_array(nb_tts, sizeof(*sc->lazy_tts_dts));
+    sc->lazy_stsc_first = av_malloc_array(sc->stsc_count, sizeof(*sc->lazy_stsc_first));
+    if (!sc->lazy_tts_first || !sc->lazy_tts_dts || !sc->lazy_stsc_first)
+        goto fail;
+    for (unsigned int i = 0, n = 0; i < nb_tts; i++) {
+        sc->lazy_tts_first[i] = n;
+        sc->lazy_tts_dts[i]   = i ? sc->lazy_tts_dts[i - 1] +
+                                    (int64_t)tts_data[i - 1].count * tts_data[i - 1].duration : 0;
+        n += tts_data[i].count;
+    }
+    for (unsigned int i = 0, n = 0; i < sc->stsc_count; i++) {
+        sc->lazy_stsc_first[i] = n;
+        n = FFMIN(n + mov_get_stsc_samples(sc, i), UINT_MAX);
+    }
+
+    if (single_edit) {
+        audio_start = !video && mov_lazy_edit_audio_start(st, edit_time, edit_duration);
+        if (!audio_start && !mov_lazy_edit_is_noop(st, edit_time, edit_duration))
+            goto fail;
+    }
+
+    if (video) {
+        mov_lazy_reset(st);
+        for (int i = 0; i < FFMIN(nb_samples, 99); i++, mov_lazy_next(st))
+            ff_rfps_add_frame(mov->fc, st, sc->cursor.entry.timestamp);
+    }
+    if (st->duration > 0)
+        st->codecpar->bit_rate = stream_size * 8 * sc->time_scale / st->duration;
+
+    if (single_edit) {
+        /* what mov_fix_index() sets up */
+        if ((video && edit_time > 0) || audio_start)
+            sc->lazy_first_dts -= edit_time;
+        if (!video)
+            sti->skip_samples = audio_start ? edit_time - first_dts : 0;
+        st->codecpar->initial_padding = sti->skip_samples;
+        st->start_time = 0;
+        st->duration = FFMIN(st->duration, edit_duration);
+        if (!audio_start)
+            sc->min_corrected_pts = edit_time;
+    }
+    if (st->start_time == AV_NOPTS_VALUE && video)
+        st->start_time = av_sat_add64(av_sat_add64(sc->lazy_first_dts, sc->dts_shift),
+                                      sc->tts_data[0].offset);
+
+    if (!sc->ctts_data)
+        sc->ctts_count = 0;
+    av_freep(&sc->ctts_data);
+    sc->ctts_allocated_size = 0;
+    av_freep(&sc->stts_data);
+    sc->stts_allocated_size = 0;
+
+    mov_lazy_reset(st);
+    av_log(mov->fc, AV_LOG_DEBUG, "stream %d: lazy index of %u samples in %u time to sample runs\n",
+           st->index, sc->lazy_count, sc->tts_count);
+    return 1;
+
+fail:
+    av_freep(&sc->tts_data);
+    av_freep(&sc->lazy_tts_first);
+    av_freep(&sc->lazy_tts_dts);
+    av_freep(&sc->lazy_stsc_first);
+    sc->tts_count = 0;
+    sc->tts_allocated_size = 0;
+    sc->lazy_index = 0;
+    return 0;
+}
+
 static void mov_build_index(MOVContext *mov, AVStream *st)
 {
     MOVStreamContext *sc = st->priv_data;
@@ -5041,6 +5844,10 @@ static void mov_build_index(MOVContext *mov, AVStream *st)
         current_dts -= sc->dts_shift;
         if (!sc->sample_count || sti->nb_index_entries || sc->tts_count)
             return;
+        if (mov_build_lazy_index(mov, st, current_dts)) {
+            mov_estimate_video_delay(mov, st);
+            return;
+        }
         if (sc->sample_count >= UINT_MAX / sizeof(*sti->index_entries) - sti->nb_index_entries)
             return;
         if (av_reallocp_array(&sti->index_entries,
@@ -5695,11 +6502,13 @@ static int mov_read_trak(MOVContext *c, AVIOContext *pb, MOVAtom atom)
         if (!stts_constant)
             ffstream(st)->need_parsing = AVSTREAM_PARSE_FULL;
     }
-    /* Do not need those anymore. */
-    av_freep(&sc->chunk_offsets);
-    av_freep(&sc->sample_sizes);
-    av_freep(&sc->keyframes);
-    av_freep(&sc->stps_data);
+    /* Do not need those anymore, unless the samples are resolved from them. */
+    if (!sc->lazy_index) {
+        av_freep(&sc->chunk_offsets);
+        av_freep(&sc->sample_sizes);
+        av_freep(&sc->keyframes);
+        av_freep(&sc->stps_data);
+    }
     av_freep(&sc->elst_data);
     av_freep(&sc->rap_group);
     av_freep(&sc->sync_group);
@@ -6198,7 +7007,7 @@ static int mov_read_trun(MOVContext *c, AVIOContext *pb, MOVAtom atom)
     int64_t dts, pts = AV_NOPTS_VALUE;
     int data_offset = 0;
     unsigned entries, first_sample_flags = frag->flags;
-    int flags, distance, i;
+    int flags, distance, i, ret;
     int64_t prev_dts = AV_NOPTS_VALUE;
     int next_frag_index = -1, index_entry_pos;
     size_t requested_size;
@@ -6226,6 +7035,8 @@ static int mov_read_trun(MOVContext *c, AVIOContext *pb, MOVAtom atom)
     sc = st->priv_data;
     if (sc->pseudo_stream_id+1 != frag->stsd_id && sc->pseudo_stream_id != -1)
         return 0;
+    if ((ret = mov_lazy_index_expand(st)) < 0)
+        return ret;
 
     // Find the next frag_index index that has a valid index_entry for
     // the current track_id.
@@ -8968,6 +9779,9 @@ static int cenc_filter(MOVContext *mov, AVStream* st, MOVStreamContext *sc, AVPa
         }
 
         if (mov->decryption_keys || mov->decryption_default_key) {
+            ret = av_packet_make_writable(pkt);
+            if (ret < 0)
+                return ret;
             return cenc_decrypt(mov, sc, encrypted_sample, pkt->data, pkt->size);
         } else {
             size_t size;
@@ -10368,6 +11182,9 @@ static void mov_read_chapters(AVFormatContext *s)
         sc = st->priv_data;
         cur_pos = avio_tell(sc->pb);
 
+        if (mov_lazy_index_expand(st) < 0)
+            continue;
+
         if (st->codecpar->codec_type == AVMEDIA_TYPE_VIDEO) {
             st->disposition |= AV_DISPOSITION_ATTACHED_PIC | AV_DISPOSITION_TIMED_THUMBNAILS;
             if (!st->attached_pic.data && sti->nb_index_entries) {
@@ -10548,6 +11365,9 @@ static void mov_free_stream_context(AVFormatContext *s, AVStream *st)
     }
 
     av_freep(&sc->tts_data);
+    av_freep(&sc->lazy_tts_first);
+    av_freep(&sc->lazy_tts_dts);
+    av_freep(&sc->lazy_stsc_first);
     for (int i = 0; i < sc->drefs_count; i++) {
         av_freep(&sc->drefs[i].path);
         av_freep(&sc->drefs[i].dir);
@@ -10627,6 +11447,7 @@ static int mov_read_close(AVFormatContext *s)
 
     av_freep(&mov->trex_data);
     av_freep(&mov->bitrates);
+    av_freep(&mov->index_cache_data);
 
     for (i = 0; i < mov->frag_index.nb_items; i++) {
         MOVFragmentStreamInfo *frag = mov->frag_index.item[i].stream_info;
@@ -11733,6 +12554,11 @@ static int mov_read_header(AVFormatContext *s)
         }
     }
 
+    if (mov->index_cache_data)
+        mov_apply_index_cache(mov);
+    else if (mov->index_cache_valid)
+        mov_save_index_cache(mov);
+
     ff_rfps_calculate(s);
 
     for (i = 0; i < s->nb_streams; i++) {
@@ -11818,10 +12644,9 @@ static AVIndexEntry *mov_find_next_sample(AVFormatContext *s, AVStream **st)
     int no_interleave = !mov->interleaved_read || !(s->pb->seekable & AVIO_SEEKABLE_NORMAL);
     for (i = 0; i < s->nb_streams; i++) {
         AVStream *avst = s->streams[i];
-        FFStream *const avsti = ffstream(avst);
         MOVStreamContext *msc = avst->priv_data;
-        if (msc->pb && msc->current_sample < avsti->nb_index_entries) {
-            AVIndexEntry *current_sample = &avsti->index_entries[msc->current_sample];
+        if (msc->pb && msc->current_sample < mov_nb_samples(avst)) {
+            AVIndexEntry *current_sample = mov_get_sample(avst, msc->current_sample);
             int64_t dts = av_rescale(current_sample->timestamp, AV_TIME_BASE, msc->time_scale);
             uint64_t dtsdiff = best_dts > dts ? best_dts - (uint64_t)dts : ((uint64_t)dts - best_dts);
             av_log(s, AV_LOG_TRACE, "stream %d, sample %d, dts %"PRId64"\n", i, msc->current_sample, dts);
@@ -11992,8 +12817,8 @@ static int mov_finalize_packet(AVFormatContext *s, AVStream *st, AVIndexEntry *s
         pkt->pts = av_sat_add64(pkt->dts, av_sat_add64(sc->dts_shift, sc->tts_data[sc->tts_index].offset));
     } else {
         if (pkt->duration == 0) {
-            int64_t next_dts = (sc->current_sample < ffstream(st)->nb_index_entries) ?
-                ffstream(st)->index_entries[sc->current_sample].timestamp : st->duration;
+            const AVIndexEntry *next = mov_get_sample(st, sc->current_sample);
+            int64_t next_dts = next ? next->timestamp : st->duration;
             if (next_dts >= pkt->dts)
                 pkt->duration = next_dts - pkt->dts;
         }
@@ -12001,7 +12826,7 @@ static int mov_finalize_packet(AVFormatContext *s, AVStream *st, AVIndexEntry *s
     }
 
     if (st->codecpar->codec_type == AVMEDIA_TYPE_AUDIO && !mov->fragment.found_tfhd &&
-        sc->current_sample >= ffstream(st)->nb_index_entries) {
+        sc->current_sample >= mov_nb_samples(st)) {
         int64_t pts   = av_rescale_q(pkt->pts,     st->time_base, (AVRational){ 1, st->codecpar->sample_rate });
         int64_t total = av_rescale_q(st->duration, st->time_base, (AVRational){ 1, st->codecpar->sample_rate });
         int64_t duration = pkt->duration;
@@ -12063,7 +12888,7 @@ static int mov_read_packet(AVFormatContext *s, AVPacket *pkt)
 {
     MOVContext *mov = s->priv_data;
     MOVStreamContext *sc;
-    AVIndexEntry *sample;
+    AVIndexEntry *sample, lazy_sample;
     AVStream *st = NULL;
     FFStream *avsti = NULL;
     int64_t current_index;
@@ -12114,6 +12939,11 @@ static int mov_read_packet(AVFormatContext *s, AVPacket *pkt)
         goto retry;
     }
     sc = st->priv_data;
+    if (sc->lazy_index) {
+        /* the entry of the cursor changes with the next lookup */
+        lazy_sample = *sample;
+        sample = &lazy_sample;
+    }
     /* must be done just before reading, to avoid infinite loop on sample */
     current_index = sc->current_index;
     mov_current_sample_inc(sc);
@@ -12185,9 +13015,9 @@ static int mov_read_packet(AVFormatContext *s, AVPacket *pkt)
                     return AVERROR_INVALIDDATA;
                 au_size = sample->size - 4;
             }
-            ret = av_get_packet(sc->pb, pkt, au_size);
+            ret = ff_get_mapped_packet(sc->pb, st->codecpar, pkt, au_size);
         } else
-            ret = av_get_packet(sc->pb, pkt, sample->size);
+            ret = ff_get_mapped_packet(sc->pb, st->codecpar, pkt, sample->size);
         if (ret < 0) {
             if (should_retry(sc->pb, ret)) {
                 mov_current_sample_dec(sc);
@@ -12229,8 +13059,12 @@ static int mov_read_packet(AVFormatContext *s, AVPacket *pkt)
     if (st->discard == AVDISCARD_ALL)
         goto retry;
 
-    if (mov->aax_mode)
+    if (mov->aax_mode) {
+        ret = av_packet_make_writable(pkt);
+        if (ret < 0)
+            return ret;
         aax_filter(pkt->data, pkt->size, mov);
+    }
 
     ret = cenc_filter(mov, st, sc, pkt, current_index);
     if (ret < 0) {
@@ -12306,7 +13140,6 @@ static int can_seek_to_key_sample(AVStream *st, int sample, int64_t requested_pt
 static int mov_seek_stream(AVFormatContext *s, AVStream *st, int64_t timestamp, int flags)
 {
     MOVStreamContext *sc = st->priv_data;
-    FFStream *const sti = ffstream(st);
     int sample, time_sample, ret, requested_sample;
     int64_t next_ts;
     unsigned int i;
@@ -12320,9 +13153,9 @@ static int mov_seek_stream(AVFormatContext *s, AVStream *st, int64_t timestamp,
         return ret;
 
     for (;;) {
-        sample = av_index_search_timestamp(st, timestamp, flags);
+        sample = mov_search_sample(st, timestamp, flags);
         av_log(s, AV_LOG_TRACE, "stream %d, timestamp %"PRId64", sample %d\n", st->index, timestamp, sample);
-        if (sample < 0 && sti->nb_index_entries && timestamp < sti->index_entries[0].timestamp)
+        if (sample < 0 && mov_nb_samples(st) && timestamp < mov_get_sample(st, 0)->timestamp)
             sample = 0;
         if (sample < 0) /* not sure what to do */
             return AVERROR_INVALIDDATA;
@@ -12331,7 +13164,7 @@ static int mov_seek_stream(AVFormatContext *s, AVStream *st, int64_t timestamp,
             break;
 
         next_ts = timestamp - FFMAX(sc->min_sample_duration, 1);
-        requested_sample = av_index_search_timestamp(st, next_ts, flags);
+        requested_sample = mov_search_sample(st, next_ts, flags);
         if (requested_sample < 0)
             return AVERROR_INVALIDDATA;
 
@@ -12380,9 +13213,8 @@ static int mov_seek_stream(AVFormatContext *s, AVStream *st, int64_t timestamp,
 
 static int64_t mov_get_skip_samples(AVStream *st, int sample)
 {
-    FFStream *const sti = ffstream(st);
-    int64_t first_ts = sti->index_entries[0].timestamp;
-    int64_t ts = sti->index_entries[sample].timestamp;
+    int64_t first_ts = mov_get_sample(st, 0)->timestamp;
+    int64_t ts = mov_get_sample(st, sample)->timestamp;
     int64_t off;
 
     if (st->codecpar->codec_type != AVMEDIA_TYPE_AUDIO)
@@ -12413,7 +13245,7 @@ static int mov_read_seek(AVFormatContext *s, int stream_index, int64_t sample_ti
 
     if (mc->seek_individually) {
         /* adjust seek timestamp to found sample timestamp */
-        int64_t seek_timestamp = sti->index_entries[sample].timestamp;
+        int64_t seek_timestamp = mov_get_sample(st, sample)->timestamp;
         sti->skip_samples = mov_get_skip_samples(st, sample);
 
         for (i = 0; i < s->nb_streams; i++) {
@@ -12502,6 +13334,8 @@ static const AVOption mov_options[] = {
         {.i64 = 0}, 0, 1, FLAGS },
     { "max_stts_delta", "treat offsets above this value as invalid", OFFSET(max_stts_delta), AV_OPT_TYPE_INT, {.i64 = UINT_MAX-48000*10 }, 0, UINT_MAX, .flags = AV_OPT_FLAG_DECODING_PARAM },
     { "interleaved_read", "Interleave packets from multiple tracks at demuxer level", OFFSET(interleaved_read), AV_OPT_TYPE_BOOL, {.i64 = 1 }, 0, 1, .flags = AV_OPT_FLAG_DECODING_PARAM },
+    { "lazy_index", "Resolve samples from the sample tables instead of building a full index", OFFSET(lazy_index), AV_OPT_TYPE_BOOL, {.i64 = 0 }, 0, 1, .flags = AV_OPT_FLAG_DECODING_PARAM },
+    { "index_cache", "Cache the fragment index in the given file", OFFSET(index_cache), AV_OPT_TYPE_STRING, {.str = NULL}, .flags = AV_OPT_FLAG_DECODING_PARAM },
 
     { NULL },
 };
@@ -44,6 +44,7 @@
 #include "mpeg.h"
 #include "isom.h"
 #include "id3v2.h"
+#include "indexcache.h"
 #if CONFIG_ICONV
 #include <iconv.h>
 #endif
@@ -183,6 +184,12 @@ struct MpegTSContext {
 
     int id;
 
+    /** sidecar file caching the seek points found in previous sessions */
+    char *index_cache;
+    FFIndexCacheKey index_cache_key;
+    int index_cache_valid;
+    int64_t index_cache_entries;
+
     /******************************************/
     /* private mpegts data */
     /* scan context */
@@ -227,6 +234,8 @@ static const AVOption options[] = {
      {.i64 = 0}, 0, 1, 0 },
     {"max_packet_size", "maximum size of emitted packet", offsetof(MpegTSContext, max_packet_size), AV_OPT_TYPE_INT,
      {.i64 = 204800}, TS_PAYLOAD_SIZE, INT_MAX/2, AV_OPT_FLAG_DECODING_PARAM },
+    {"index_cache", "cache the seek index in the given file", offsetof(MpegTSContext, index_cache), AV_OPT_TYPE_STRING,
+     {.str = NULL}, 0, 0, AV_OPT_FLAG_DECODING_PARAM },
     { NULL },
 };
 
@@ -3414,6 +3423,47 @@ static void finished_reading_packet(AVFormatContext *s, int raw_packet_size)
         avio_skip(pb, skip);
 }
 
+/* maximum number of packets checked for sync ahead of handling them */
+#define MAX_PACKET_RUN 512
+
+/*
+ * Handle a run of 188 byte packets that can be accessed in place in the I/O
+ * buffer, without going through read_packet() for each of them. The sync bytes of the whole run are checked up front, and
+ * the run ends before the first packet that has lost sync, which is then left
+ * to read_packet() to resync on. Handling stops early when a handler sets
+ * stop_parse; only the packets actually handled are consumed.
+ *
+ * Returns the number of packets handled, or a negative error code.
+ */
+static int handle_packet_run(MpegTSContext *ts, int64_t max_packets)
+{
+    AVIOContext *pb = ts->stream->pb;
+    const uint8_t *buf, *data;
+    int64_t pos = avio_tell(pb);
+    int nb_packets, i, ret = 0;
+
+    nb_packets = ffio_peek_direct(pb, &buf) / TS_PACKET_SIZE;
+    nb_packets = FFMIN(nb_packets, FFMIN(max_packets, MAX_PACKET_RUN));
+
+    for (i = 0; i < nb_packets; i++)
+        if (buf[i * TS_PACKET_SIZE] != SYNC_BYTE)
+            break;
+    nb_packets = i;
+
+    for (i = 0; i < nb_packets && !ts->stop_parse; i++) {
+        ret = handle_packet(ts, buf + i * TS_PACKET_SIZE,
+                            pos + (i + 1) * TS_PACKET_SIZE);
+        if (ret < 0) {
+            i++;
+            break;
+        }
+    }
+
+    if (i)
+        ffio_read_indirect(pb, NULL, i * TS_PACKET_SIZE, &data);
+    return ret < 0 ? ret : i;
+}
+
 static int handle_packets(MpegTSContext *ts, int64_t nb_packets)
 {
     AVFormatContext *s = ts->stream;
@@ -3455,6 +3505,18 @@ static int handle_packets(MpegTSContext *ts, int64_t nb_packets)
         if (ts->stop_parse > 0)
             break;
 
+        if (ts->raw_packet_size == TS_PACKET_SIZE) {
+            ret = handle_packet_run(ts, nb_packets ? nb_packets - packet_num
+                                                   : INT64_MAX);
+            if (ret < 0)
+                break;
+            if (ret > 0) {
+                packet_num += ret - 1;
+                ret = 0;
+                continue;
+            }
+        }
+
         ret = read_packet(s, packet, ts->raw_packet_size, &data);
         if (ret != 0)
             break;
@@ -3547,6 +3609,18 @@ static void seek_back(AVFormatContext *s, AVIOContext *pb, int64_t pos) {
         av_log(s, (pb->seekable & AVIO_SEEKABLE_NORMAL) ? AV_LOG_ERROR : AV_LOG_INFO, "Unable to seek back to the start\n");
 }
 
+static void mpegts_load_index_cache(AVFormatContext *s)
+{
+    MpegTSContext *ts = s->priv_data;
+
+    if ((s->flags & AVFMT_FLAG_IGNIDX) ||
+        ff_index_cache_key(s, &ts->index_cache_key) < 0)
+        return;
+    ts->index_cache_valid = 1;
+    ff_index_cache_load(s, ts->index_cache, &ts->index_cache_key, NULL, NULL);
+    ts->index_cache_entries = ff_index_cache_nb_entries(s);
+}
+
 static int mpegts_read_header(AVFormatContext *s)
 {
     MpegTSContext *ts = s->priv_data;
@@ -3643,6 +3717,8 @@ static int mpegts_read_header(AVFormatContext *s)
     }
 
     seek_back(s, pb, pos);
+    if (ts->index_cache)
+        mpegts_load_index_cache(s);
     return 0;
 }
 
@@ -3742,6 +3818,11 @@ static void mpegts_free(MpegTSContext *ts)
 static int mpegts_read_close(AVFormatContext *s)
 {
     MpegTSContext *ts = s->priv_data;
+
+    /* keep the seek points found in this session for the next one */
+    if (ts->index_cache_valid &&
+        ff_index_cache_nb_entries(s) != ts->index_cache_entries)
+        ff_index_cache_save(s, ts->index_cache, &ts->index_cache_key, 0, NULL, 0);
     mpegts_free(ts);
     return 0;
 }
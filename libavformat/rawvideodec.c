@@ -161,7 +161,8 @@ static int rawvideo_read_packet(AVFormatContext *ctx, AVPacket *pkt)
     RawVideoDemuxerContext *s = ctx->priv_data;
 
     if (!s->has_padding) {
-        ret = av_get_packet(ctx->pb, pkt, ctx->packet_size);
+        ret = ff_get_mapped_packet(ctx->pb, ctx->streams[0]->codecpar, pkt,
+                                   ctx->packet_size);
         if (ret < 0)
             return ret;
         pkt->pts = pkt->dts = pkt->pos / ctx->packet_size;
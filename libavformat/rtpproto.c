@@ -56,6 +56,7 @@ typedef struct RTPContext {
     int rtcp_port, local_rtpport, local_rtcpport;
     int connect;
     int pkt_size;
+    int batch_size;
     int dscp;
     char *sources;
     char *block;
@@ -81,6 +82,7 @@ static const AVOption options[] = {
     { "connect",            "Connect socket",                                                   OFFSET(connect),         AV_OPT_TYPE_BOOL,   { .i64 =  0 },     0, 1,       .flags = D|E },
     { "write_to_source",    "Send packets to the source address of the latest received packet", OFFSET(write_to_source), AV_OPT_TYPE_BOOL,   { .i64 =  0 },     0, 1,       .flags = D|E },
     { "pkt_size",           "Maximum packet size",                                              OFFSET(pkt_size),        AV_OPT_TYPE_INT,    { .i64 = -1 },    -1, INT_MAX, .flags = D|E },
+    { "batch_size",         "Maximum number of RTP packets per system call",                    OFFSET(batch_size),      AV_OPT_TYPE_INT,    { .i64 = -1 },    -1, 1024,    .flags = D|E },
     { "dscp",               "DSCP class",                                                       OFFSET(dscp),            AV_OPT_TYPE_INT,    { .i64 = -1 },    -1, INT_MAX, .flags = D|E },
     { "timeout",            "set timeout (in microseconds) of socket I/O operations",           OFFSET(rw_timeout),      AV_OPT_TYPE_INT64,  { .i64 = -1 },    -1, INT64_MAX, .flags = D|E },
     { "sources",            "Source list",                                                      OFFSET(sources),         AV_OPT_TYPE_STRING, { .str = NULL },               .flags = D|E },
@@ -181,7 +183,7 @@ static void build_udp_url(RTPContext *s,
                           char *buf, int buf_size,
                           const char *hostname,
                           const char *localaddr,
-                          int port, int local_port,
+                          int port, int local_port, int batch_size,
                           const char *include_sources,
                           const char *exclude_sources)
 {
@@ -194,6 +196,8 @@ static void build_udp_url(RTPContext *s,
         url_add_option(buf, buf_size, "buffer_size=%d", s->buffer_size);
     if (s->pkt_size >= 0)
         url_add_option(buf, buf_size, "pkt_size=%d", s->pkt_size);
+    if (batch_size >= 0)
+        url_add_option(buf, buf_size, "batch_size=%d", batch_size);
     if (s->connect)
         url_add_option(buf, buf_size, "connect=1");
     if (s->dscp >= 0)
@@ -214,6 +218,7 @@ static void build_udp_url(RTPContext *s,
  *         'localrtpport=n'   : set the local rtp port to n
  *         'localrtcpport=n'  : set the local rtcp port to n
  *         'pkt_size=n'       : set max packet size
+ *         'batch_size=n'     : send up to n rtp packets per system call
  *         'connect=0/1'      : do a connect() on the UDP socket
  *         'sources=ip[,ip]'  : list allowed source IP addresses
  *         'block=ip[,ip]'    : list disallowed source IP addresses
@@ -297,7 +302,7 @@ static int rtp_open(URLContext *h, const char *uri, int flags)
         const char *block = s->block ? s->block : "";
         build_udp_url(s, buf, sizeof(buf),
                       hostname, s->localaddr, rtp_port, s->local_rtpport,
-                      sources, block);
+                      s->batch_size, sources, block);
         ret = ffurl_open_whitelist(&s->rtp_hd, buf, flags, &h->interrupt_callback,
                                    NULL, h->protocol_whitelist, h->protocol_blacklist, h);
         if (ret < 0)
@@ -312,7 +317,7 @@ static int rtp_open(URLContext *h, const char *uri, int flags)
             s->local_rtcpport = s->local_rtpport + 1;
             build_udp_url(s, buf, sizeof(buf),
                           hostname, s->localaddr, s->rtcp_port, s->local_rtcpport,
-                          sources, block);
+                          -1, sources, block);
             if (ffurl_open_whitelist(&s->rtcp_hd, buf, rtcpflags,
                                      &h->interrupt_callback, NULL,
                                      h->protocol_whitelist, h->protocol_blacklist, h) < 0) {
@@ -323,7 +328,7 @@ static int rtp_open(URLContext *h, const char *uri, int flags)
         }
         build_udp_url(s, buf, sizeof(buf),
                       hostname, s->localaddr, s->rtcp_port, s->local_rtcpport,
-                      sources, block);
+                      -1, sources, block);
         ret = ffurl_open_whitelist(&s->rtcp_hd, buf, rtcpflags, &h->interrupt_callback,
                                    NULL, h->protocol_whitelist, h->protocol_blacklist, h);
         if (ret < 0)
@@ -29,10 +29,17 @@
 #include "network.h"
 #include "os_support.h"
 #include "url.h"
+#if HAVE_IO_URING
+#include "uring.h"
+#endif
 #if HAVE_POLL_H
 #include <poll.h>
 #endif
 
+/* Reads kept in flight with io_uring, and their size */
+#define URING_DEPTH    8
+#define URING_BUF_SIZE (64 << 10)
+
 typedef struct TCPContext {
     const AVClass *class;
     int fd;
@@ -49,6 +56,10 @@ typedef struct TCPContext {
 #if !HAVE_WINSOCK2_H
     int tcp_mss;
 #endif /* !HAVE_WINSOCK2_H */
+    int io_uring;
+#if HAVE_IO_URING
+    FFURing *ring;
+#endif
 } TCPContext;
 
 #define OFFSET(x) offsetof(TCPContext, x)
@@ -67,6 +78,7 @@ static const AVOption options[] = {
 #if !HAVE_WINSOCK2_H
     { "tcp_mss",     "Maximum segment size for outgoing TCP packets",          OFFSET(tcp_mss),     AV_OPT_TYPE_INT, { .i64 = -1 },         -1, INT_MAX, .flags = D|E },
 #endif /* !HAVE_WINSOCK2_H */
+    { "io_uring",    "Keep several reads in flight using io_uring",            OFFSET(io_uring),    AV_OPT_TYPE_BOOL, { .i64 = 0 },             0, 1, .flags = D },
     { NULL }
 };
 
@@ -77,6 +89,20 @@ static const AVClass tcp_class = {
     .version    = LIBAVUTIL_VERSION_INT,
 };
 
+static void setup_uring(URLContext *h)
+{
+#if HAVE_IO_URING
+    TCPContext *s = h->priv_data;
+    int ret;
+
+    if (!s->io_uring || !(h->flags & AVIO_FLAG_READ))
+        return;
+    ret = ff_uring_alloc(&s->ring, s->fd, 1, 0, URING_DEPTH, URING_BUF_SIZE);
+    if (ret < 0)
+        av_log(h, AV_LOG_WARNING, "Could not set up io_uring: %s\n", av_err2str(ret));
+#endif
+}
+
 static int customize_fd(void *ctx, int fd, int family)
 {
     TCPContext *s = ctx;
@@ -237,6 +263,8 @@ static int tcp_open(URLContext *h, const char *uri, int flags)
 
     h->is_streamed = 1;
     s->fd = fd;
+    if (s->listen != 2)
+        setup_uring(h);
 
     freeaddrinfo(ai);
     return 0;
@@ -263,6 +291,8 @@ static int tcp_accept(URLContext *s, URLContext **c)
         return ret;
     }
     cc->fd = ret;
+    cc->io_uring = sc->io_uring;
+    setup_uring(*c);
     return 0;
 }
 
@@ -271,6 +301,19 @@ static int tcp_read(URLContext *h, uint8_t *buf, int size)
     TCPContext *s = h->priv_data;
     int ret;
 
+#if HAVE_IO_URING
+    if (s->ring) {
+        while ((ret = ff_uring_read(s->ring, buf, size, 1)) == AVERROR(EAGAIN) &&
+               !(h->flags & AVIO_FLAG_NONBLOCK)) {
+            ret = ff_network_wait_fd_timeout(ff_uring_get_fd(s->ring), 0,
+                                             h->rw_timeout, &h->interrupt_callback);
+            if (ret)
+                return ret;
+        }
+        return ret;
+    }
+#endif
+
     if (!(h->flags & AVIO_FLAG_NONBLOCK)) {
         ret = ff_network_wait_fd_timeout(s->fd, 0, h->rw_timeout, &h->interrupt_callback);
         if (ret)
@@ -315,6 +358,9 @@ static int tcp_shutdown(URLContext *h, int flags)
 static int tcp_close(URLContext *h)
 {
     TCPContext *s = h->priv_data;
+#if HAVE_IO_URING
+    ff_uring_free(&s->ring);
+#endif
     closesocket(s->fd);
     return 0;
 }
@@ -0,0 +1,302 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+/**
+ * MPEG-TS demuxing benchmark. Demuxes each of the given files from start to
+ * end a number of times, without decoding, and reports the time spent
+ * opening the input and reading all packets, together with the resulting
+ * input throughput. Meant to be run on large real-world multiplexes; a
+ * single program can be selected to measure PID filtering, the other
+ * programs being discarded by the demuxer.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <inttypes.h>
+
+#include "libavutil/dict.h"
+#include "libavutil/log.h"
+#include "libavutil/mem.h"
+#include "libavutil/qsort.h"
+#include "libavutil/time.h"
+
+#include "libavcodec/packet.h"
+
+#include "libavformat/avformat.h"
+
+#define MAX_FILES 64
+
+enum OutputFormat {
+    OUTPUT_TEXT,
+    OUTPUT_CSV,
+};
+
+struct options {
+    const char *files[MAX_FILES];
+    int nb_files;
+    int iters;
+    int program;
+    const char *format;
+    AVDictionary *opts;
+    enum OutputFormat output;
+};
+
+struct result {
+    int64_t open_us;
+    int64_t read_us;
+    int64_t bytes;
+    int64_t packets;
+    int64_t payload;
+};
+
+static int cmp_read_time(const void *a, const void *b)
+{
+    const struct result *ra = a, *rb = b;
+    return FFDIFFSIGN(ra->read_us, rb->read_us);
+}
+
+static void select_program(AVFormatContext *s, int program_id)
+{
+    AVProgram *program = NULL;
+
+    for (unsigned i = 0; i < s->nb_programs; i++)
+        if (s->programs[i]->id == program_id)
+            program = s->programs[i];
+    if (!program) {
+        av_log(NULL, AV_LOG_WARNING, "Program %d not found, demuxing all\n",
+               program_id);
+        return;
+    }
+
+    for (unsigned i = 0; i < s->nb_streams; i++)
+        s->streams[i]->discard = AVDISCARD_ALL;
+    for (unsigned i = 0; i < s->nb_programs; i++)
+        s->programs[i]->discard = s->programs[i] == program ? AVDISCARD_DEFAULT
+                                                             : AVDISCARD_ALL;
+    for (unsigned i = 0; i < program->nb_stream_indexes; i++)
+        s->streams[program->stream_index[i]]->discard = AVDISCARD_DEFAULT;
+}
+
+static int bench_once(const struct options *opts, const char *filename,
+                      struct result *r)
+{
+    const AVInputFormat *fmt = NULL;
+    AVFormatContext *s = NULL;
+    AVDictionary *dict = NULL;
+    AVPacket *pkt;
+    int64_t start;
+    int ret;
+
+    if (opts->format && !(fmt = av_find_input_format(opts->format))) {
+        fprintf(stderr, "unknown input format %s\n", opts->format);
+        return AVERROR(EINVAL);
+    }
+
+    pkt = av_packet_alloc();
+    if (!pkt)
+        return AVERROR(ENOMEM);
+
+    ret = av_dict_copy(&dict, opts->opts, 0);
+    if (ret < 0)
+        goto end;
+
+    start = av_gettime_relative();
+    ret = avformat_open_input(&s, filename, fmt, &dict);
+    if (ret < 0) {
+        fprintf(stderr, "%s: could not open input: %s\n", filename, av_err2str(ret));
+        goto end;
+    }
+    if (opts->program >= 0)
+        select_program(s, opts->program);
+    r->open_us = av_gettime_relative() - start;
+
+    r->packets = r->payload = 0;
+    start = av_gettime_relative();
+    while ((ret = av_read_frame(s, pkt)) >= 0) {
+        r->packets++;
+        r->payload += pkt->size;
+        av_packet_unref(pkt);
+    }
+    r->read_us = av_gettime_relative() - start;
+    r->bytes   = avio_tell(s->pb);
+
+    if (ret != AVERROR_EOF)
+        fprintf(stderr, "%s: error reading packets: %s\n", filename, av_err2str(ret));
+    ret = ret == AVERROR_EOF ? 0 : ret;
+
+end:
+    avformat_close_input(&s);
+    av_dict_free(&dict);
+    av_packet_free(&pkt);
+    return ret;
+}
+
+static int bench_file(const struct options *opts, const char *filename)
+{
+    struct result *results, *best, *median;
+    double secs;
+    int ret = 0;
+
+    results = av_calloc(opts->iters, sizeof(*results));
+    if (!results)
+        return AVERROR(ENOMEM);
+
+    for (int i = 0; i < opts->iters; i++) {
+        ret = bench_once(opts, filename, &results[i]);
+        if (ret < 0)
+            goto end;
+    }
+
+    AV_QSORT(results, opts->iters, struct result, cmp_read_time);
+    best   = &results[0];
+    median = &results[opts->iters / 2];
+    secs   = FFMAX(best->read_us, 1) / 1000000.0;
+
+    switch (opts->output) {
+    case OUTPUT_TEXT:
+        printf("%s: %"PRId64" bytes, %"PRId64" packets (%"PRId64" bytes payload)\n"
+               "  open %8.3f ms, read %8.3f ms best, %8.3f ms median\n"
+               "  %8.1f MB/s, %8.1f Mbit/s, %8.0f TS packets/s, %8.0f packets/s\n",
+               filename, best->bytes, best->packets, best->payload,
+               best->open_us / 1000.0, best->read_us / 1000.0,
+               median->read_us / 1000.0,
+               best->bytes / secs / 1000000.0, best->bytes * 8 / secs / 1000000.0,
+               best->bytes / 188 / secs, best->packets / secs);
+        break;
+    case OUTPUT_CSV:
+        printf("%s,%"PRId64",%"PRId64",%"PRId64",%"PRId64",%"PRId64",%"PRId64",%.1f\n",
+               filename, best->bytes, best->packets, best->payload,
+               best->open_us, best->read_us, median->read_us,
+               best->bytes * 8 / secs / 1000000.0);
+        break;
+    }
+
+end:
+    av_free(results);
+    return ret;
+}
+
+static int parse_options(int argc, char **argv, struct options *opts)
+{
+    int ret;
+
+    for (int i = 1; i < argc; i += 2) {
+        if (!strcmp(argv[i], "-help") || !strcmp(argv[i], "--help")) {
+            fprintf(stderr,
+                    "mpegts_bench [options...] <file> [<file>...]\n"
+                    "   -help\n"
+                    "       This text\n"
+                    "   -iters <iters>\n"
+                    "       Number of times each file is demuxed (default: 5)\n"
+                    "   -program <id>\n"
+                    "       Only demux the streams of the given program, discarding the others\n"
+                    "   -f <format>\n"
+                    "       Force the input format (default: probe)\n"
+                    "   -o <key>=<value>\n"
+                    "       Set a demuxer or protocol option, may be repeated\n"
+                    "   -output <text or csv>\n"
+                    "       Output format (default: text)\n"
+                    "   -v <level>\n"
+                    "       Enable log verbosity at given level\n"
+            );
+            exit(0);
+        }
+        if (argv[i][0] != '-') {
+            if (opts->nb_files == MAX_FILES) {
+                fprintf(stderr, "too many input files\n");
+                return AVERROR(EINVAL);
+            }
+            opts->files[opts->nb_files++] = argv[i--];
+            continue;
+        }
+        if (i + 1 == argc)
+            goto bad_option;
+
+        const char *arg = argv[i + 1];
+        if (!strcmp(argv[i], "-iters")) {
+            opts->iters = atoi(arg);
+            ret = opts->iters > 0 ? 0 : AVERROR(EINVAL);
+        } else if (!strcmp(argv[i], "-program")) {
+            opts->program = atoi(arg);
+            ret = opts->program >= 0 ? 0 : AVERROR(EINVAL);
+        } else if (!strcmp(argv[i], "-f")) {
+            opts->format = arg;
+            ret = 0;
+        } else if (!strcmp(argv[i], "-o")) {
+            ret = av_dict_parse_string(&opts->opts, arg, "=", "", 0);
+        } else if (!strcmp(argv[i], "-output")) {
+            ret = 0;
+            if (!strcmp(arg, "text"))
+                opts->output = OUTPUT_TEXT;
+            else if (!strcmp(arg, "csv"))
+                opts->output = OUTPUT_CSV;
+            else
+                ret = AVERROR(EINVAL);
+        } else if (!strcmp(argv[i], "-v")) {
+            av_log_set_level(atoi(arg));
+            ret = 0;
+        } else {
+bad_option:
+            fprintf(stderr, "bad option or argument missing (%s) see -help\n", argv[i]);
+            return AVERROR(EINVAL);
+        }
+
+        if (ret < 0) {
+            fprintf(stderr, "invalid argument for %s: %s\n", argv[i], arg);
+            return ret;
+        }
+    }
+
+    if (!opts->nb_files) {
+        fprintf(stderr, "no input files, see -help\n");
+        return AVERROR(EINVAL);
+    }
+
+    return 0;
+}
+
+int main(int argc, char **argv)
+{
+    struct options opts = {
+        .iters   = 5,
+        .program = -1,
+    };
+    int ret, failed = 0;
+
+    av_log_set_level(AV_LOG_ERROR);
+
+    ret = parse_options(argc, argv, &opts);
+    if (ret < 0) {
+        av_dict_free(&opts.opts);
+        return 1;
+    }
+
+    if (opts.output == OUTPUT_CSV)
+        printf("file,bytes,packets,payload,open_us,read_us,median_read_us,mbps\n");
+
+    for (int i = 0; i < opts.nb_files; i++) {
+        ret = bench_file(&opts, opts.files[i]);
+        if (ret == AVERROR(ENOMEM))
+            break;
+        failed |= ret < 0;
+    }
+
+    av_dict_free(&opts.opts);
+    return failed || ret == AVERROR(ENOMEM);
+}
@@ -26,6 +26,7 @@
 
 #define _DEFAULT_SOURCE
 #define _BSD_SOURCE     /* Needed for using struct ip_mreq with recent glibc */
+#define _GNU_SOURCE     /* Needed for recvmmsg() and sendmmsg() with glibc */
 
 #include "avformat.h"
 #include "libavutil/avassert.h"
@@ -42,6 +43,10 @@
 #include "url.h"
 #include "ip.h"
 
+#if HAVE_SENDMMSG
+#include <netinet/udp.h>
+#endif
+
 #ifdef __APPLE__
 #include "TargetConditionals.h"
 #endif
@@ -78,6 +83,9 @@
 #define UDP_RX_BUF_SIZE 393216
 #define UDP_MAX_PKT_SIZE 65536
 #define UDP_HEADER_SIZE 8
+#define UDP_BATCH_SIZE 16
+#define UDP_GSO_MAX_SEGMENTS 64
+#define UDP_GSO_MAX_SIZE 65507
 
 typedef struct UDPQueuedPacketHeader {
     int pkt_size;
@@ -85,6 +93,9 @@ typedef struct UDPQueuedPacketHeader {
     socklen_t addr_len;
 } UDPQueuedPacketHeader;
 
+/* room for one received datagram with its header, as queued in rx_fifo */
+#define UDP_RX_SLOT_SIZE FFALIGN(sizeof(UDPQueuedPacketHeader) + UDP_MAX_PKT_SIZE, 64)
+
 typedef struct UDPContext {
     const AVClass *class;
     int udp_fd;
@@ -126,6 +137,32 @@ typedef struct UDPContext {
     IPSourceFilters filters;
     struct sockaddr_storage last_recv_addr;
     socklen_t last_recv_addr_len;
+
+    /* Batched receiving and sending */
+    int batch_size;
+    int gso;
+    int rx_batch;
+    uint8_t *rx_buf;
+#if HAVE_RECVMMSG
+    struct mmsghdr *rx_msgs;
+    struct iovec *rx_iov;
+    uint8_t *rx_control;
+#endif
+#if HAVE_SENDMMSG
+    struct mmsghdr *tx_msgs;
+    struct iovec *tx_iov;
+    uint8_t *tx_buf;
+    int tx_buf_size;
+    int tx_batch;
+    int nb_tx;
+    int tx_sent;
+    int tx_len;
+#endif
+    int64_t rx_datagrams, rx_calls;
+    int64_t tx_datagrams, tx_calls;
+    int rx_max_batch, tx_max_batch;
+    int64_t rx_overruns;
+    uint32_t rx_kernel_drops;
 } UDPContext;
 
 #define OFFSET(x) offsetof(UDPContext, x)
@@ -151,6 +188,8 @@ static const AVOption options[] = {
     { "timeout",        "set raise error timeout, in microseconds (only in read mode)",OFFSET(timeout),         AV_OPT_TYPE_INT,  {.i64 = 0}, 0, INT_MAX, D },
     { "sources",        "Source list",                                     OFFSET(sources),        AV_OPT_TYPE_STRING, { .str = NULL },               .flags = D|E },
     { "block",          "Block list",                                      OFFSET(block),          AV_OPT_TYPE_STRING, { .str = NULL },               .flags = D|E },
+    { "batch_size",     "Maximum number of datagrams per system call (-1 = auto)", OFFSET(batch_size), AV_OPT_TYPE_INT, { .i64 = -1 },    -1, 1024,    .flags = D|E },
+    { "gso",            "Use UDP segmentation offload for batched sends",   OFFSET(gso),            AV_OPT_TYPE_BOOL,   { .i64 = 1  },     0, 1,       E },
     { NULL }
 };
 
@@ -416,6 +455,113 @@ static int udp_port(struct sockaddr_storage *addr, int addr_len)
 }
 
 
+#if HAVE_SENDMMSG
+#ifdef UDP_SEGMENT
+/* send datagrams first to first + nb - 1 in one go, letting the kernel or
+ * the network card split the buffer in segments of the first one's size */
+static int udp_send_segmented(UDPContext *s, int first, int nb)
+{
+    union {
+        struct cmsghdr hdr;
+        char buf[CMSG_SPACE(sizeof(uint16_t))];
+    } control = { 0 };
+    struct iovec iov = { .iov_base = s->tx_iov[first].iov_base };
+    struct msghdr msg = { 0 };
+    struct cmsghdr *cmsg;
+    uint16_t segment = s->tx_iov[first].iov_len;
+
+    for (int i = first; i < first + nb; i++)
+        iov.iov_len += s->tx_iov[i].iov_len;
+
+    if (!s->is_connected) {
+        msg.msg_name    = &s->dest_addr;
+        msg.msg_namelen = s->dest_addr_len;
+    }
+    msg.msg_iov        = &iov;
+    msg.msg_iovlen     = 1;
+    msg.msg_control    = control.buf;
+    msg.msg_controllen = sizeof(control.buf);
+
+    cmsg             = CMSG_FIRSTHDR(&msg);
+    cmsg->cmsg_level = IPPROTO_UDP;
+    cmsg->cmsg_type  = UDP_SEGMENT;
+    cmsg->cmsg_len   = CMSG_LEN(sizeof(segment));
+    memcpy(CMSG_DATA(cmsg), &segment, sizeof(segment));
+
+    return sendmsg(s->udp_fd, &msg, 0) < 0 ? ff_neterrno() : 0;
+}
+#endif
+
+/* send the datagrams queued by udp_write() */
+static int udp_flush_batch(URLContext *h)
+{
+    UDPContext *s = h->priv_data;
+    int ret;
+
+    while (s->tx_sent < s->nb_tx) {
+        int nb = s->nb_tx - s->tx_sent;
+
+        if (!(h->flags & AVIO_FLAG_NONBLOCK)) {
+            ret = ff_network_wait_fd(s->udp_fd, 1);
+            if (ret < 0)
+                return ret;
+        }
+
+#ifdef UDP_SEGMENT
+        if (s->gso) {
+            size_t segment = s->tx_iov[s->tx_sent].iov_len, len = 0;
+            int n = 0;
+
+            /* only the last segment may be shorter than the others */
+            while (n < FFMIN(nb, UDP_GSO_MAX_SEGMENTS)) {
+                size_t size = s->tx_iov[s->tx_sent + n].iov_len;
+                if (size > segment || len + size > UDP_GSO_MAX_SIZE)
+                    break;
+                len += size;
+                n++;
+                if (size < segment)
+                    break;
+            }
+            /* with short runs, one sendmmsg() call sends more datagrams */
+            if (n > 1 && 2 * n >= nb) {
+                ret = udp_send_segmented(s, s->tx_sent, n);
+                if (ret >= 0) {
+                    nb = n;
+                    goto sent;
+                }
+                if (ret != AVERROR(EINVAL) && ret != AVERROR(EIO) &&
+                    ret != AVERROR(ENOPROTOOPT) && ret != AVERROR(EOPNOTSUPP))
+                    return ret;
+                av_log(h, AV_LOG_VERBOSE, "UDP segmentation offload not "
+                       "available, sending datagrams separately\n");
+                s->gso = 0;
+            }
+        }
+#endif
+
+        for (int i = s->tx_sent; i < s->nb_tx; i++) {
+            struct msghdr *msg = &s->tx_msgs[i].msg_hdr;
+            msg->msg_name    = s->is_connected ? NULL : &s->dest_addr;
+            msg->msg_namelen = s->is_connected ? 0    : s->dest_addr_len;
+        }
+        ret = sendmmsg(s->udp_fd, s->tx_msgs + s->tx_sent, nb, 0);
+        if (ret < 0)
+            return ff_neterrno();
+        nb = ret;
+#ifdef UDP_SEGMENT
+sent:
+#endif
+        s->tx_sent      += nb;
+        s->tx_datagrams += nb;
+        s->tx_calls++;
+        s->tx_max_batch  = FFMAX(s->tx_max_batch, nb);
+    }
+
+    s->nb_tx = s->tx_sent = s->tx_len = 0;
+    return 0;
+}
+#endif
+
 /**
  * If no filename is given to av_open_input_file because you want to
  * get the local port first, then you must call this function to set
@@ -439,6 +585,14 @@ int ff_udp_set_remote_url(URLContext *h, const char *uri)
     int port;
     const char *p;
 
+#if HAVE_SENDMMSG
+    if (s->nb_tx) {
+        int ret = udp_flush_batch(h);
+        if (ret < 0)
+            return ret;
+    }
+#endif
+
     av_url_split(NULL, 0, NULL, 0, hostname, sizeof(hostname), &port, NULL, 0, uri);
 
     /* set the destination address */
@@ -473,6 +627,14 @@ int ff_udp_set_remote_addr(URLContext *h, const struct sockaddr *dest_addr, sock
 {
     UDPContext *s = h->priv_data;
 
+#if HAVE_SENDMMSG
+    if (s->nb_tx) {
+        int ret = udp_flush_batch(h);
+        if (ret < 0)
+            return ret;
+    }
+#endif
+
     /* set the destination address */
     if ((size_t)dest_addr_len > sizeof(s->dest_addr))
         return AVERROR(EIO);
@@ -526,6 +688,60 @@ static int udp_get_file_handle(URLContext *h)
 }
 
 #if HAVE_PTHREAD_CANCEL
+/**
+ * Receive up to rx_batch datagrams into rx_buf, each one preceded by its
+ * UDPQueuedPacketHeader as it is stored in rx_fifo.
+ *
+ * @return number of datagrams received or AVERROR
+ */
+static int udp_recv_batch(UDPContext *s)
+{
+    UDPQueuedPacketHeader *hdr = (UDPQueuedPacketHeader *)s->rx_buf;
+
+#if HAVE_RECVMMSG
+    if (s->rx_msgs) {
+        int nb;
+
+        for (int i = 0; i < s->rx_batch; i++) {
+            s->rx_msgs[i].msg_hdr.msg_namelen    = sizeof(hdr->addr);
+            s->rx_msgs[i].msg_hdr.msg_controllen = s->rx_msgs[i].msg_hdr.msg_control ?
+                                                   CMSG_SPACE(sizeof(uint32_t)) : 0;
+        }
+        nb = recvmmsg(s->udp_fd, s->rx_msgs, s->rx_batch, MSG_WAITFORONE, NULL);
+        if (nb < 0)
+            return ff_neterrno();
+
+        for (int i = 0; i < nb; i++) {
+            struct msghdr *msg = &s->rx_msgs[i].msg_hdr;
+            hdr = (UDPQueuedPacketHeader *)(s->rx_buf + i * UDP_RX_SLOT_SIZE);
+            hdr->pkt_size = s->rx_msgs[i].msg_len;
+            hdr->addr_len = msg->msg_namelen;
+#ifdef SO_RXQ_OVFL
+            /* the kernel reports the number of datagrams it dropped on this
+             * socket so far */
+            for (struct cmsghdr *cmsg = CMSG_FIRSTHDR(msg); cmsg; cmsg = CMSG_NXTHDR(msg, cmsg))
+                if (cmsg->cmsg_level == SOL_SOCKET && cmsg->cmsg_type == SO_RXQ_OVFL)
+                    memcpy(&s->rx_kernel_drops, CMSG_DATA(cmsg), sizeof(s->rx_kernel_drops));
+#endif
+        }
+        s->rx_datagrams += nb;
+        s->rx_calls++;
+        s->rx_max_batch  = FFMAX(s->rx_max_batch, nb);
+        return nb;
+    }
+#endif
+
+    hdr->addr_len = sizeof(hdr->addr);
+    hdr->pkt_size = recvfrom(s->udp_fd, s->rx_buf + sizeof(*hdr), UDP_MAX_PKT_SIZE, 0,
+                             (struct sockaddr *)&hdr->addr, &hdr->addr_len);
+    if (hdr->pkt_size < 0)
+        return ff_neterrno();
+    s->rx_datagrams++;
+    s->rx_calls++;
+    s->rx_max_batch = 1;
+    return 1;
+}
+
 static void *circular_buffer_task_rx( void *_URLContext)
 {
     URLContext *h = _URLContext;
@@ -542,43 +758,47 @@ static void *circular_buffer_task_rx( void *_URLContext)
         goto end;
     }
     while(1) {
-        UDPQueuedPacketHeader pkt_header;
-        pkt_header.addr_len = sizeof(pkt_header.addr);
+        int nb;
 
         pthread_mutex_unlock(&s->mutex);
         /* Blocking operations are always cancellation points;
            see "General Information" / "Thread Cancellation Overview"
            in Single Unix. */
         pthread_setcancelstate(PTHREAD_CANCEL_ENABLE, &old_cancelstate);
-        pkt_header.pkt_size = recvfrom(s->udp_fd, s->tmp + sizeof(pkt_header), sizeof(s->tmp) - sizeof(pkt_header), 0, (struct sockaddr *)&pkt_header.addr, &pkt_header.addr_len);
+        nb = udp_recv_batch(s);
         pthread_setcancelstate(PTHREAD_CANCEL_DISABLE, &old_cancelstate);
         pthread_mutex_lock(&s->mutex);
-        if (pkt_header.pkt_size < 0) {
-            if (ff_neterrno() != AVERROR(EAGAIN) && ff_neterrno() != AVERROR(EINTR)) {
-                s->circular_buffer_error = ff_neterrno();
+        if (nb < 0) {
+            if (nb != AVERROR(EAGAIN) && nb != AVERROR(EINTR)) {
+                s->circular_buffer_error = nb;
                 goto end;
             }
             continue;
         }
-        if (ff_ip_check_source_lists(&pkt_header.addr, &s->filters))
-            continue;
-        memcpy(s->tmp, &pkt_header, sizeof(pkt_header));
+        for (int i = 0; i < nb; i++) {
+            uint8_t *pkt = s->rx_buf + i * UDP_RX_SLOT_SIZE;
+            UDPQueuedPacketHeader *pkt_header = (UDPQueuedPacketHeader *)pkt;
 
-        if (av_fifo_can_write(s->rx_fifo) < pkt_header.pkt_size + sizeof(pkt_header)) {
-            /* No Space left */
-            if (s->overrun_nonfatal) {
-                av_log(h, AV_LOG_WARNING, "Circular buffer overrun. "
-                        "Surviving due to overrun_nonfatal option\n");
+            if (ff_ip_check_source_lists(&pkt_header->addr, &s->filters))
                 continue;
-            } else {
-                av_log(h, AV_LOG_ERROR, "Circular buffer overrun. "
-                        "To avoid, increase fifo_size URL option. "
-                        "To survive in such case, use overrun_nonfatal option\n");
-                s->circular_buffer_error = AVERROR(EIO);
-                goto end;
+
+            if (av_fifo_can_write(s->rx_fifo) < pkt_header->pkt_size + sizeof(*pkt_header)) {
+                /* No Space left */
+                if (s->overrun_nonfatal) {
+                    av_log(h, AV_LOG_WARNING, "Circular buffer overrun. "
+                            "Surviving due to overrun_nonfatal option\n");
+                    s->rx_overruns++;
+                    continue;
+                } else {
+                    av_log(h, AV_LOG_ERROR, "Circular buffer overrun. "
+                            "To avoid, increase fifo_size URL option. "
+                            "To survive in such case, use overrun_nonfatal option\n");
+                    s->circular_buffer_error = AVERROR(EIO);
+                    goto end;
+                }
             }
+            av_fifo_write(s->rx_fifo, pkt, pkt_header->pkt_size + sizeof(*pkt_header));
         }
-        av_fifo_write(s->rx_fifo, s->tmp, pkt_header.pkt_size + sizeof(pkt_header));
         pthread_cond_signal(&s->cond);
     }
 
@@ -688,6 +908,82 @@ end:
 
 #endif
 
+#if HAVE_RECVMMSG
+static int udp_init_recv_batch(URLContext *h)
+{
+    UDPContext *s = h->priv_data;
+
+    s->rx_msgs = av_calloc(s->rx_batch, sizeof(*s->rx_msgs));
+    s->rx_iov  = av_calloc(s->rx_batch, sizeof(*s->rx_iov));
+    if (!s->rx_msgs || !s->rx_iov)
+        return AVERROR(ENOMEM);
+
+#ifdef SO_RXQ_OVFL
+    {
+        int enable = 1;
+        if (!setsockopt(s->udp_fd, SOL_SOCKET, SO_RXQ_OVFL, &enable, sizeof(enable))) {
+            s->rx_control = av_calloc(s->rx_batch, CMSG_SPACE(sizeof(uint32_t)));
+            if (!s->rx_control)
+                return AVERROR(ENOMEM);
+        }
+    }
+#endif
+
+    for (int i = 0; i < s->rx_batch; i++) {
+        UDPQueuedPacketHeader *hdr = (UDPQueuedPacketHeader *)(s->rx_buf + i * UDP_RX_SLOT_SIZE);
+        struct msghdr *msg = &s->rx_msgs[i].msg_hdr;
+
+        s->rx_iov[i].iov_base = hdr + 1;
+        s->rx_iov[i].iov_len  = UDP_MAX_PKT_SIZE;
+        msg->msg_name    = &hdr->addr;
+        msg->msg_iov     = &s->rx_iov[i];
+        msg->msg_iovlen  = 1;
+        if (s->rx_control)
+            msg->msg_control = s->rx_control + i * CMSG_SPACE(sizeof(uint32_t));
+    }
+    return 0;
+}
+#endif
+
+#if HAVE_SENDMMSG
+static int udp_init_send_batch(URLContext *h, int batch)
+{
+    UDPContext *s = h->priv_data;
+
+    s->tx_batch    = batch;
+    s->tx_buf_size = batch * FFMIN(s->pkt_size, UDP_MAX_PKT_SIZE);
+    s->tx_msgs     = av_calloc(batch, sizeof(*s->tx_msgs));
+    s->tx_iov      = av_calloc(batch, sizeof(*s->tx_iov));
+    s->tx_buf      = av_malloc(s->tx_buf_size);
+    if (!s->tx_msgs || !s->tx_iov || !s->tx_buf)
+        return AVERROR(ENOMEM);
+
+    for (int i = 0; i < batch; i++) {
+        s->tx_msgs[i].msg_hdr.msg_iov    = &s->tx_iov[i];
+        s->tx_msgs[i].msg_hdr.msg_iovlen = 1;
+    }
+    /* segmentation offload is not supported for UDP-Lite */
+    if (s->udplite_coverage)
+        s->gso = 0;
+    return 0;
+}
+#endif
+
+static void udp_free_batch(UDPContext *s)
+{
+    av_freep(&s->rx_buf);
+#if HAVE_RECVMMSG
+    av_freep(&s->rx_msgs);
+    av_freep(&s->rx_iov);
+    av_freep(&s->rx_control);
+#endif
+#if HAVE_SENDMMSG
+    av_freep(&s->tx_msgs);
+    av_freep(&s->tx_iov);
+    av_freep(&s->tx_buf);
+#endif
+}
+
 /* put it in UDP context */
 /* return non zero if error */
 static int udp_open(URLContext *h, const char *uri, int flags)
@@ -903,6 +1199,14 @@ static int udp_open(URLContext *h, const char *uri, int flags)
 
     s->udp_fd = udp_fd;
 
+#if HAVE_SENDMMSG
+    /* Sending is only batched on request, as datagrams are held back until
+     * a batch is complete. */
+    if ((flags & AVIO_FLAG_WRITE) && s->batch_size > 1 &&
+        (ret = udp_init_send_batch(h, s->batch_size)) < 0)
+        goto fail;
+#endif
+
 #if HAVE_PTHREAD_CANCEL
     /*
       Create thread in case of:
@@ -926,6 +1230,20 @@ static int udp_open(URLContext *h, const char *uri, int flags)
             s->tx_fifo = fifo;
         else
             s->rx_fifo = fifo;
+        if (!is_output) {
+            s->rx_batch = s->batch_size < 0 ? UDP_BATCH_SIZE : FFMAX(s->batch_size, 1);
+            if (!HAVE_RECVMMSG)
+                s->rx_batch = 1;
+            s->rx_buf = av_malloc(s->rx_batch * UDP_RX_SLOT_SIZE);
+            if (!s->rx_buf) {
+                ret = AVERROR(ENOMEM);
+                goto fail;
+            }
+#if HAVE_RECVMMSG
+            if (s->rx_batch > 1 && (ret = udp_init_recv_batch(h)) < 0)
+                goto fail;
+#endif
+        }
         ret = pthread_mutex_init(&s->mutex, NULL);
         if (ret != 0) {
             av_log(h, AV_LOG_ERROR, "pthread_mutex_init failed : %s\n", strerror(ret));
@@ -961,6 +1279,7 @@ static int udp_open(URLContext *h, const char *uri, int flags)
     av_fifo_freep2(&s->rx_fifo);
     av_fifo_freep2(&s->tx_fifo);
     ff_ip_reset_filters(&s->filters);
+    udp_free_batch(s);
     return ret;
 }
 
@@ -1074,6 +1393,28 @@ static int udp_write(URLContext *h, const uint8_t *buf, int size)
         pthread_mutex_unlock(&s->mutex);
         return size;
     }
+#endif
+#if HAVE_SENDMMSG
+    if (s->tx_msgs) {
+        if (s->nb_tx == s->tx_batch || size > s->tx_buf_size - s->tx_len) {
+            ret = udp_flush_batch(h);
+            if (ret < 0)
+                return ret;
+        }
+        if (size <= s->tx_buf_size) {
+            memcpy(s->tx_buf + s->tx_len, buf, size);
+            s->tx_iov[s->nb_tx].iov_base = s->tx_buf + s->tx_len;
+            s->tx_iov[s->nb_tx].iov_len  = size;
+            s->tx_len += size;
+            s->nb_tx++;
+            if (s->nb_tx == s->tx_batch) {
+                ret = udp_flush_batch(h);
+                if (ret < 0 && ret != AVERROR(EAGAIN))
+                    return ret;
+            }
+            return size;
+        }
+    }
 #endif
     if (!(h->flags & AVIO_FLAG_NONBLOCK)) {
         ret = ff_network_wait_fd(s->udp_fd, 1);
@@ -1095,6 +1436,15 @@ static int udp_close(URLContext *h)
 {
     UDPContext *s = h->priv_data;
 
+#if HAVE_SENDMMSG
+    if (s->nb_tx) {
+        int ret = udp_flush_batch(h);
+        if (ret < 0)
+            av_log(h, AV_LOG_ERROR, "Failed to send %d queued datagrams: %s\n",
+                   s->nb_tx - s->tx_sent, av_err2str(ret));
+    }
+#endif
+
 #if HAVE_PTHREAD_CANCEL
     // Request close once writing is finished
     if (s->thread_started && !(h->flags & AVIO_FLAG_READ)) {
@@ -1130,10 +1480,22 @@ static int udp_close(URLContext *h)
         pthread_cond_destroy(&s->cond);
     }
 #endif
+    if (s->rx_calls)
+        av_log(h, AV_LOG_VERBOSE, "Statistics: %"PRId64" datagrams received in "
+               "%"PRId64" calls (at most %d per call), %"PRId64" dropped on "
+               "fifo overrun, %"PRIu32" dropped by the system\n",
+               s->rx_datagrams, s->rx_calls, s->rx_max_batch,
+               s->rx_overruns, s->rx_kernel_drops);
+    if (s->tx_calls)
+        av_log(h, AV_LOG_VERBOSE, "Statistics: %"PRId64" datagrams sent in "
+               "%"PRId64" calls (at most %d per call)\n",
+               s->tx_datagrams, s->tx_calls, s->tx_max_batch);
+
     closesocket(s->udp_fd);
     av_fifo_freep2(&s->rx_fifo);
     av_fifo_freep2(&s->tx_fifo);
     ff_ip_reset_filters(&s->filters);
+    udp_free_batch(s);
     return 0;
 }
 
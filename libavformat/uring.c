@@ -0,0 +1,424 @@
+/*
+ * io_uring based read-ahead
+ *
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#define _DEFAULT_SOURCE
+
+#include <errno.h>
+#include <poll.h>
+#include <stdatomic.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#include <linux/io_uring.h>
+
+#include "config.h"
+#include "libavutil/error.h"
+#include "libavutil/macros.h"
+#include "libavutil/mem.h"
+#include "uring.h"
+
+/**
+ * For regular files, every buffer is refilled as soon as it has been
+ * consumed, at the file offset following the last queued read. Sockets have
+ * no offsets, so the buffers are queued together as one linked chain of
+ * poll + recv pairs, which the kernel executes in order; the chain is only
+ * requeued once all of its buffers have been consumed.
+ */
+
+enum SlotState {
+    SLOT_FREE,
+    SLOT_PENDING,
+    SLOT_DONE,
+};
+
+typedef struct URingSlot {
+    uint8_t *data;
+    int64_t offset;     ///< file offset the read was queued at
+    enum SlotState state;
+    int res;            ///< bytes read or negative errno
+    int consumed;
+} URingSlot;
+
+/* Set in the user_data of poll requests preceding socket reads */
+#define POLL_TAG (UINT64_C(1) << 32)
+
+struct FFURing {
+    int ring_fd;
+    int fd;
+    int stream;
+
+    unsigned *sq_tail, *sq_mask, *sq_array;
+    unsigned *cq_head, *cq_tail, *cq_mask;
+    struct io_uring_sqe *sqes;
+    struct io_uring_cqe *cqes;
+    void *sq_ring, *cq_ring;
+    size_t sq_ring_size, cq_ring_size, sqes_size;
+    unsigned to_submit;     ///< queued requests not yet passed to the kernel
+    unsigned in_flight;     ///< queued requests not yet completed
+
+    uint8_t *buf;
+    int fixed;              ///< buffers are registered with the ring
+    URingSlot *slots;
+    int nb_slots;
+    int buf_size;
+    int head;               ///< first slot to consume
+    int queued;             ///< slots in use, starting at head
+    int64_t pos;            ///< position of the next byte to return
+    int64_t next_offset;    ///< file offset of the next read to queue
+};
+
+static int ring_enter(FFURing *r, int wait)
+{
+    int ret;
+
+    do {
+        ret = syscall(__NR_io_uring_enter, r->ring_fd, r->to_submit, wait,
+                      wait ? IORING_ENTER_GETEVENTS : 0, NULL, 0);
+    } while (ret < 0 && errno == EINTR);
+    if (ret < 0)
+        return AVERROR(errno);
+
+    r->to_submit -= ret;
+    return 0;
+}
+
+/* The ring holds two requests per slot, so it can never overflow */
+static struct io_uring_sqe *get_sqe(FFURing *r, uint64_t user_data)
+{
+    const unsigned tail = *r->sq_tail;
+    const unsigned idx  = tail & *r->sq_mask;
+    struct io_uring_sqe *sqe = &r->sqes[idx];
+
+    memset(sqe, 0, sizeof(*sqe));
+    sqe->user_data = user_data;
+    r->sq_array[idx] = idx;
+    atomic_store_explicit((atomic_uint *) r->sq_tail, tail + 1,
+                          memory_order_release);
+    r->to_submit++;
+    r->in_flight++;
+    return sqe;
+}
+
+static void queue_slot(FFURing *r, int idx, int last)
+{
+    URingSlot *s = &r->slots[idx];
+    struct io_uring_sqe *sqe;
+
+    if (r->stream) {
+        uint32_t events = POLLIN;
+#if HAVE_BIGENDIAN
+        events = events << 16 | events >> 16;
+#endif
+        sqe = get_sqe(r, POLL_TAG | idx);
+        sqe->opcode        = IORING_OP_POLL_ADD;
+        sqe->fd            = r->fd;
+        sqe->poll32_events = events;
+        sqe->flags         = IOSQE_IO_LINK;
+
+        sqe = get_sqe(r, idx);
+        sqe->opcode = IORING_OP_RECV;
+        sqe->flags  = last ? 0 : IOSQE_IO_LINK;
+    } else {
+        sqe = get_sqe(r, idx);
+        sqe->opcode    = r->fixed ? IORING_OP_READ_FIXED : IORING_OP_READ;
+        sqe->off       = r->next_offset;
+        sqe->buf_index = idx;
+        s->offset = r->next_offset;
+        r->next_offset += r->buf_size;
+    }
+    sqe->fd   = r->fd;
+    sqe->addr = (uintptr_t) s->data;
+    sqe->len  = r->buf_size;
+
+    s->state    = SLOT_PENDING;
+    s->res      = 0;
+    s->consumed = 0;
+}
+
+static int queue_reads(FFURing *r)
+{
+    if (r->stream) {
+        if (r->queued)
+            return 0;
+        for (int i = 0; i < r->nb_slots; i++)
+            queue_slot(r, (r->head + i) % r->nb_slots, i == r->nb_slots - 1);
+        r->queued = r->nb_slots;
+    } else {
+        while (r->queued < r->nb_slots) {
+            queue_slot(r, (r->head + r->queued) % r->nb_slots, 0);
+            r->queued++;
+        }
+    }
+
+    /* Batch submissions of refilled file buffers */
+    if (r->to_submit >= (r->nb_slots + 1) / 2)
+        return ring_enter(r, 0);
+    return 0;
+}
+
+static void reap(FFURing *r)
+{
+    unsigned head = *r->cq_head;
+    const unsigned tail = atomic_load_explicit((atomic_uint *) r->cq_tail,
+                                               memory_order_acquire);
+
+    for (; head != tail; head++) {
+        const struct io_uring_cqe *cqe = &r->cqes[head & *r->cq_mask];
+        r->in_flight--;
+        if (cqe->user_data & POLL_TAG)
+            continue;
+        r->slots[cqe->user_data].res   = cqe->res;
+        r->slots[cqe->user_data].state = SLOT_DONE;
+    }
+
+    atomic_store_explicit((atomic_uint *) r->cq_head, head,
+                          memory_order_release);
+}
+
+static void release_slot(FFURing *r)
+{
+    r->slots[r->head].state = SLOT_FREE;
+    r->head = (r->head + 1) % r->nb_slots;
+    r->queued--;
+}
+
+/* Wait for all requests and drop all queued data */
+static int drain(FFURing *r)
+{
+    while (r->in_flight) {
+        int ret = ring_enter(r, 1);
+        if (ret < 0)
+            return ret;
+        reap(r);
+    }
+
+    for (int i = 0; i < r->nb_slots; i++)
+        r->slots[i].state = SLOT_FREE;
+    r->head = r->queued = 0;
+    return 0;
+}
+
+int ff_uring_read(FFURing *r, uint8_t *buf, int size, int nonblock)
+{
+    URingSlot *s;
+    int ret, len;
+
+    for (;;) {
+        if ((ret = queue_reads(r)) < 0)
+            return ret;
+
+        reap(r);
+        s = &r->slots[r->head];
+        if (s->state != SLOT_DONE) {
+            if (nonblock && !r->to_submit)
+                return AVERROR(EAGAIN);
+            if ((ret = ring_enter(r, !nonblock)) < 0)
+                return ret;
+            continue;
+        }
+
+        /* A socket read failed spuriously or was cancelled along with
+         * the rest of its chain; it holds no data. */
+        if (r->stream && (s->res == -EAGAIN || s->res == -ECANCELED)) {
+            release_slot(r);
+            continue;
+        }
+        break;
+    }
+
+    if (s->res < 0)
+        return AVERROR(-s->res);
+    if (!s->res)
+        return AVERROR_EOF;
+
+    len = FFMIN(size, s->res - s->consumed);
+    memcpy(buf, s->data + s->consumed, len);
+    s->consumed += len;
+    r->pos      += len;
+
+    if (s->consumed == s->res) {
+        /* Reads queued after a short one start at the wrong offset */
+        const int restart = !r->stream && s->res < r->buf_size;
+        release_slot(r);
+        if (restart && (ret = ff_uring_seek(r, r->pos)) < 0)
+            return ret;
+    }
+
+    return len;
+}
+
+int ff_uring_seek(FFURing *r, int64_t pos)
+{
+    URingSlot *s = &r->slots[r->head];
+    int ret;
+
+    if (r->stream)
+        return AVERROR(ENOSYS);
+
+    if (r->queued && s->state == SLOT_DONE && s->res > 0 &&
+        pos >= s->offset && pos < s->offset + s->res) {
+        s->consumed = pos - s->offset;
+        r->pos = pos;
+        return 0;
+    }
+
+    if ((ret = drain(r)) < 0)
+        return ret;
+    r->pos = r->next_offset = pos;
+    return 0;
+}
+
+int64_t ff_uring_tell(const FFURing *r)
+{
+    return r->pos;
+}
+
+int ff_uring_get_fd(const FFURing *r)
+{
+    return r->ring_fd;
+}
+
+void ff_uring_free(FFURing **pr)
+{
+    FFURing *r = *pr;
+
+    if (!r)
+        return;
+
+    if (r->in_flight && r->stream) {
+        /* Pending socket reads may never complete on their own */
+        for (int i = 0; i < r->nb_slots; i++) {
+            struct io_uring_sqe *sqe;
+            if (r->slots[i].state != SLOT_PENDING)
+                continue;
+            sqe = get_sqe(r, POLL_TAG | r->nb_slots);
+            sqe->opcode = IORING_OP_ASYNC_CANCEL;
+            sqe->addr   = POLL_TAG | i;
+            sqe = get_sqe(r, POLL_TAG | r->nb_slots);
+            sqe->opcode = IORING_OP_ASYNC_CANCEL;
+            sqe->addr   = i;
+        }
+    }
+    if (r->ring_fd >= 0)
+        drain(r);
+
+    if (r->sqes)
+        munmap(r->sqes, r->sqes_size);
+    if (r->cq_ring && r->cq_ring != r->sq_ring)
+        munmap(r->cq_ring, r->cq_ring_size);
+    if (r->sq_ring)
+        munmap(r->sq_ring, r->sq_ring_size);
+    if (r->ring_fd >= 0)
+        close(r->ring_fd);
+    av_freep(&r->buf);
+    av_freep(&r->slots);
+    av_freep(pr);
+}
+
+static void *map_ring(FFURing *r, size_t size, off_t offset)
+{
+    void *ptr = mmap(NULL, size, PROT_READ | PROT_WRITE,
+                     MAP_SHARED | MAP_POPULATE, r->ring_fd, offset);
+    return ptr == MAP_FAILED ? NULL : ptr;
+}
+
+int ff_uring_alloc(FFURing **pr, int fd, int stream, int64_t pos,
+                   int nb_bufs, int buf_size)
+{
+    struct io_uring_params p = { 0 };
+    struct iovec *iov;
+    uint8_t *sq, *cq;
+    FFURing *r;
+    int ret;
+
+    r = av_mallocz(sizeof(*r));
+    if (!r)
+        return AVERROR(ENOMEM);
+    r->ring_fd  = -1;
+    r->fd       = fd;
+    r->stream   = stream;
+    r->nb_slots = nb_bufs;
+    r->buf_size = buf_size;
+    r->pos = r->next_offset = pos;
+
+    r->slots = av_calloc(nb_bufs, sizeof(*r->slots));
+    r->buf   = av_malloc_array(nb_bufs, buf_size);
+    if (!r->slots || !r->buf) {
+        ret = AVERROR(ENOMEM);
+        goto fail;
+    }
+    for (int i = 0; i < nb_bufs; i++)
+        r->slots[i].data = r->buf + (size_t) i * buf_size;
+
+    r->ring_fd = syscall(__NR_io_uring_setup, 2 * nb_bufs, &p);
+    if (r->ring_fd < 0) {
+        ret = AVERROR(errno);
+        goto fail;
+    }
+
+    r->sq_ring_size = p.sq_off.array + p.sq_entries * sizeof(unsigned);
+    r->cq_ring_size = p.cq_off.cqes  + p.cq_entries * sizeof(struct io_uring_cqe);
+    if (p.features & IORING_FEAT_SINGLE_MMAP)
+        r->sq_ring_size = r->cq_ring_size = FFMAX(r->sq_ring_size, r->cq_ring_size);
+    r->sqes_size = p.sq_entries * sizeof(struct io_uring_sqe);
+
+    r->sq_ring = map_ring(r, r->sq_ring_size, IORING_OFF_SQ_RING);
+    if (p.features & IORING_FEAT_SINGLE_MMAP)
+        r->cq_ring = r->sq_ring;
+    else
+        r->cq_ring = map_ring(r, r->cq_ring_size, IORING_OFF_CQ_RING);
+    r->sqes = map_ring(r, r->sqes_size, IORING_OFF_SQES);
+    if (!r->sq_ring || !r->cq_ring || !r->sqes) {
+        ret = AVERROR(errno);
+        goto fail;
+    }
+
+    sq = r->sq_ring;
+    cq = r->cq_ring;
+    r->sq_tail  = (unsigned *)(sq + p.sq_off.tail);
+    r->sq_mask  = (unsigned *)(sq + p.sq_off.ring_mask);
+    r->sq_array = (unsigned *)(sq + p.sq_off.array);
+    r->cq_head  = (unsigned *)(cq + p.cq_off.head);
+    r->cq_tail  = (unsigned *)(cq + p.cq_off.tail);
+    r->cq_mask  = (unsigned *)(cq + p.cq_off.ring_mask);
+    r->cqes     = (struct io_uring_cqe *)(cq + p.cq_off.cqes);
+
+    /* Registering the buffers saves mapping them on every read, but may
+     * fail due to memory locking limits; plain reads work regardless. */
+    iov = av_calloc(nb_bufs, sizeof(*iov));
+    if (iov) {
+        for (int i = 0; i < nb_bufs; i++) {
+            iov[i].iov_base = r->slots[i].data;
+            iov[i].iov_len  = buf_size;
+        }
+        r->fixed = syscall(__NR_io_uring_register, r->ring_fd,
+                           IORING_REGISTER_BUFFERS, iov, nb_bufs) >= 0;
+        av_free(iov);
+    }
+
+    *pr = r;
+    return 0;
+
+fail:
+    ff_uring_free(&r);
+    return ret;
+}
@@ -0,0 +1,73 @@
+/*
+ * io_uring based read-ahead
+ *
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#ifndef AVFORMAT_URING_H
+#define AVFORMAT_URING_H
+
+#include <stdint.h>
+
+/**
+ * A queue of reads kept in flight on a file descriptor through an io_uring
+ * instance. Data is returned strictly in order; the buffers the kernel reads
+ * into are registered with the ring when possible.
+ */
+typedef struct FFURing FFURing;
+
+/**
+ * Create a read-ahead queue for fd.
+ *
+ * @param stream  0 if fd is a regular file, read at explicit offsets
+ *                starting at pos; 1 if fd is a socket, read in order as
+ *                data arrives
+ * @param nb_bufs number of reads to keep in flight
+ * @param buf_size size of each read
+ * @return 0 on success, AVERROR(ENOSYS) if io_uring is not available
+ */
+int ff_uring_alloc(FFURing **pr, int fd, int stream, int64_t pos,
+                   int nb_bufs, int buf_size);
+
+void ff_uring_free(FFURing **pr);
+
+/**
+ * Read up to size bytes.
+ *
+ * @param nonblock if set, return AVERROR(EAGAIN) instead of waiting for the
+ *                 next read to complete
+ * @return number of bytes read, AVERROR_EOF or another AVERROR
+ */
+int ff_uring_read(FFURing *r, uint8_t *buf, int size, int nonblock);
+
+/**
+ * Discard all queued data and continue reading a regular file at pos.
+ */
+int ff_uring_seek(FFURing *r, int64_t pos);
+
+/**
+ * @return the position of the next byte ff_uring_read() would return
+ */
+int64_t ff_uring_tell(const FFURing *r);
+
+/**
+ * @return a file descriptor that polls readable whenever a queued read has
+ *         completed
+ */
+int ff_uring_get_fd(const FFURing *r);
+
+#endif /* AVFORMAT_URING_H */
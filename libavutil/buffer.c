@@ -24,6 +24,7 @@
 #include "buffer_internal.h"
 #include "common.h"
 #include "mem.h"
+#include "object_cache_internal.h"
 #include "thread.h"
 
 static AVBufferRef *buffer_create(AVBuffer *buf, uint8_t *data, size_t size,
@@ -41,7 +42,7 @@ static AVBufferRef *buffer_create(AVBuffer *buf, uint8_t *data, size_t size,
 
     buf->flags = flags;
 
-    ref = av_mallocz(sizeof(*ref));
+    ref = avpriv_object_cache_alloc(AV_OBJECT_CACHE_BUFFER_REF, sizeof(*ref));
     if (!ref)
         return NULL;
 
@@ -102,7 +103,7 @@ AVBufferRef *av_buffer_allocz(size_t size)
 
 AVBufferRef *av_buffer_ref(const AVBufferRef *buf)
 {
-    AVBufferRef *ret = av_mallocz(sizeof(*ret));
+    AVBufferRef *ret = avpriv_object_cache_alloc(AV_OBJECT_CACHE_BUFFER_REF, sizeof(*ret));
 
     if (!ret)
         return NULL;
@@ -122,9 +123,12 @@ static void buffer_replace(AVBufferRef **dst, AVBufferRef **src)
 
     if (src) {
         **dst = **src;
-        av_freep(src);
-    } else
-        av_freep(dst);
+        avpriv_object_cache_free(AV_OBJECT_CACHE_BUFFER_REF, *src);
+        *src = NULL;
+    } else {
+        avpriv_object_cache_free(AV_OBJECT_CACHE_BUFFER_REF, *dst);
+        *dst = NULL;
+    }
 
     if (atomic_fetch_sub_explicit(&b->refcount, 1, memory_order_acq_rel) == 1) {
         /* b->free below might already free the structure containing *b,
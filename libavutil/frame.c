@@ -23,6 +23,7 @@
 #include "frame.h"
 #include "imgutils.h"
 #include "mem.h"
+#include "object_cache_internal.h"
 #include "refstruct.h"
 #include "samplefmt.h"
 #include "side_data.h"
@@ -51,7 +52,7 @@ static void get_frame_defaults(AVFrame *frame)
 
 AVFrame *av_frame_alloc(void)
 {
-    AVFrame *frame = av_malloc(sizeof(*frame));
+    AVFrame *frame = avpriv_object_cache_alloc(AV_OBJECT_CACHE_FRAME, sizeof(*frame));
 
     if (!frame)
         return NULL;
@@ -67,7 +68,8 @@ void av_frame_free(AVFrame **frame)
         return;
 
     av_frame_unref(*frame);
-    av_freep(frame);
+    avpriv_object_cache_free(AV_OBJECT_CACHE_FRAME, *frame);
+    *frame = NULL;
 }
 
 #define ALIGN (HAVE_SIMD_ALIGN_64 ? 64 : 32)
@@ -0,0 +1,165 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include "config.h"
+
+#include <stdatomic.h>
+#include <stdint.h>
+
+#include "error.h"
+#include "mem.h"
+#include "object_cache.h"
+#include "object_cache_internal.h"
+#include "thread.h"
+
+// maximum number of cached objects of each type per thread
+#define CACHE_SIZE 64
+
+typedef struct ObjectList {
+    void               *obj[CACHE_SIZE];
+    int              nb_obj;
+
+    AVObjectCacheStats  stats;
+} ObjectList;
+
+typedef struct ThreadCache {
+    ObjectList          lists[AV_OBJECT_CACHE_NB];
+} ThreadCache;
+
+static atomic_int cache_enabled = 0;
+
+// statistics of the threads that have exited
+static atomic_uint_least64_t stats_exited[AV_OBJECT_CACHE_NB][4];
+
+#if HAVE_PTHREADS
+static AVOnce        cache_key_once = AV_ONCE_INIT;
+static pthread_key_t cache_key;
+static int           cache_key_valid;
+
+static void cache_free(void *arg)
+{
+    ThreadCache *c = arg;
+
+    for (int i = 0; i < AV_OBJECT_CACHE_NB; i++) {
+        ObjectList *l = &c->lists[i];
+
+        for (int j = 0; j < l->nb_obj; j++)
+            av_free(l->obj[j]);
+
+        atomic_fetch_add_explicit(&stats_exited[i][0], l->stats.hits,    memory_order_relaxed);
+        atomic_fetch_add_explicit(&stats_exited[i][1], l->stats.misses,  memory_order_relaxed);
+        atomic_fetch_add_explicit(&stats_exited[i][2], l->stats.cached,  memory_order_relaxed);
+        atomic_fetch_add_explicit(&stats_exited[i][3], l->stats.evicted, memory_order_relaxed);
+    }
+
+    av_free(c);
+}
+
+static void cache_key_init(void)
+{
+    cache_key_valid = !pthread_key_create(&cache_key, cache_free);
+}
+
+static ThreadCache *cache_get(int create)
+{
+    ThreadCache *c;
+
+    ff_thread_once(&cache_key_once, cache_key_init);
+    if (!cache_key_valid)
+        return NULL;
+
+    c = pthread_getspecific(cache_key);
+    if (!c && create) {
+        c = av_mallocz(sizeof(*c));
+        if (c && pthread_setspecific(cache_key, c))
+            av_freep(&c);
+    }
+
+    return c;
+}
+#else
+static ThreadCache *cache_get(int create)
+{
+    return NULL;
+}
+#endif
+
+void av_object_cache_enable(int enable)
+{
+    atomic_store_explicit(&cache_enabled, !!enable, memory_order_relaxed);
+}
+
+int av_object_cache_get_stats(enum AVObjectCacheType type, AVObjectCacheStats *stats)
+{
+    ThreadCache *c;
+
+    if ((unsigned)type >= AV_OBJECT_CACHE_NB)
+        return AVERROR(EINVAL);
+
+    c = cache_get(0);
+    *stats = c ? c->lists[type].stats : (AVObjectCacheStats){ 0 };
+
+    stats->hits    += atomic_load_explicit(&stats_exited[type][0], memory_order_relaxed);
+    stats->misses  += atomic_load_explicit(&stats_exited[type][1], memory_order_relaxed);
+    stats->cached  += atomic_load_explicit(&stats_exited[type][2], memory_order_relaxed);
+    stats->evicted += atomic_load_explicit(&stats_exited[type][3], memory_order_relaxed);
+
+    return 0;
+}
+
+void *avpriv_object_cache_alloc(enum AVObjectCacheType type, size_t size)
+{
+    if (atomic_load_explicit(&cache_enabled, memory_order_relaxed)) {
+        ThreadCache *c = cache_get(1);
+
+        if (c) {
+            ObjectList *l = &c->lists[type];
+
+            if (l->nb_obj) {
+                l->stats.hits++;
+                return l->obj[--l->nb_obj];
+            }
+            l->stats.misses++;
+        }
+    }
+
+    return av_malloc(size);
+}
+
+void avpriv_object_cache_free(enum AVObjectCacheType type, void *obj)
+{
+    if (!obj)
+        return;
+
+    if (atomic_load_explicit(&cache_enabled, memory_order_relaxed)) {
+        ThreadCache *c = cache_get(1);
+
+        if (c) {
+            ObjectList *l = &c->lists[type];
+
+            if (l->nb_obj < CACHE_SIZE) {
+                l->obj[l->nb_obj++] = obj;
+                l->stats.cached++;
+                return;
+            }
+            l->stats.evicted++;
+        }
+    }
+
+    av_free(obj);
+}
@@ -0,0 +1,84 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#ifndef AVUTIL_OBJECT_CACHE_H
+#define AVUTIL_OBJECT_CACHE_H
+
+#include <stdint.h>
+
+/**
+ * @file
+ * Per-thread caching of frequently allocated structures.
+ *
+ * When enabled, freed AVFrame, AVPacket and AVBufferRef structures are kept
+ * in small per-thread free lists instead of being returned to the allocator,
+ * and are reused by subsequent allocations on the same thread. This only
+ * affects the structures themselves, not the data they reference.
+ *
+ * Caching is only available on platforms with POSIX threads; elsewhere
+ * enabling it has no effect.
+ */
+
+enum AVObjectCacheType {
+    AV_OBJECT_CACHE_FRAME,      ///< AVFrame, av_frame_alloc()/av_frame_free()
+    AV_OBJECT_CACHE_PACKET,     ///< AVPacket, av_packet_alloc()/av_packet_free()
+    AV_OBJECT_CACHE_BUFFER_REF, ///< AVBufferRef
+    AV_OBJECT_CACHE_NB,         ///< Not part of ABI
+};
+
+typedef struct AVObjectCacheStats {
+    /**
+     * Number of allocations served from the cache.
+     */
+    uint64_t hits;
+    /**
+     * Number of allocations that had to go to the allocator.
+     */
+    uint64_t misses;
+    /**
+     * Number of freed objects that were put into the cache.
+     */
+    uint64_t cached;
+    /**
+     * Number of freed objects that were returned to the allocator because
+     * the cache was full.
+     */
+    uint64_t evicted;
+} AVObjectCacheStats;
+
+/**
+ * Enable or disable the object caches for all threads. Disabled by default.
+ *
+ * Objects that are already cached when caching is disabled stay in the cache
+ * until the thread owning it exits.
+ */
+void av_object_cache_enable(int enable);
+
+/**
+ * Get the statistics for one object type.
+ *
+ * The returned counters are the sum over all the threads that have already
+ * exited and the calling thread.
+ *
+ * @param type  the object type
+ * @param stats the statistics are written here
+ * @return 0 on success, a negative AVERROR code on failure
+ */
+int av_object_cache_get_stats(enum AVObjectCacheType type, AVObjectCacheStats *stats);
+
+#endif /* AVUTIL_OBJECT_CACHE_H */
@@ -0,0 +1,41 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#ifndef AVUTIL_OBJECT_CACHE_INTERNAL_H
+#define AVUTIL_OBJECT_CACHE_INTERNAL_H
+
+#include <stddef.h>
+
+#include "object_cache.h"
+
+/**
+ * Allocate an object of the given type, from the calling thread's cache if
+ * possible. Like av_malloc(), the returned memory is not initialized.
+ *
+ * @param size size of the object, must be the same for all calls with the
+ *             same type
+ */
+void *avpriv_object_cache_alloc(enum AVObjectCacheType type, size_t size);
+
+/**
+ * Free an object previously allocated with avpriv_object_cache_alloc() or
+ * av_malloc(), or put it into the calling thread's cache.
+ */
+void avpriv_object_cache_free(enum AVObjectCacheType type, void *obj);
+
+#endif /* AVUTIL_OBJECT_CACHE_INTERNAL_H */
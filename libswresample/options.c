@@ -86,6 +86,10 @@ static const AVOption options[]={
 {"linear_interp"        , "enable linear interpolation" , OFFSET(linear_interp)  , AV_OPT_TYPE_BOOL , {.i64=1                     }, 0      , 1         , PARAM },
 {"exact_rational"       , "enable exact rational"       , OFFSET(exact_rational) , AV_OPT_TYPE_BOOL , {.i64=1                     }, 0      , 1         , PARAM },
 {"cutoff"               , "set cutoff frequency ratio"  , OFFSET(cutoff)         , AV_OPT_TYPE_DOUBLE,{.dbl=0.                    }, 0      , 1         , PARAM },
+{"max_delay"            , "set maximum swr resampling delay in input samples, using a minimum phase filter"
+                                                        , OFFSET(max_delay)      , AV_OPT_TYPE_INT  , {.i64=0                     }, 0      , INT_MAX   , PARAM },
+{"threads"              , "set number of threads to resample channels with", OFFSET(threads), AV_OPT_TYPE_INT, {.i64=1                     }, 0      , INT_MAX   , PARAM, .unit = "threads"},
+{"auto"                 , "automatic selection"         , 0                      , AV_OPT_TYPE_CONST, {.i64=0                     }, INT_MIN, INT_MAX   , PARAM, .unit = "threads"},
 
 /* duplicate option in order to work with avconv */
 {"resample_cutoff"      , "set cutoff frequency ratio"  , OFFSET(cutoff)         , AV_OPT_TYPE_DOUBLE,{.dbl=0.                    }, 0      , 1         , PARAM },
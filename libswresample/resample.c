@@ -28,8 +28,12 @@
 
 #include "libavutil/avassert.h"
 #include "libavutil/mem.h"
+#include "libavutil/tx.h"
 #include "resample.h"
 
+/* Maximum number of points of the minimum phase prototype */
+#define MAX_MIN_PHASE_TAPS (1 << 15)
+
 /**
  * builds a polyphase filterbank.
  * @param factor resampling factor
@@ -173,17 +177,202 @@ fail:
     return ret;
 }
 
+/**
+ * Evaluate the continuous windowed sinc prototype used by build_filter()
+ * at an offset of t input samples from its center.
+ */
+static double filter_tap(double t, double factor, int tap_count, int filter_type, double kaiser_beta)
+{
+    double x = M_PI * t * factor, y, w;
+
+    y = x == 0 ? 1.0 : sin(x) / x;
+    switch (filter_type) {
+    case SWR_FILTER_TYPE_CUBIC: {
+        const float d = -0.5; //first order derivative = -0.5
+        x = fabs(t * factor);
+        if (x < 1.0) y = 1 - 3*x*x + 2*x*x*x + d*(            -x*x + x*x*x);
+        else         y =                       d*(-4 + 8*x - 5*x*x + x*x*x);
+        break;}
+    case SWR_FILTER_TYPE_BLACKMAN_NUTTALL:
+        w = -cos(2.0*x / (factor*tap_count));
+        y *= 0.3635819 - 0.4891775 * w + 0.1365995 * (2*w*w-1) - 0.0106411 * (4*w*w*w - 3*w);
+        break;
+    case SWR_FILTER_TYPE_KAISER:
+        w = 2.0*x / (factor*tap_count*M_PI);
+        y *= av_bessel_i0(kaiser_beta*sqrt(FFMAX(1-w*w, 0)));
+        break;
+    default:
+        av_assert0(0);
+    }
+    return y;
+}
+
+/**
+ * builds a minimum phase polyphase filterbank.
+ *
+ * The linear phase prototype of build_filter() is sampled at up to
+ * phase_count points per input sample and converted with the cepstral
+ * method, which keeps its magnitude response but moves its energy to the
+ * first taps. The filter is then advanced by its group delay at DC so that
+ * the output stays aligned with the input timestamps, which leaves only that
+ * group delay as lookahead instead of half of the filter length.
+ *
+ * @param center window offset of the output sample position, if negative it
+ *               is set to the smallest lookahead that does not lose any taps
+ * @return 0 on success, negative on error
+ */
+static int build_filter_min_phase(ResampleContext *c, void *filter, double factor, int tap_count, int alloc,
+                                  int phase_count, int scale, int filter_type, double kaiser_beta, int *center)
+{
+    /* the prototype is linearly interpolated between its points, keep their
+     * count small enough for a fast transform */
+    const int res  = av_clip(MAX_MIN_PHASE_TAPS / tap_count, 1, phase_count);
+    const int taps = tap_count * res;
+    /* oversample the spectrum to keep cepstral aliasing low */
+    const int len  = FFMIN(1 << (av_log2(8 * taps - 1) + 1), 4 * MAX_MIN_PHASE_TAPS);
+    AVComplexDouble *a = NULL, *b = NULL;
+    AVTXContext *fft = NULL, *ifft = NULL;
+    av_tx_fn fft_fn, ifft_fn;
+    double peak = 0, norm = 0, moment = 0, delay, x, y;
+    int ph, i, k, ret;
+
+    if (taps > MAX_MIN_PHASE_TAPS)
+        return AVERROR(EINVAL);
+
+    ret = AVERROR(ENOMEM);
+    a = av_calloc(len, sizeof(*a));
+    b = av_calloc(len, sizeof(*b));
+    if (!a || !b)
+        goto fail;
+    if ((ret = av_tx_init(&fft,  &fft_fn,  AV_TX_DOUBLE_FFT, 0, len, NULL, 0)) < 0 ||
+        (ret = av_tx_init(&ifft, &ifft_fn, AV_TX_DOUBLE_FFT, 1, len, NULL, 0)) < 0)
+        goto fail;
+
+    /* if upsampling, only need to interpolate, no filter */
+    if (factor > 1.0)
+        factor = 1.0;
+
+    for (i = 0; i < taps; i++)
+        a[i].re = filter_tap((i - (taps - 1) / 2.0) / res, factor, tap_count, filter_type, kaiser_beta);
+
+    /* real cepstrum of the prototype, with the stopband floored at -200 dB */
+    fft_fn(fft, b, a, sizeof(*a));
+    for (i = 0; i < len; i++)
+        peak = FFMAX(peak, hypot(b[i].re, b[i].im));
+    for (i = 0; i < len; i++) {
+        a[i].re = log(FFMAX(hypot(b[i].re, b[i].im), peak * 1e-10)) / len;
+        a[i].im = 0;
+    }
+    ifft_fn(ifft, b, a, sizeof(*a));
+
+    /* fold the anticausal part onto the causal one */
+    for (i = 0; i < len; i++) {
+        b[i].re *= i && i < len / 2 ? 2 : i <= len / 2;
+        b[i].im  = 0;
+    }
+
+    fft_fn(fft, a, b, sizeof(*a));
+    for (i = 0; i < len; i++) {
+        const double m = exp(a[i].re) / len;
+        b[i].re = m * cos(a[i].im);
+        b[i].im = m * sin(a[i].im);
+    }
+    ifft_fn(ifft, a, b, sizeof(*a));
+
+    for (i = 0; i < taps; i++) {
+        norm   += a[i].re;
+        moment += a[i].re * i;
+    }
+    delay = av_clipd(moment / norm, 0, taps - 1) / res;
+    norm /= res;
+    if (*center < 0)
+        *center = FFMAX(tap_count - 1 - (int)floor(delay + (phase_count - 1) / (double)phase_count), 0);
+
+    for (ph = 0; ph < phase_count; ph++) {
+        for (i = 0; i < tap_count; i++) {
+            x = (*center - i + (double)ph / phase_count + delay) * res;
+            k = floor(x);
+            y = 0;
+            if (k >= 0 && k < taps)
+                y = a[k].re + (x - k) * ((k + 1 < taps ? a[k + 1].re : 0) - a[k].re);
+            y *= scale / norm;
+            switch (c->format) {
+            case AV_SAMPLE_FMT_S16P:
+                ((int16_t*)filter)[ph * alloc + i] = av_clip_int16(lrint(y));
+                break;
+            case AV_SAMPLE_FMT_S32P:
+                ((int32_t*)filter)[ph * alloc + i] = av_clipl_int32(llrint(y));
+                break;
+            case AV_SAMPLE_FMT_FLTP:
+                ((float*)filter)[ph * alloc + i] = y;
+                break;
+            case AV_SAMPLE_FMT_DBLP:
+                ((double*)filter)[ph * alloc + i] = y;
+                break;
+            }
+        }
+    }
+
+    ret = 0;
+fail:
+    av_tx_uninit(&fft);
+    av_tx_uninit(&ifft);
+    av_free(a);
+    av_free(b);
+    return ret;
+}
+
+/**
+ * builds the filterbank of c for phase_count phases, followed by the extra
+ * phase used for linear interpolation.
+ */
+static int build_filter_bank(ResampleContext *c, uint8_t *filter_bank, int phase_count)
+{
+    int ret;
+
+    if (c->max_delay)
+        ret = build_filter_min_phase(c, filter_bank, c->factor, c->filter_length, c->filter_alloc,
+                                     phase_count, 1 << c->filter_shift, c->filter_type, c->kaiser_beta, &c->center);
+    else
+        ret = build_filter(c, filter_bank, c->factor, c->filter_length, c->filter_alloc,
+                           phase_count, 1 << c->filter_shift, c->filter_type, c->kaiser_beta);
+    if (ret < 0)
+        return ret;
+
+    memcpy(filter_bank + (c->filter_alloc*phase_count+1)*c->felem_size, filter_bank, (c->filter_alloc-1)*c->felem_size);
+    memcpy(filter_bank + (c->filter_alloc*phase_count  )*c->felem_size, filter_bank + (c->filter_alloc - 1)*c->felem_size, c->felem_size);
+    return 0;
+}
+
 static void resample_free(ResampleContext **cc){
     ResampleContext *c = *cc;
     if(!c)
         return;
+    avpriv_slicethread_free(&c->slicethread);
     av_freep(&c->filter_bank);
     av_freep(cc);
 }
 
+static int resample_worker(void *priv, int jobnr, int threadnr, int nb_jobs, int nb_threads)
+{
+    ResampleContext *c = priv;
+    AudioData *dst = c->exec.dst, *src = c->exec.src;
+    int i = jobnr * c->exec.unit;
+    const int end = FFMIN(i + c->exec.unit, dst->ch_count);
+
+    /* the context is advanced by the caller once all channels are done */
+    if (end - i == RESAMPLE_MULTI_CH && c->exec.unit == RESAMPLE_MULTI_CH) {
+        c->dsp.resample_common_multi(c, dst->ch + i, src->ch + i, c->exec.n, 0);
+        return 0;
+    }
+    for (; i < end; i++)
+        c->exec.resample(c, dst->ch[i], src->ch[i], c->exec.n, 0);
+    return 0;
+}
+
 static ResampleContext *resample_init(ResampleContext *c, int out_rate, int in_rate, int filter_size, int phase_shift, int linear,
                                     double cutoff0, enum AVSampleFormat format, enum SwrFilterType filter_type, double kaiser_beta,
-                                    double precision, int cheby, int exact_rational)
+                                    double precision, int cheby, int exact_rational, int max_delay, int threads)
 {
     double cutoff = cutoff0? cutoff0 : 0.97;
     double factor= FFMIN(out_rate * cutoff / in_rate, 1.0);
@@ -206,7 +395,8 @@ static ResampleContext *resample_init(ResampleContext *c, int out_rate, int in_r
 
     if (!c || c->phase_count != phase_count || c->linear!=linear || c->factor != factor
            || c->filter_length != filter_length || c->format != format
-           || c->filter_type != filter_type || c->kaiser_beta != kaiser_beta) {
+           || c->filter_type != filter_type || c->kaiser_beta != kaiser_beta
+           || c->max_delay != max_delay) {
         resample_free(&c);
         c = av_mallocz(sizeof(*c));
         if (!c)
@@ -240,18 +430,37 @@ static ResampleContext *resample_init(ResampleContext *c, int out_rate, int in_r
         c->phase_count   = phase_count;
         c->linear        = linear;
         c->factor        = factor;
-        c->filter_length = filter_length;
-        c->filter_alloc  = FFALIGN(c->filter_length, 8);
-        c->filter_bank   = av_calloc(c->filter_alloc, (phase_count+1)*c->felem_size);
         c->filter_type   = filter_type;
         c->kaiser_beta   = kaiser_beta;
+        c->max_delay     = max_delay;
         c->phase_count_compensation = phase_count_compensation;
-        if (!c->filter_bank)
-            goto error;
-        if (build_filter(c, (void*)c->filter_bank, factor, c->filter_length, c->filter_alloc, phase_count, 1<<c->filter_shift, filter_type, kaiser_beta))
-            goto error;
-        memcpy(c->filter_bank + (c->filter_alloc*phase_count+1)*c->felem_size, c->filter_bank, (c->filter_alloc-1)*c->felem_size);
-        memcpy(c->filter_bank + (c->filter_alloc*phase_count  )*c->felem_size, c->filter_bank + (c->filter_alloc - 1)*c->felem_size, c->felem_size);
+
+        /* with a bounded delay, shorten the filter until its lookahead fits */
+        for (;;) {
+            c->filter_length = filter_length;
+            c->center        = max_delay ? -1 : (filter_length - 1) / 2;
+            c->filter_alloc  = FFALIGN(c->filter_length, 8);
+            c->filter_bank   = av_calloc(c->filter_alloc, (phase_count+1)*c->felem_size);
+            if (!c->filter_bank)
+                goto error;
+            if (build_filter_bank(c, c->filter_bank, phase_count) < 0)
+                goto error;
+            if (filter_length - 1 - c->center <= max_delay || filter_length == 1 || !max_delay)
+                break;
+            av_freep(&c->filter_bank);
+            filter_length = filter_length > 2 ? filter_length - 2 : 1;
+        }
+    }
+
+    if (threads != c->threads || !c->slicethread) {
+        avpriv_slicethread_free(&c->slicethread);
+        if (threads != 1) {
+            int ret = avpriv_slicethread_create2(&c->slicethread, c, resample_worker, NULL, threads);
+            /* fall back to single threaded operation */
+            if (ret < 0 && ret != AVERROR(ENOSYS))
+                goto error;
+        }
+        c->threads = threads;
     }
 
     c->compensation_distance= 0;
@@ -265,13 +474,14 @@ static ResampleContext *resample_init(ResampleContext *c, int out_rate, int in_r
     c->dst_incr_div   = c->dst_incr / c->src_incr;
     c->dst_incr_mod   = c->dst_incr % c->src_incr;
 
-    c->index= -phase_count*((c->filter_length-1)/2);
+    c->index= -phase_count*c->center;
     c->frac= 0;
 
     swri_resample_dsp_init(c);
 
     return c;
 error:
+    avpriv_slicethread_free(&c->slicethread);
     av_freep(&c->filter_bank);
     av_free(c);
     return NULL;
@@ -293,14 +503,11 @@ static int rebuild_filter_bank_with_compensation(ResampleContext *c)
     if (!new_filter_bank)
         return AVERROR(ENOMEM);
 
-    ret = build_filter(c, new_filter_bank, c->factor, c->filter_length, c->filter_alloc,
-                       phase_count, 1 << c->filter_shift, c->filter_type, c->kaiser_beta);
+    ret = build_filter_bank(c, new_filter_bank, phase_count);
     if (ret < 0) {
         av_freep(&new_filter_bank);
         return ret;
     }
-    memcpy(new_filter_bank + (c->filter_alloc*phase_count+1)*c->felem_size, new_filter_bank, (c->filter_alloc-1)*c->felem_size);
-    memcpy(new_filter_bank + (c->filter_alloc*phase_count  )*c->felem_size, new_filter_bank + (c->filter_alloc - 1)*c->felem_size, c->felem_size);
 
     if (!av_reduce(&new_src_incr, &new_dst_incr, c->src_incr,
                    c->dst_incr * (int64_t)(phase_count/c->phase_count), INT32_MAX/2))
@@ -388,8 +595,34 @@ static int multiple_resample(ResampleContext *c, AudioData *dst, int dst_size, A
              * when frac and dst_incr_mod are zero */
             resample_func = (c->linear && (c->frac || c->dst_incr_mod)) ?
                             c->dsp.resample_linear : c->dsp.resample_common;
-            for (i = 0; i < dst->ch_count; i++)
-                *consumed = resample_func(c, dst->ch[i], src->ch[i], dst_size, i+1 == dst->ch_count);
+            if (c->slicethread && dst->ch_count > 1) {
+                /* resample groups of channels in parallel without updating
+                 * the context, then advance it the same way the kernels do */
+                int64_t frac  = c->frac + dst_size * (int64_t)c->dst_incr_mod;
+                int64_t index = c->index + dst_size * (int64_t)c->dst_incr_div + frac / c->src_incr;
+
+                c->exec.dst      = dst;
+                c->exec.src      = src;
+                c->exec.n        = dst_size;
+                c->exec.resample = resample_func;
+                c->exec.unit     = resample_func == c->dsp.resample_common &&
+                                   c->dsp.resample_common_multi ? RESAMPLE_MULTI_CH : 1;
+                avpriv_slicethread_execute2(c->slicethread,
+                                            (dst->ch_count + c->exec.unit - 1) / c->exec.unit, 0);
+
+                *consumed = index / c->phase_count;
+                c->index  = index % c->phase_count;
+                c->frac   = frac % c->src_incr;
+            } else {
+                i = 0;
+                if (resample_func == c->dsp.resample_common && c->dsp.resample_common_multi) {
+                    for (; i + RESAMPLE_MULTI_CH <= dst->ch_count; i += RESAMPLE_MULTI_CH)
+                        *consumed = c->dsp.resample_common_multi(c, dst->ch + i, src->ch + i, dst_size,
+                                                                 i + RESAMPLE_MULTI_CH == dst->ch_count);
+                }
+                for (; i < dst->ch_count; i++)
+                    *consumed = resample_func(c, dst->ch[i], src->ch[i], dst_size, i+1 == dst->ch_count);
+            }
         }
     }
 
@@ -407,7 +640,7 @@ static int multiple_resample(ResampleContext *c, AudioData *dst, int dst_size, A
 
 static int64_t get_delay(struct SwrContext *s, int64_t base){
     ResampleContext *c = s->resample;
-    int64_t num = s->in_buffer_count - (c->filter_length-1)/2;
+    int64_t num = s->in_buffer_count - c->center;
     num *= c->phase_count;
     num -= c->index;
     num *= c->src_incr;
@@ -440,6 +673,10 @@ static int resample_flush(struct SwrContext *s) {
     int i, j, ret;
     int reflection = (FFMIN(s->in_buffer_count, c->filter_length) + 1) / 2;
 
+    /* a minimum phase filter only needs its lookahead to reach the end */
+    if (c->max_delay)
+        reflection = FFMIN(s->in_buffer_count, c->filter_length - 1 - c->center);
+
     if((ret = swri_realloc_audio(a, s->in_buffer_index + s->in_buffer_count + reflection)) < 0)
         return ret;
     av_assert0(a->planar);
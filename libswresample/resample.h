@@ -24,9 +24,13 @@
 
 #include "libavutil/log.h"
 #include "libavutil/samplefmt.h"
+#include "libavutil/slicethread.h"
 
 #include "swresample_internal.h"
 
+/* Number of channels processed at once by resample_common_multi() */
+#define RESAMPLE_MULTI_CH 4
+
 typedef struct ResampleContext {
     const AVClass *av_class;
     uint8_t *filter_bank;
@@ -49,6 +53,18 @@ typedef struct ResampleContext {
     int felem_size;
     int filter_shift;
     int phase_count_compensation;      /* desired phase_count when compensation is enabled */
+    int max_delay;                     /* maximum lookahead in input samples, 0 for a linear phase filter */
+    int center;                        /* window offset of the output sample position */
+
+    AVSliceThread *slicethread;        /* channel groups are resampled in parallel if set */
+    int threads;                       /* requested number of threads, 0 for automatic */
+    struct {
+        AudioData *dst, *src;
+        int n;
+        int unit;                      /* channels per job */
+        int (*resample)(struct ResampleContext *c, void *dst,
+                        const void *src, int n, int update_ctx);
+    } exec;                            /* arguments of the current parallel run */
 
     struct {
         void (*resample_one)(void *dst, const void *src,
@@ -57,6 +73,12 @@ typedef struct ResampleContext {
                                const void *src, int n, int update_ctx);
         int (*resample_linear)(struct ResampleContext *c, void *dst,
                                const void *src, int n, int update_ctx);
+        /**
+         * Same as resample_common, but for RESAMPLE_MULTI_CH channels at
+         * once, which share the filter coefficient loads. (Optional)
+         */
+        int (*resample_common_multi)(struct ResampleContext *c, uint8_t *const *dst,
+                                     uint8_t *const *src, int n, int update_ctx);
     } dsp;
 } ResampleContext;
 
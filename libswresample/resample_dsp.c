@@ -45,28 +45,36 @@
 
 void swri_resample_dsp_init(ResampleContext *c)
 {
+    int (*resample_common_c)(struct ResampleContext *c, void *dst,
+                             const void *src, int n, int update_ctx);
+
     switch(c->format){
     case AV_SAMPLE_FMT_S16P:
         c->dsp.resample_one = resample_one_int16;
         c->dsp.resample_common = resample_common_int16;
+        c->dsp.resample_common_multi = resample_common_multi_int16;
         c->dsp.resample_linear = resample_linear_int16;
         break;
     case AV_SAMPLE_FMT_S32P:
         c->dsp.resample_one = resample_one_int32;
         c->dsp.resample_common = resample_common_int32;
+        c->dsp.resample_common_multi = resample_common_multi_int32;
         c->dsp.resample_linear = resample_linear_int32;
         break;
     case AV_SAMPLE_FMT_FLTP:
         c->dsp.resample_one = resample_one_float;
         c->dsp.resample_common = resample_common_float;
+        c->dsp.resample_common_multi = resample_common_multi_float;
         c->dsp.resample_linear = resample_linear_float;
         break;
     case AV_SAMPLE_FMT_DBLP:
         c->dsp.resample_one = resample_one_double;
         c->dsp.resample_common = resample_common_double;
+        c->dsp.resample_common_multi = resample_common_multi_double;
         c->dsp.resample_linear = resample_linear_double;
         break;
     }
+    resample_common_c = c->dsp.resample_common;
 
 #if ARCH_X86 && HAVE_X86ASM
     swri_resample_dsp_x86_init(c);
@@ -75,4 +83,9 @@ void swri_resample_dsp_init(ResampleContext *c)
 #elif ARCH_AARCH64
     swri_resample_dsp_aarch64_init(c);
 #endif
+
+    /* The scalar multi-channel kernel only pays off over the scalar
+     * single-channel one; don't use it in place of SIMD implementations */
+    if (c->dsp.resample_common != resample_common_c)
+        c->dsp.resample_common_multi = NULL;
 }
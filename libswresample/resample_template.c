@@ -146,6 +146,78 @@ static int RENAME(resample_common)(ResampleContext *c,
     return sample_index;
 }
 
+static int RENAME(resample_common_multi)(ResampleContext *c,
+                                         uint8_t *const *dest, uint8_t *const *source,
+                                         int n, int update_ctx)
+{
+    DELEM *dst[RESAMPLE_MULTI_CH];
+    const DELEM *src[RESAMPLE_MULTI_CH];
+    int dst_index, ch;
+    int index= c->index;
+    int frac= c->frac;
+    int sample_index = 0;
+
+    for (ch = 0; ch < RESAMPLE_MULTI_CH; ch++) {
+        dst[ch] = (DELEM *) dest[ch];
+        src[ch] = (const DELEM *) source[ch];
+    }
+
+    while (index >= c->phase_count) {
+        sample_index++;
+        index -= c->phase_count;
+    }
+
+    for (dst_index = 0; dst_index < n; dst_index++) {
+        FELEM *filter = ((FELEM *) c->filter_bank) + c->filter_alloc * index;
+
+        /* Same summation order as resample_common(), per channel */
+        FELEM2 val[RESAMPLE_MULTI_CH], val2[RESAMPLE_MULTI_CH];
+        int i;
+        for (ch = 0; ch < RESAMPLE_MULTI_CH; ch++) {
+            val[ch]  = FOFFSET;
+            val2[ch] = 0;
+        }
+        for (i = 0; i + 1 < c->filter_length; i+=2) {
+            const FELEM2 f0 = filter[i], f1 = filter[i + 1];
+            for (ch = 0; ch < RESAMPLE_MULTI_CH; ch++) {
+                val[ch]  += src[ch][sample_index + i    ] * f0;
+                val2[ch] += src[ch][sample_index + i + 1] * f1;
+            }
+        }
+        if (i < c->filter_length) {
+            const FELEM2 f0 = filter[i];
+            for (ch = 0; ch < RESAMPLE_MULTI_CH; ch++)
+                val[ch] += src[ch][sample_index + i] * f0;
+        }
+        for (ch = 0; ch < RESAMPLE_MULTI_CH; ch++) {
+#ifdef FELEML
+            OUT(dst[ch][dst_index], val[ch] + (FELEML)val2[ch]);
+#else
+            OUT(dst[ch][dst_index], val[ch] + val2[ch]);
+#endif
+        }
+
+        frac  += c->dst_incr_mod;
+        index += c->dst_incr_div;
+        if (frac >= c->src_incr) {
+            frac -= c->src_incr;
+            index++;
+        }
+
+        while (index >= c->phase_count) {
+            sample_index++;
+            index -= c->phase_count;
+        }
+    }
+
+    if(update_ctx){
+        c->frac= frac;
+        c->index= index;
+    }
+
+    return sample_index;
+}
+
 static int RENAME(resample_linear)(ResampleContext *c,
                                    void *dest, const void *source,
                                    int n, int update_ctx)
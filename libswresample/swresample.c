@@ -30,6 +30,9 @@
 
 #define ALIGN 32
 
+/* Size of the temporary buffer between fused conversion and rematrixing */
+#define STRIPE_BYTES (16 << 10)
+
 int swri_check_chlayout(struct SwrContext *s, const AVChannelLayout *chl, const char *name) {
     char l1[1024];
     int ret;
@@ -153,6 +156,23 @@ av_cold void swr_close(SwrContext *s){
     clear_context(s);
 }
 
+/**
+ * Check whether swri_rematrix() may pass some input channels through by
+ * pointer instead of writing them, which prevents running it on stripes of
+ * a temporary buffer.
+ */
+static int rematrix_passes_through(SwrContext *s)
+{
+    if (s->mix_any_f)
+        return 0;
+    for (int out_i = 0; out_i < s->out.ch_count; out_i++) {
+        if (s->matrix_ch[out_i][0] == 1 &&
+            s->matrix[out_i][s->matrix_ch[out_i][1]] == 1.0)
+            return 1;
+    }
+    return 0;
+}
+
 av_cold int swr_init(struct SwrContext *s){
     int ret;
     char l1[1024], l2[1024];
@@ -284,7 +304,7 @@ av_cold int swr_init(struct SwrContext *s){
     }
 
     if (s->out_sample_rate!=s->in_sample_rate || (s->flags & SWR_FLAG_RESAMPLE)){
-        s->resample = s->resampler->init(s->resample, s->out_sample_rate, s->in_sample_rate, s->filter_size, s->phase_shift, s->linear_interp, s->cutoff, s->int_sample_fmt, s->filter_type, s->kaiser_beta, s->precision, s->cheby, s->exact_rational);
+        s->resample = s->resampler->init(s->resample, s->out_sample_rate, s->in_sample_rate, s->filter_size, s->phase_shift, s->linear_interp, s->cutoff, s->int_sample_fmt, s->filter_type, s->kaiser_beta, s->precision, s->cheby, s->exact_rational, s->max_delay, s->threads);
         if (!s->resample) {
             av_log(s, AV_LOG_ERROR, "Failed to initialize resampler\n");
             return AVERROR(ENOMEM);
@@ -335,6 +355,10 @@ av_cold int swr_init(struct SwrContext *s){
 av_assert0(s->used_ch_layout.nb_channels);
 av_assert0(s->out.ch_count);
     s->resample_first= RSC*s->out.ch_count/s->used_ch_layout.nb_channels - RSC < s->out_sample_rate/(float)s-> in_sample_rate - 1.0;
+    /* downmix before resampling, so that fewer channels go through the filter
+     * and the rematrixing can be fused with the input conversion */
+    if (s->out.ch_count < s->used_ch_layout.nb_channels)
+        s->resample_first = 0;
 
     s->in_buffer= s->in;
     s->silence  = s->in;
@@ -398,6 +422,8 @@ av_assert0(s->out.ch_count);
             goto fail;
     }
 
+    s->rematrix_stripes = s->rematrix && !rematrix_passes_through(s);
+
     return 0;
 fail:
     swr_close(s);
@@ -588,6 +614,53 @@ static int resample(SwrContext *s, AudioData *out_param, int out_count,
     return ret_sum;
 }
 
+/**
+ * Number of samples per stripe for the fused conversion and rematrixing,
+ * so that the temporary buffer between the two stays in the cache.
+ */
+static int stripe_size(const AudioData *tmp)
+{
+    return FFMAX(STRIPE_BYTES / (tmp->ch_count * tmp->bps) & ~63, 64);
+}
+
+/**
+ * Convert the input to the internal sample format and rematrix it, one
+ * stripe at a time through tmp.
+ */
+static void convert_rematrix(SwrContext *s, AudioData *out, AudioData *tmp,
+                             AudioData *in, int count)
+{
+    const int stripe = stripe_size(tmp);
+    AudioData in_s = *in, out_s = *out;
+
+    for (int pos = 0; pos < count; pos += stripe) {
+        const int n = FFMIN(stripe, count - pos);
+        buf_set(&in_s,  in,  pos);
+        buf_set(&out_s, out, pos);
+        swri_audio_convert(s->in_convert, tmp, &in_s, n);
+        swri_rematrix(s, &out_s, tmp, n, 1);
+    }
+}
+
+/**
+ * Rematrix and convert to the output sample format, one stripe at a time
+ * through tmp.
+ */
+static void rematrix_convert(SwrContext *s, AudioData *out, AudioData *tmp,
+                             AudioData *in, int count)
+{
+    const int stripe = stripe_size(tmp);
+    AudioData in_s = *in, out_s = *out;
+
+    for (int pos = 0; pos < count; pos += stripe) {
+        const int n = FFMIN(stripe, count - pos);
+        buf_set(&in_s,  in,  pos);
+        buf_set(&out_s, out, pos);
+        swri_rematrix(s, tmp, &in_s, n, 1);
+        swri_audio_convert(s->out_convert, &out_s, tmp, n);
+    }
+}
+
 static int swr_convert_internal(struct SwrContext *s, AudioData *out, int out_count,
                                                       AudioData *in , int  in_count){
     AudioData *postin, *midbuf, *preout;
@@ -647,15 +720,24 @@ static int swr_convert_internal(struct SwrContext *s, AudioData *out, int out_co
     }
 
     if(in != postin){
-        swri_audio_convert(s->in_convert, postin, in, in_count);
+        if(!s->resample_first && postin != midbuf && s->rematrix_stripes){
+            convert_rematrix(s, midbuf, postin, in, in_count);
+            postin= midbuf;
+        }else
+            swri_audio_convert(s->in_convert, postin, in, in_count);
     }
 
     if(s->resample_first){
         if(postin != midbuf)
             if ((out_count = resample(s, midbuf, out_count, postin, in_count)) < 0)
                 return out_count;
-        if(midbuf != preout)
+        if(midbuf != preout){
+            if(preout != out && s->rematrix_stripes && !s->dither.method){
+                rematrix_convert(s, out, preout, midbuf, out_count);
+                return out_count;
+            }
             swri_rematrix(s, preout, midbuf, out_count, preout==out);
+        }
     }else{
         if(postin != midbuf)
             swri_rematrix(s, midbuf, postin, in_count, midbuf==out);
@@ -114,6 +114,11 @@ static int convert_to_aarch64_impl(SwsContext *ctx, const SwsOpList *ops, int n,
 
     out->type = op->type;
 
+    /* Half floats are not (yet) handled by the NEON kernels */
+    if (op->type == SWS_PIXEL_F16 ||
+        (op->op == SWS_OP_CONVERT && op->convert.to == SWS_PIXEL_F16))
+        return AVERROR(ENOTSUP);
+
     /* Map SwsOpType to SwsUOpType */
     switch (op->op) {
     case SWS_OP_READ:
@@ -739,8 +739,8 @@ static SwsPixelType fmt_pixel_type(enum AVPixelFormat fmt)
     const int bits = FFALIGN(desc->comp[0].depth, 8);
     if (desc->flags & AV_PIX_FMT_FLAG_FLOAT) {
         switch (bits) {
+        case 16: /* half floats are only a storage format, see fmt_analyze() */
         case 32: return SWS_PIXEL_F32;
-        /* TODO: no support for 16-bit float yet */
         }
     } else {
         switch (bits) {
@@ -962,6 +962,8 @@ static int fmt_analyze(enum AVPixelFormat fmt, SwsReadWriteOp *rw_op,
     *pixel_type = *raw_type = fmt_pixel_type(fmt);
     if (!*pixel_type)
         return AVERROR(ENOTSUP);
+    if ((desc->flags & AV_PIX_FMT_FLAG_FLOAT) && desc->comp[0].depth == 16)
+        *raw_type = SWS_PIXEL_F16;
 
     if (is_regular_fmt(fmt)) {
         *pack_op = (SwsPackOp) {0};
@@ -1115,7 +1117,9 @@ int ff_sws_decode_pixfmt(SwsOpList *ops, const SwsFormat *fmt)
             .type = raw_type,
             .pack = unpack,
         }));
+    }
 
+    if (raw_type != pixel_type) {
         RET(ff_sws_op_list_append(ops, &(SwsOp) {
             .op   = SWS_OP_CONVERT,
             .type = raw_type,
@@ -1186,13 +1190,15 @@ int ff_sws_encode_pixfmt(SwsOpList *ops, const SwsFormat *fmt)
         .swizzle = swizzle,
     }));
 
-    if (pack.pattern[0]) {
+    if (raw_type != pixel_type) {
         RET(ff_sws_op_list_append(ops, &(SwsOp) {
             .op   = SWS_OP_CONVERT,
             .type = pixel_type,
             .convert.to = raw_type,
         }));
+    }
 
+    if (pack.pattern[0]) {
         RET(ff_sws_op_list_append(ops, &(SwsOp) {
             .op   = SWS_OP_PACK,
             .type = raw_type,
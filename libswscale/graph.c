@@ -24,11 +24,13 @@
 #include "libavutil/hwcontext.h"
 #include "libavutil/imgutils.h"
 #include "libavutil/macros.h"
+#include "libavutil/mathematics.h"
 #include "libavutil/mem.h"
 #include "libavutil/opt.h"
 #include "libavutil/pixdesc.h"
 #include "libavutil/refstruct.h"
 #include "libavutil/slicethread.h"
+#include "libavutil/time.h"
 
 #include "libswscale/swscale.h"
 #include "libswscale/format.h"
@@ -214,6 +216,7 @@ int ff_sws_graph_add_pass(SwsGraph *graph, enum AVPixelFormat fmt,
     pass->format = fmt;
     pass->lines  = lines;
     pass->input  = input;
+    pass->slice_align = align;
     pass->output = av_refstruct_alloc_ext(sizeof(*pass->output), 0, NULL, free_buffer);
     if (!pass->output) {
         ret = AVERROR(ENOMEM);
@@ -482,6 +485,7 @@ static int init_legacy_subpass(SwsGraph *graph, SwsContext *sws,
             sws_free_context(&sws);
             return ret;
         }
+        input->row_local = true;
     }
 
     if (c->srcXYZ && !(c->dstXYZ && unscaled)) {
@@ -491,6 +495,7 @@ static int init_legacy_subpass(SwsGraph *graph, SwsContext *sws,
             sws_free_context(&sws);
             return ret;
         }
+        input->row_local = true;
     }
 
     ret = ff_sws_graph_add_pass(graph, sws->dst_format, dst_w, dst_h, input, 0, align,
@@ -548,6 +553,7 @@ static int init_legacy_subpass(SwsGraph *graph, SwsContext *sws,
                                     0, 1, run_rgb2xyz, NULL, c, NULL, &pass);
         if (ret < 0)
             return ret;
+        pass->row_local = true;
     }
 
     *output = pass;
@@ -684,6 +690,7 @@ static int add_legacy_3dlut_pass(SwsGraph *graph, const SwsFormat *src,
     if (ret < 0)
         return ret;
 
+    (*output)->row_local = true;
     return 0;
 }
 
@@ -717,7 +724,9 @@ static int add_ops_convert_pass(SwsGraph *graph, const SwsFormat *src,
     av_log(ctx, AV_LOG_DEBUG, "Unoptimized operation list:\n");
     ff_sws_op_list_print(ctx, AV_LOG_DEBUG, AV_LOG_TRACE, ops);
 
-    const int flags = SWS_OP_FLAG_OPTIMIZE | SWS_OP_FLAG_SPLIT_MEMCPY;
+    int flags = SWS_OP_FLAG_OPTIMIZE | SWS_OP_FLAG_SPLIT_MEMCPY;
+    if (sws_internal(ctx)->keep_op_lists)
+        flags |= SWS_OP_FLAG_KEEP_OPS;
     return ff_sws_compile_pass(graph, NULL, &ops, flags, input, output);
 #else
     return AVERROR(ENOTSUP);
@@ -851,10 +860,178 @@ static int init_passes(SwsGraph *graph)
     return 0;
 }
 
+/**
+ * Upper bound on the amount of image data (summed over the input and all
+ * outputs of a pass group) touched by a single stripe. Chosen to comfortably
+ * fit into the L2 cache of a single core.
+ */
+#define STRIPE_BYTES (256 << 10)
+#define MAX_GROUP_PASSES 8
+
+static int row_bytes(enum AVPixelFormat fmt, int width)
+{
+    int linesize[4], bytes = 0;
+    if (av_image_fill_linesizes(linesize, fmt, width) < 0)
+        return 0;
+    for (int i = 0; i < 4; i++)
+        bytes += linesize[i] >> ff_fmt_vshift(fmt, i);
+    return bytes;
+}
+
+/* Returns whether `pass` may be appended to the group ending with `prev` */
+static bool can_fuse(const SwsGraph *graph, const SwsPass *prev,
+                     const SwsPass *pass, bool row_local)
+{
+    if (pass->row_local && row_local)
+        return pass->lines == prev->lines;
+
+    /**
+     * Otherwise, we need a linear chain of passes, with each pass only
+     * depending on the previous one. Since the dependencies between lines
+     * overlap, such groups can not be sliced without redundant work, so
+     * only fuse them when not threading; in which case this is a strict
+     * improvement over running each pass on its own.
+     */
+    if (graph->num_threads > 1 || pass->input != prev || prev->output == pass->output)
+        return false;
+    if (!pass->row_local && !pass->row_offsets)
+        return false;
+
+    /* The output of `prev` must not be consumed outside of the group */
+    for (int i = 0; i < graph->num_passes; i++) {
+        const SwsPass *other = graph->passes[i];
+        if (other != pass && other->input == prev)
+            return false;
+    }
+
+    return true;
+}
+
+static int init_groups(SwsGraph *graph)
+{
+    for (int i = 0; i < graph->num_passes; i++) {
+        const SwsPass *first = graph->passes[i];
+        if (!first->row_local)
+            continue;
+
+        int align = FFMAX(first->slice_align, 1);
+        bool threaded  = first->slice_align > 0;
+        bool row_local = true;
+        int64_t bytes = first->input ? row_bytes(first->input->format,
+                                                 first->input->output->width)
+                                     : row_bytes(graph->src.format, graph->src.width);
+        int num = 1;
+        bytes += row_bytes(first->format, first->output->width);
+        while (i + num < graph->num_passes && num < MAX_GROUP_PASSES) {
+            const SwsPass *prev = graph->passes[i + num - 1];
+            const SwsPass *pass = graph->passes[i + num];
+            if (!can_fuse(graph, prev, pass, row_local))
+                break;
+            if (pass->lines != prev->lines)
+                align = 1; /* only the last pass is sliced directly */
+            if (pass->slice_align > 0)
+                align = align / av_gcd(align, pass->slice_align) * pass->slice_align;
+            threaded  &= pass->slice_align > 0;
+            row_local &= pass->row_local;
+            bytes += row_bytes(pass->format, pass->output->width);
+            num++;
+        }
+
+        if (num < 2)
+            continue;
+
+        const SwsPass *last = graph->passes[i + num - 1];
+        SwsPassGroup group = {
+            .first_pass = i,
+            .num_passes = num,
+            .lines      = last->lines,
+        };
+
+        group.stripe_h = bytes > 0 ? STRIPE_BYTES / bytes : 1;
+        group.stripe_h = FFMAX(group.stripe_h / align, 1) * align;
+
+        if (!threaded || !row_local) {
+            group.slice_h    = group.lines;
+            group.num_slices = 1;
+        } else {
+            group.slice_h = (group.lines + graph->num_threads - 1) / graph->num_threads;
+            group.slice_h = FFALIGN(group.slice_h, align);
+            group.num_slices = (group.lines + group.slice_h - 1) / group.slice_h;
+        }
+
+        if (!av_dynarray2_add((void **) &graph->groups, &graph->num_groups,
+                              sizeof(group), (const uint8_t *) &group))
+            return AVERROR(ENOMEM);
+
+        av_log(graph->ctx, AV_LOG_DEBUG, "Fusing passes %d-%d, stripe height %d\n",
+               i, i + num - 1, group.stripe_h);
+        i += num - 1;
+    }
+
+    return 0;
+}
+
+static const SwsFrame *pass_input(const SwsGraph *graph, const SwsPass *pass)
+{
+    return pass->input ? &pass->input->output->frame : graph->exec.src;
+}
+
+static const SwsFrame *pass_output(const SwsGraph *graph, const SwsPass *pass)
+{
+    return pass->output->avframe ? &pass->output->frame : graph->exec.dst;
+}
+
+/* Number of lines of `input` needed to produce the first `lines` of `pass` */
+static int input_lines(const SwsPass *pass, const SwsPass *input, int lines)
+{
+    if (pass->row_local)
+        return lines;
+
+    lines = pass->row_offsets[lines - 1] + pass->row_taps;
+    lines = FFALIGN(lines, FFMAX(input->slice_align, 1));
+    return FFMIN(lines, input->lines);
+}
+
+static void run_group(const SwsGraph *graph, const SwsPassGroup *group,
+                      const int y, const int h)
+{
+    const SwsPass *const *passes = (const SwsPass **) &graph->passes[group->first_pass];
+    const int num = group->num_passes;
+    int done[MAX_GROUP_PASSES], need[MAX_GROUP_PASSES];
+
+    /* Row-local groups may start at any (aligned) line; other groups are
+     * never sliced, so they always start at the first line */
+    for (int i = 0; i < num; i++)
+        done[i] = y;
+
+    for (int y0 = y; y0 < y + h; y0 += group->stripe_h) {
+        need[num - 1] = FFMIN(y0 + group->stripe_h, y + h);
+        for (int i = num - 1; i > 0; i--)
+            need[i - 1] = input_lines(passes[i], passes[i - 1], need[i]);
+
+        for (int i = 0; i < num; i++) {
+            const SwsPass *pass = passes[i];
+            if (need[i] <= done[i])
+                continue;
+            pass->run(pass_output(graph, pass), pass_input(graph, pass),
+                      done[i], need[i] - done[i], pass);
+            done[i] = need[i];
+        }
+    }
+}
+
 static int sws_graph_worker(void *priv, int jobnr, int threadnr, int nb_jobs,
                             int nb_threads)
 {
     SwsGraph *graph = priv;
+    const SwsPassGroup *group = graph->exec.group;
+    if (group) {
+        const int slice_y = jobnr * group->slice_h;
+        const int slice_h = FFMIN(group->slice_h, group->lines - slice_y);
+        run_group(graph, group, slice_y, slice_h);
+        return 0;
+    }
+
     const SwsPass *pass = graph->exec.pass;
     const int slice_y = jobnr * pass->slice_h;
     const int slice_h = FFMIN(pass->slice_h, pass->lines - slice_y);
@@ -875,6 +1052,7 @@ static void graph_uninit(SwsGraph *graph)
     for (int i = 0; i < graph->num_passes; i++)
         pass_free(graph->passes[i]);
     av_free(graph->passes);
+    av_free(graph->groups);
 
     av_refstruct_unref(&graph->lut3d);
 
@@ -925,6 +1103,10 @@ int ff_sws_graph_init(SwsGraph *graph, SwsContext *ctx, const SwsFormat *dst,
             goto error;
     }
 
+    ret = init_groups(graph);
+    if (ret < 0)
+        goto error;
+
     return 0;
 
 error:
@@ -1031,23 +1213,56 @@ int ff_sws_graph_run(SwsGraph *graph, const AVFrame *dst, const AVFrame *src)
     SwsFrame src_field, dst_field;
     get_field(graph, &graph->dst, dst, &dst_field);
     get_field(graph, &graph->src, src, &src_field);
+    graph->exec.src   = &src_field;
+    graph->exec.dst   = &dst_field;
+    graph->exec.group = NULL;
+
+    for (int i = 0, g = 0; i < graph->num_passes; i++) {
+        if (g < graph->num_groups && graph->groups[g].first_pass == i) {
+            const SwsPassGroup *group = &graph->groups[g++];
+            for (int j = 0; j < group->num_passes; j++) {
+                const SwsPass *pass = graph->passes[i + j];
+                if (pass->setup) {
+                    int ret = pass->setup(pass_output(graph, pass),
+                                          pass_input(graph, pass), pass);
+                    if (ret < 0)
+                        return ret;
+                }
+            }
+
+            const int64_t start = graph->pass_time ? av_gettime_relative() : 0;
+            if (group->num_slices == 1) {
+                run_group(graph, group, 0, group->lines);
+            } else {
+                graph->exec.group = group;
+                avpriv_slicethread_execute2(graph->slicethread, group->num_slices, 0);
+                graph->exec.group = NULL;
+            }
+            if (graph->pass_time)
+                graph->pass_time[i] += av_gettime_relative() - start;
+
+            i += group->num_passes - 1;
+            continue;
+        }
 
-    for (int i = 0; i < graph->num_passes; i++) {
         const SwsPass *pass = graph->passes[i];
         graph->exec.pass   = pass;
-        graph->exec.input  = pass->input ? &pass->input->output->frame : &src_field;
-        graph->exec.output = pass->output->avframe ? &pass->output->frame : &dst_field;
+        graph->exec.input  = pass_input(graph, pass);
+        graph->exec.output = pass_output(graph, pass);
         if (pass->setup) {
             int ret = pass->setup(graph->exec.output, graph->exec.input, pass);
             if (ret < 0)
                 return ret;
         }
 
+        const int64_t start = graph->pass_time ? av_gettime_relative() : 0;
         if (pass->num_slices == 1) {
             pass->run(graph->exec.output, graph->exec.input, 0, pass->lines, pass);
         } else {
             avpriv_slicethread_execute2(graph->slicethread, pass->num_slices, 0);
         }
+        if (graph->pass_time)
+            graph->pass_time[i] += av_gettime_relative() - start;
     }
 
     return 0;
@@ -95,8 +95,24 @@ struct SwsPass {
     enum AVPixelFormat format; /* new pixel format */
     int lines;         /* pass dispatch size */
     int slice_h;       /* filter granularity */
+    int slice_align;   /* minimum slice alignment, or 0 for no threading */
     int num_slices;
 
+    /**
+     * Set if each output line only depends on the same line of the input,
+     * i.e. the pass performs no vertical scaling or filtering. Consecutive
+     * row-local passes may be run together, one stripe of lines at a time.
+     */
+    bool row_local;
+
+    /**
+     * For vertically filtering passes, output line `y` depends on the input
+     * lines [row_offsets[y], row_offsets[y] + row_taps). Optional; if unset,
+     * the pass can only be run on fully available input.
+     */
+    const int *row_offsets;
+    int row_taps;
+
     /**
      * Filter input. This pass's output will be resolved to form this pass's.
      * input. If NULL, the original input image is used.
@@ -126,6 +142,22 @@ struct SwsPass {
  */
 int ff_sws_pass_aligned_width(const SwsPass *pass, int width);
 
+/**
+ * Run of consecutive passes that are executed together, in stripes of lines
+ * small enough for the intermediate data to remain in cache between passes,
+ * rather than running each pass over the entire image in turn. Each stripe
+ * of the last pass only pulls in the lines it depends on from the previous
+ * passes.
+ */
+typedef struct SwsPassGroup {
+    int first_pass;    /* index into SwsGraph.passes */
+    int num_passes;
+    int lines;         /* dispatch size of the last pass */
+    int stripe_h;      /* lines of the last pass processed per stripe */
+    int slice_h;       /* threading granularity */
+    int num_slices;
+} SwsPassGroup;
+
 /**
  * Filter graph, which represents a 'baked' pixel format conversion.
  */
@@ -153,6 +185,11 @@ typedef struct SwsGraph {
     SwsPass **passes;
     int num_passes;
 
+    /** Fused runs of passes, set during init(). Only groups of two or more
+     *  passes are listed; all other passes are run one at a time. */
+    SwsPassGroup *groups;
+    int num_groups;
+
     /**
      * Cached copy of the public options that were used to construct this
      * SwsGraph. Used only to detect when the graph needs to be reinitialized.
@@ -169,6 +206,15 @@ typedef struct SwsGraph {
      */
     SwsLut3D *lut3d; /* refstruct */
 
+    /**
+     * Optional per-pass timing, indexed like `passes`. If set, the wall clock
+     * time (in microseconds) spent running each pass is added to the
+     * corresponding entry by ff_sws_graph_run(). Fused pass groups are
+     * accounted to the first pass of the group. Owned by the caller, and
+     * cleared whenever the graph is reinitialized. (Optional)
+     */
+    int64_t *pass_time;
+
     /**
      * Temporary execution state inside ff_sws_graph_run(); used to pass
      * data to worker threads.
@@ -177,6 +223,8 @@ typedef struct SwsGraph {
         const SwsPass *pass; /* current filter pass */
         const SwsFrame *input; /* current filter pass input/output */
         const SwsFrame *output;
+        const SwsPassGroup *group; /* current pass group, or NULL */
+        const SwsFrame *src, *dst; /* graph input/output, for pass groups */
     } exec;
 } SwsGraph;
 
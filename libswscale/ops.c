@@ -59,6 +59,7 @@ const char *ff_sws_pixel_type_name(SwsPixelType type)
     case SWS_PIXEL_U8:   return "u8";
     case SWS_PIXEL_U16:  return "u16";
     case SWS_PIXEL_U32:  return "u32";
+    case SWS_PIXEL_F16:  return "f16";
     case SWS_PIXEL_F32:  return "f32";
     case SWS_PIXEL_NONE: return "none";
     case SWS_PIXEL_TYPE_NB: break;
@@ -372,4 +372,12 @@ void ff_sws_op_list_update_comps(SwsOpList *ops);
  */
 int ff_sws_op_list_optimize(SwsOpList *ops);
 
+/**
+ * Same as ff_sws_op_list_optimize(), but first consults a process-wide cache
+ * of previously optimized lists, as well as the on-disk cache in
+ * `ctx->cache_dir` if set, and adds the result to them otherwise. On
+ * success, *ops may be replaced by a different (but equivalent) list.
+ */
+int ff_sws_op_list_optimize_cached(SwsContext *ctx, SwsOpList **ops);
+
 #endif
@@ -0,0 +1,762 @@
+/**
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include <errno.h>
+#include <inttypes.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "libavutil/avutil.h"
+#include "libavutil/bprint.h"
+#include "libavutil/crc.h"
+#include "libavutil/error.h"
+#include "libavutil/file_open.h"
+#include "libavutil/intreadwrite.h"
+#include "libavutil/macros.h"
+#include "libavutil/mem.h"
+#include "libavutil/random_seed.h"
+#include "libavutil/refstruct.h"
+#include "libavutil/sha.h"
+#include "libavutil/thread.h"
+
+#include "ops.h"
+#include "version.h"
+
+/**
+ * Process-wide cache of optimized operation lists, shared between all
+ * SwsContexts. Entries are keyed by a canonical serialization of the
+ * unoptimized list, including the contents of all filter kernels and dither
+ * matrices, so that two independently generated but otherwise identical
+ * lists map to the same entry.
+ */
+enum {
+    CACHE_ENTRIES = 32,
+};
+
+typedef struct CacheEntry {
+    uint8_t *key;
+    unsigned key_size;
+    uint32_t crc;
+    SwsOpList *ops; /* optimized list */
+} CacheEntry;
+
+static AVMutex cache_lock = AV_MUTEX_INITIALIZER;
+static CacheEntry cache[CACHE_ENTRIES]; /* most recently used first */
+static int cache_size;
+
+#define PUT(x) av_bprint_append_data(bp, (const char *) &(x), sizeof(x))
+
+static void put_format(AVBPrint *bp, const SwsFormat *fmt)
+{
+    PUT(fmt->width);
+    PUT(fmt->height);
+    PUT(fmt->interlaced);
+    PUT(fmt->field);
+    PUT(fmt->format);
+    PUT(fmt->hw_format);
+    PUT(fmt->range);
+    PUT(fmt->csp);
+    PUT(fmt->loc);
+    PUT(fmt->color.prim);
+    PUT(fmt->color.trc);
+    PUT(fmt->color.gamut);
+    PUT(fmt->color.min_luma);
+    PUT(fmt->color.max_luma);
+    PUT(fmt->color.frame_peak);
+    PUT(fmt->color.frame_avg);
+}
+
+static void put_comps(AVBPrint *bp, const SwsComps *comps)
+{
+    PUT(comps->flags);
+    PUT(comps->min);
+    PUT(comps->max);
+    PUT(comps->dep_in);
+    PUT(comps->dep_out);
+}
+
+static void put_kernel(AVBPrint *bp, const SwsFilterWeights *k)
+{
+    PUT(k->filter_size);
+    PUT(k->num_weights);
+    av_bprint_append_data(bp, (const char *) k->weights,
+                          k->num_weights * sizeof(*k->weights));
+    av_bprint_append_data(bp, (const char *) k->offsets,
+                          k->dst_size * sizeof(*k->offsets));
+    PUT(k->src_size);
+    PUT(k->dst_size);
+    PUT(k->virtual_size);
+    PUT(k->offset);
+    PUT(k->name);
+    PUT(k->sum_positive);
+    PUT(k->sum_negative);
+}
+
+/* Returns the filter kernel or dither matrix held by an op, if any */
+static void *op_ref(const SwsOp *op)
+{
+    switch (op->op) {
+    case SWS_OP_READ:     return op->rw.filter.kernel;
+    case SWS_OP_DITHER:   return op->dither.matrix;
+    case SWS_OP_FILTER_H:
+    case SWS_OP_FILTER_V: return op->filter.kernel;
+    default:              return NULL;
+    }
+}
+
+/* Write `ref` as the index of the op holding it in `refs`, or -1 for none */
+static int put_ref(AVBPrint *bp, const SwsOpList *refs, const void *ref)
+{
+    int32_t idx = -1;
+
+    if (ref) {
+        for (idx = 0; idx < refs->num_ops; idx++) {
+            if (op_ref(&refs->ops[idx]) == ref)
+                break;
+        }
+        if (idx == refs->num_ops)
+            return AVERROR(ENOTSUP);
+    }
+
+    PUT(idx);
+    return 0;
+}
+
+/**
+ * Serialize an op into `bp`. Filter kernels and dither matrices are written
+ * by value, or as references into `refs` if it is set.
+ */
+static int put_op(AVBPrint *bp, const SwsOp *op, const SwsOpList *refs)
+{
+    int ret;
+
+    PUT(op->op);
+    PUT(op->type);
+
+    switch (op->op) {
+    case SWS_OP_READ:
+    case SWS_OP_WRITE:
+        PUT(op->rw.mode);
+        PUT(op->rw.elems);
+        PUT(op->rw.frac);
+        PUT(op->rw.filter.op);
+        PUT(op->rw.filter.type);
+        if (refs)
+            return put_ref(bp, refs, op->rw.filter.kernel);
+        if (op->rw.filter.kernel)
+            put_kernel(bp, op->rw.filter.kernel);
+        return 0;
+    case SWS_OP_SWAP_BYTES:
+        return 0;
+    case SWS_OP_SWIZZLE:
+        PUT(op->swizzle.mask);
+        return 0;
+    case SWS_OP_UNPACK:
+    case SWS_OP_PACK:
+        PUT(op->pack.pattern);
+        return 0;
+    case SWS_OP_LSHIFT:
+    case SWS_OP_RSHIFT:
+        PUT(op->shift.amount);
+        return 0;
+    case SWS_OP_CLEAR:
+        PUT(op->clear.mask);
+        PUT(op->clear.value);
+        return 0;
+    case SWS_OP_CONVERT:
+        PUT(op->convert.to);
+        PUT(op->convert.expand);
+        return 0;
+    case SWS_OP_MIN:
+    case SWS_OP_MAX:
+        PUT(op->clamp.limit);
+        return 0;
+    case SWS_OP_SCALE:
+        PUT(op->scale.factor);
+        return 0;
+    case SWS_OP_LINEAR:
+        PUT(op->lin.m);
+        return 0;
+    case SWS_OP_DITHER:
+        if (refs) {
+            if ((ret = put_ref(bp, refs, op->dither.matrix)) < 0)
+                return ret;
+        } else {
+            const size_t size = (size_t) 1 << op->dither.size_log2;
+            av_bprint_append_data(bp, (const char *) op->dither.matrix,
+                                  size * size * sizeof(*op->dither.matrix));
+        }
+        PUT(op->dither.min);
+        PUT(op->dither.max);
+        PUT(op->dither.size_log2);
+        PUT(op->dither.y_offset);
+        return 0;
+    case SWS_OP_FILTER_H:
+    case SWS_OP_FILTER_V:
+        PUT(op->filter.type);
+        if (refs)
+            return put_ref(bp, refs, op->filter.kernel);
+        put_kernel(bp, op->filter.kernel);
+        return 0;
+    default:
+        /* 3DLUTs are owned by the caller and may be updated dynamically,
+         * so lists referencing them are never cached */
+        return AVERROR(ENOTSUP);
+    }
+}
+
+static int put_op_list(AVBPrint *bp, const SwsOpList *ops, const SwsOpList *refs)
+{
+    int ret;
+
+    PUT(ops->plane_src);
+    PUT(ops->plane_dst);
+    PUT(ops->num_ops);
+    for (int i = 0; i < ops->num_ops; i++) {
+        if ((ret = put_op(bp, &ops->ops[i], refs)) < 0)
+            return ret;
+    }
+
+    return av_bprint_is_complete(bp) ? 0 : AVERROR(ENOMEM);
+}
+
+/* Serialize everything the optimizer may depend on into `bp` */
+static int op_list_key(AVBPrint *bp, const SwsOpList *ops)
+{
+    put_format(bp, &ops->src);
+    put_format(bp, &ops->dst);
+    put_comps(bp, &ops->comps_src);
+    return put_op_list(bp, ops, NULL);
+}
+
+static void cache_entry_free(CacheEntry *entry)
+{
+    av_freep(&entry->key);
+    ff_sws_op_list_free(&entry->ops);
+}
+
+/* Must be called with cache_lock held; moves the found entry to the front */
+static CacheEntry *cache_find(const uint8_t *key, unsigned key_size, uint32_t crc)
+{
+    for (int i = 0; i < cache_size; i++) {
+        CacheEntry *entry = &cache[i];
+        if (entry->crc != crc || entry->key_size != key_size ||
+            memcmp(entry->key, key, key_size))
+            continue;
+
+        const CacheEntry found = *entry;
+        memmove(&cache[1], &cache[0], i * sizeof(*cache));
+        cache[0] = found;
+        return &cache[0];
+    }
+
+    return NULL;
+}
+
+/* Must be called with cache_lock held; takes over ownership of `entry` */
+static void cache_insert(CacheEntry *entry)
+{
+    if (cache_find(entry->key, entry->key_size, entry->crc)) {
+        /* Lost a race against another thread optimizing the same list */
+        cache_entry_free(entry);
+        return;
+    }
+
+    if (cache_size == CACHE_ENTRIES)
+        cache_entry_free(&cache[--cache_size]);
+    memmove(&cache[1], &cache[0], cache_size * sizeof(*cache));
+    cache[0] = *entry;
+    cache_size++;
+}
+
+/**
+ * On-disk cache, enabled by SwsContext.cache_dir. Each optimized list is
+ * stored in its own file, named after a SHA-256 digest of the library
+ * version and the list key, and written to a temporary file first, so that
+ * a directory may be shared between any number of processes.
+ *
+ * Filter kernels and dither matrices are not stored. They are referenced by
+ * the index of the op holding them in the unoptimized list, whose contents
+ * are guaranteed to match by the key.
+ *
+ * File layout, in native byte order like the key:
+ *   'FFSO' version:32 digest[32] payload size:32 payload crc:32
+ */
+enum {
+    DISK_VERSION     = 1,
+    DISK_DIGEST_SIZE = 32,
+    DISK_HEADER_SIZE = 4 + 4 + DISK_DIGEST_SIZE + 4,
+    DISK_MAX_SIZE    = 1 << 16,
+};
+
+#define DISK_TAG MKTAG('F','F','S','O')
+
+static int cache_digest(const AVBPrint *key, uint8_t digest[DISK_DIGEST_SIZE])
+{
+    const unsigned version = LIBSWSCALE_VERSION_INT;
+    const char *build = av_version_info();
+    struct AVSHA *sha = av_sha_alloc();
+    if (!sha)
+        return AVERROR(ENOMEM);
+
+    av_sha_init(sha, 256);
+    av_sha_update(sha, (const uint8_t *) build, strlen(build) + 1);
+    av_sha_update(sha, (const uint8_t *) &version, sizeof(version));
+    av_sha_update(sha, (const uint8_t *) key->str, key->len);
+    av_sha_final(sha, digest);
+    av_free(sha);
+    return 0;
+}
+
+static char *cache_path(const char *dir, const uint8_t digest[DISK_DIGEST_SIZE])
+{
+    char hex[2 * DISK_DIGEST_SIZE + 1];
+    for (int i = 0; i < DISK_DIGEST_SIZE; i++)
+        snprintf(&hex[2 * i], 3, "%02x", digest[i]);
+    return av_asprintf("%s/%s.ops", dir, hex);
+}
+
+typedef struct Reader {
+    const uint8_t *ptr, *end;
+} Reader;
+
+static int get_data(Reader *r, void *dst, size_t size)
+{
+    if ((size_t) (r->end - r->ptr) < size)
+        return AVERROR_INVALIDDATA;
+    memcpy(dst, r->ptr, size);
+    r->ptr += size;
+    return 0;
+}
+
+#define GET(x)                                                  \
+    do {                                                        \
+        if ((ret = get_data(r, &(x), sizeof(x))) < 0)           \
+            return ret;                                         \
+    } while (0)
+
+/* Resolve an index written by put_ref() to the op of `refs` it refers to */
+static int get_ref(Reader *r, const SwsOpList *refs, const SwsOp **ref)
+{
+    int32_t idx;
+    int ret;
+
+    GET(idx);
+    if (idx == -1) {
+        *ref = NULL;
+        return 0;
+    } else if (idx < 0 || idx >= refs->num_ops || !op_ref(&refs->ops[idx])) {
+        return AVERROR_INVALIDDATA;
+    }
+
+    *ref = &refs->ops[idx];
+    return 0;
+}
+
+static int valid_type(SwsPixelType type)
+{
+    return type != SWS_PIXEL_NONE && (unsigned) type < SWS_PIXEL_TYPE_NB;
+}
+
+/* Filtered values are always stored as floating point */
+static int valid_filter_type(SwsPixelType type)
+{
+    return valid_type(type) && !ff_sws_pixel_type_is_int(type);
+}
+
+/* Check that all denominators are positive, or zero for unset values */
+static int valid_q(const AVRational64 *q, int nb, int allow_unset)
+{
+    for (int i = 0; i < nb; i++) {
+        if (q[i].den < !allow_unset)
+            return 0;
+    }
+    return 1;
+}
+
+static int valid_kernel_ref(const SwsOp *ref)
+{
+    return ref && ref->op != SWS_OP_DITHER;
+}
+
+/**
+ * Read back an op written by put_op() with `refs` set, validating all
+ * fields. References are only taken once the op is known to be valid, so
+ * that nothing needs to be freed on failure.
+ */
+static int get_op(Reader *r, SwsOp *op, const SwsOpList *refs)
+{
+    const SwsOp *ref;
+    uint8_t expand;
+    int ret;
+
+    GET(op->op);
+    GET(op->type);
+    if (!valid_type(op->type))
+        return AVERROR_INVALIDDATA;
+
+    switch (op->op) {
+    case SWS_OP_READ:
+    case SWS_OP_WRITE:
+        GET(op->rw.mode);
+        GET(op->rw.elems);
+        GET(op->rw.frac);
+        GET(op->rw.filter.op);
+        GET(op->rw.filter.type);
+        if ((ret = get_ref(r, refs, &ref)) < 0)
+            return ret;
+        if ((unsigned) op->rw.mode > SWS_RW_PALETTE ||
+            !op->rw.elems || op->rw.elems > 4 || op->rw.frac > 3)
+            return AVERROR_INVALIDDATA;
+        if (op->rw.filter.op == SWS_OP_FILTER_H ||
+            op->rw.filter.op == SWS_OP_FILTER_V) {
+            if (op->op != SWS_OP_READ || !valid_kernel_ref(ref) ||
+                !valid_filter_type(op->rw.filter.type))
+                return AVERROR_INVALIDDATA;
+            op->rw.filter.kernel = av_refstruct_ref(op_ref(ref));
+        } else if (op->rw.filter.op || ref) {
+            return AVERROR_INVALIDDATA;
+        }
+        return 0;
+    case SWS_OP_SWAP_BYTES:
+        return 0;
+    case SWS_OP_SWIZZLE:
+        GET(op->swizzle.mask);
+        for (int i = 0; i < 4; i++) {
+            if (op->swizzle.in[i] >= 4)
+                return AVERROR_INVALIDDATA;
+        }
+        return 0;
+    case SWS_OP_UNPACK:
+    case SWS_OP_PACK:
+        GET(op->pack.pattern);
+        if (op->pack.pattern[0] + op->pack.pattern[1] +
+            op->pack.pattern[2] + op->pack.pattern[3] > 32)
+            return AVERROR_INVALIDDATA;
+        return 0;
+    case SWS_OP_LSHIFT:
+    case SWS_OP_RSHIFT:
+        GET(op->shift.amount);
+        return op->shift.amount < 32 ? 0 : AVERROR_INVALIDDATA;
+    case SWS_OP_CLEAR:
+        GET(op->clear.mask);
+        GET(op->clear.value);
+        return valid_q(op->clear.value, 4, 1) ? 0 : AVERROR_INVALIDDATA;
+    case SWS_OP_CONVERT:
+        GET(op->convert.to);
+        GET(expand);
+        if (!valid_type(op->convert.to) || expand > 1)
+            return AVERROR_INVALIDDATA;
+        op->convert.expand = expand;
+        return 0;
+    case SWS_OP_MIN:
+    case SWS_OP_MAX:
+        GET(op->clamp.limit);
+        return valid_q(op->clamp.limit, 4, 1) ? 0 : AVERROR_INVALIDDATA;
+    case SWS_OP_SCALE:
+        GET(op->scale.factor);
+        return valid_q(&op->scale.factor, 1, 0) ? 0 : AVERROR_INVALIDDATA;
+    case SWS_OP_LINEAR:
+        GET(op->lin.m);
+        return valid_q(&op->lin.m[0][0], 4 * 5, 0) ? 0 : AVERROR_INVALIDDATA;
+    case SWS_OP_DITHER:
+        if ((ret = get_ref(r, refs, &ref)) < 0)
+            return ret;
+        GET(op->dither.min);
+        GET(op->dither.max);
+        GET(op->dither.size_log2);
+        GET(op->dither.y_offset);
+        if (!ref || ref->op != SWS_OP_DITHER ||
+            !valid_q(&op->dither.min, 1, 0) || !valid_q(&op->dither.max, 1, 0) ||
+            ref->dither.size_log2 != op->dither.size_log2)
+            return AVERROR_INVALIDDATA;
+        op->dither.matrix = av_refstruct_ref(ref->dither.matrix);
+        return 0;
+    case SWS_OP_FILTER_H:
+    case SWS_OP_FILTER_V:
+        GET(op->filter.type);
+        if ((ret = get_ref(r, refs, &ref)) < 0)
+            return ret;
+        if (!valid_filter_type(op->filter.type) || !valid_kernel_ref(ref))
+            return AVERROR_INVALIDDATA;
+        op->filter.kernel = av_refstruct_ref(op_ref(ref));
+        return 0;
+    default:
+        return AVERROR_INVALIDDATA;
+    }
+}
+
+/* Mask of the planes accessed by a read or write op */
+static unsigned rw_planes(const SwsOp *op, const uint8_t planes[4])
+{
+    unsigned mask = 0;
+    if (op) {
+        for (int i = 0; i < ff_sws_rw_op_planes(op); i++)
+            mask |= 1 << planes[i];
+    }
+    return mask;
+}
+
+/* Read back a list written by put_op_list() with `refs` set */
+static int get_op_list(Reader *r, SwsOpList *ops, const SwsOpList *refs)
+{
+    int num_ops, ret;
+
+    /* Not touched by the optimizer */
+    ops->src = refs->src;
+    ops->dst = refs->dst;
+    ops->comps_src = refs->comps_src;
+
+    GET(ops->plane_src);
+    GET(ops->plane_dst);
+    GET(num_ops);
+
+    for (int i = 0; i < 4; i++) {
+        if (ops->plane_src[i] >= 4 || ops->plane_dst[i] >= 4)
+            return AVERROR_INVALIDDATA;
+    }
+
+    for (int i = 0; i < num_ops; i++) {
+        SwsOp op = {0};
+        if ((ret = get_op(r, &op, refs)) < 0)
+            return ret;
+        if ((ret = ff_sws_op_list_append(ops, &op)) < 0)
+            return ret;
+        if ((op.op == SWS_OP_READ  && i != 0) ||
+            (op.op == SWS_OP_WRITE && i != num_ops - 1))
+            return AVERROR_INVALIDDATA;
+    }
+
+    /* The optimizer may drop or reorder planes, but never adds new ones */
+    const SwsOp *read  = ff_sws_op_list_input(ops);
+    const SwsOp *write = ff_sws_op_list_output(ops);
+    if (r->ptr != r->end || !write ||
+        rw_planes(read,  ops->plane_src) & ~rw_planes(ff_sws_op_list_input(refs),  refs->plane_src) ||
+        rw_planes(write, ops->plane_dst) & ~rw_planes(ff_sws_op_list_output(refs), refs->plane_dst))
+        return AVERROR_INVALIDDATA;
+
+    ff_sws_op_list_update_comps(ops);
+    return 0;
+}
+
+/**
+ * Load the optimized version of `orig` from `path`. Returns AVERROR(ENOENT)
+ * if it is not cached yet.
+ */
+static int disk_load(const char *path, const uint8_t digest[DISK_DIGEST_SIZE],
+                     const SwsOpList *orig, SwsOpList **pops)
+{
+    const AVCRC *crc_table = av_crc_get_table(AV_CRC_32_IEEE_LE);
+    uint8_t header[DISK_HEADER_SIZE], *buf = NULL;
+    SwsOpList *ops = NULL;
+    uint32_t size, crc;
+    int ret;
+
+    FILE *f = avpriv_fopen_utf8(path, "rb");
+    if (!f)
+        return AVERROR(errno);
+
+    if (fread(header, sizeof(header), 1, f) != 1 ||
+        AV_RN32(header) != DISK_TAG || AV_RN32(header + 4) != DISK_VERSION ||
+        memcmp(header + 8, digest, DISK_DIGEST_SIZE)) {
+        ret = AVERROR_INVALIDDATA;
+        goto end;
+    }
+
+    size = AV_RN32(header + 8 + DISK_DIGEST_SIZE);
+    if (size > DISK_MAX_SIZE) {
+        ret = AVERROR_INVALIDDATA;
+        goto end;
+    }
+
+    buf = av_malloc(size + 4);
+    if (!buf) {
+        ret = AVERROR(ENOMEM);
+        goto end;
+    }
+
+    crc = av_crc(crc_table, 0, header, sizeof(header));
+    if (fread(buf, size + 4, 1, f) != 1 || fgetc(f) != EOF ||
+        av_crc(crc_table, crc, buf, size) != AV_RN32(buf + size)) {
+        ret = AVERROR_INVALIDDATA;
+        goto end;
+    }
+
+    ops = ff_sws_op_list_alloc();
+    if (!ops) {
+        ret = AVERROR(ENOMEM);
+        goto end;
+    }
+
+    ret = get_op_list(&(Reader) { buf, buf + size }, ops, orig);
+    if (ret < 0)
+        goto end;
+
+    *pops = ops;
+    ops = NULL;
+
+end:
+    ff_sws_op_list_free(&ops);
+    av_free(buf);
+    fclose(f);
+    return ret;
+}
+
+/**
+ * Store `ops`, the optimized version of `orig`, in `path`. Returns
+ * AVERROR(ENOTSUP) if the list can not be cached.
+ */
+static int disk_save(const char *path, const uint8_t digest[DISK_DIGEST_SIZE],
+                     const SwsOpList *orig, const SwsOpList *ops)
+{
+    const uint32_t tag = DISK_TAG, version = DISK_VERSION;
+    uint32_t size = 0, crc;
+    AVBPrint buf, *bp = &buf;
+    char *tmp = NULL;
+    int ret;
+
+    av_bprint_init(bp, 0, AV_BPRINT_SIZE_UNLIMITED);
+    PUT(tag);
+    PUT(version);
+    av_bprint_append_data(bp, digest, DISK_DIGEST_SIZE);
+    PUT(size);
+    ret = put_op_list(bp, ops, orig);
+    if (ret < 0)
+        goto end;
+
+    size = bp->len - DISK_HEADER_SIZE;
+    if (size > DISK_MAX_SIZE) {
+        ret = AVERROR(ENOTSUP);
+        goto end;
+    }
+
+    AV_WN32(bp->str + DISK_HEADER_SIZE - 4, size);
+    crc = av_crc(av_crc_get_table(AV_CRC_32_IEEE_LE), 0,
+                 (const uint8_t *) bp->str, bp->len);
+    PUT(crc);
+
+    tmp = av_asprintf("%s.%08"PRIx32".tmp", path, av_get_random_seed());
+    if (!av_bprint_is_complete(bp) || !tmp) {
+        ret = AVERROR(ENOMEM);
+        goto end;
+    }
+
+    FILE *f = avpriv_fopen_utf8(tmp, "wb");
+    if (!f) {
+        ret = AVERROR(errno);
+        goto end;
+    }
+
+    const int written = fwrite(bp->str, bp->len, 1, f) == 1;
+    if (fclose(f) || !written) {
+        ret = AVERROR(EIO);
+        remove(tmp);
+    } else if (rename(tmp, path)) {
+        /* Another process may have stored the same list in the meantime */
+        ret = errno == EEXIST ? 0 : AVERROR(errno);
+        remove(tmp);
+    }
+
+end:
+    av_bprint_finalize(bp, NULL);
+    av_free(tmp);
+    return ret;
+}
+
+int ff_sws_op_list_optimize_cached(SwsContext *ctx, SwsOpList **pops)
+{
+    SwsOpList *ops = *pops, *orig = NULL;
+    uint8_t digest[DISK_DIGEST_SIZE];
+    CacheEntry entry = {0};
+    char *path = NULL;
+    AVBPrint bp;
+    int ret;
+
+    av_bprint_init(&bp, 0, AV_BPRINT_SIZE_UNLIMITED);
+    if (op_list_key(&bp, ops) < 0) {
+        av_bprint_finalize(&bp, NULL);
+        return ff_sws_op_list_optimize(ops);
+    }
+
+    entry.key_size = bp.len;
+    entry.crc = av_crc(av_crc_get_table(AV_CRC_32_IEEE_LE), 0,
+                       (const uint8_t *) bp.str, bp.len);
+
+    ff_mutex_lock(&cache_lock);
+    const CacheEntry *found = cache_find((const uint8_t *) bp.str, bp.len, entry.crc);
+    SwsOpList *copy = found ? ff_sws_op_list_duplicate(found->ops) : NULL;
+    ff_mutex_unlock(&cache_lock);
+    if (copy) {
+        av_bprint_finalize(&bp, NULL);
+        ff_sws_op_list_free(pops);
+        *pops = copy;
+        return 0;
+    }
+
+    if (ctx->cache_dir && cache_digest(&bp, digest) >= 0)
+        path = cache_path(ctx->cache_dir, digest);
+    /* Failing to cache the result is not an error, leaves entry.key unset */
+    av_bprint_finalize(&bp, (char **) &entry.key);
+
+    if (path) {
+        SwsOpList *loaded;
+        ret = disk_load(path, digest, ops, &loaded);
+        if (ret >= 0) {
+            av_log(ctx, AV_LOG_DEBUG, "Loaded operation list from '%s'\n", path);
+            ff_sws_op_list_free(pops);
+            *pops = ops = loaded;
+            goto done;
+        } else if (ret != AVERROR(ENOENT)) {
+            av_log(ctx, AV_LOG_WARNING, "Ignoring operation list cache '%s': %s\n",
+                   path, av_err2str(ret));
+        }
+
+        /* Needed to resolve the kernels referenced by the optimized list */
+        orig = ff_sws_op_list_duplicate(ops);
+    }
+
+    ret = ff_sws_op_list_optimize(ops);
+    if (ret < 0) {
+        cache_entry_free(&entry);
+        goto end;
+    }
+
+    if (orig) {
+        ret = disk_save(path, digest, orig, ops);
+        if (ret < 0 && ret != AVERROR(ENOTSUP)) {
+            av_log(ctx, AV_LOG_WARNING, "Failed writing operation list cache '%s': %s\n",
+                   path, av_err2str(ret));
+        }
+    }
+
+done:
+    entry.ops = entry.key ? ff_sws_op_list_duplicate(ops) : NULL;
+    if (entry.ops) {
+        ff_mutex_lock(&cache_lock);
+        cache_insert(&entry);
+        ff_mutex_unlock(&cache_lock);
+    } else {
+        cache_entry_free(&entry);
+    }
+    ret = 0;
+
+end:
+    ff_sws_op_list_free(&orig);
+    av_free(path);
+    return ret;
+}
@@ -60,6 +60,7 @@ typedef struct SwsOpPass {
     size_t tail_blocks;
     uint8_t *tail_buf; /* extra memory for fixing unpadded tails */
     unsigned int tail_buf_size;
+    SwsOpList *ops; /* final op list, for introspection */
 } SwsOpPass;
 
 static int compile_backend(SwsContext *ctx, const SwsOpBackend *backend,
@@ -144,6 +145,7 @@ static void op_pass_free(void *ptr)
     av_free(p->exec_base.in_bump_y);
     av_free(p->exec_base.in_offset_x);
     av_free(p->tail_buf);
+    ff_sws_op_list_free(&p->ops);
     av_free(p);
 }
 
@@ -684,6 +686,14 @@ static int compile_single(const CompileArgs *args, const SwsOpList *ops,
         p->filter_size_h = filter->filter_size;
     }
 
+    if (args->flags & SWS_OP_FLAG_KEEP_OPS) {
+        p->ops = ff_sws_op_list_duplicate(ops);
+        if (!p->ops) {
+            ret = AVERROR(ENOMEM);
+            goto fail;
+        }
+    }
+
     ret = ff_sws_graph_add_pass(graph, dst->format, dst->width, dst->height,
                                 input, 0, comp->slice_align, op_pass_run,
                                 op_pass_setup, p, op_pass_free, output);
@@ -691,6 +701,15 @@ static int compile_single(const CompileArgs *args, const SwsOpList *ops,
         return ret;
 
     (*output)->backend = comp->backend->flags;
+    if (p->offsets_y) {
+        int sub_y = 0;
+        for (int i = 0; i < p->planes_in; i++)
+            sub_y = FFMAX(sub_y, p->exec_base.in_sub_y[i]);
+        (*output)->row_offsets = p->offsets_y;
+        (*output)->row_taps    = filter->filter_size << sub_y;
+    } else {
+        (*output)->row_local = true;
+    }
     op_list_get_plane_copy(ops, *output);
     ff_sws_pass_link_output(*output, link);
     align_pass(*output, comp->block_size, comp->over_write, p->pixel_bits_out);
@@ -751,7 +770,8 @@ static int compile_subpass(const CompileArgs *args, SwsOpList **pops,
     for (int idx = 1; idx < ops->num_ops - 1; idx++) {
         const SwsOp *op = &ops->ops[idx];
         if (op->op == SWS_OP_FILTER_H || op->op == SWS_OP_FILTER_V) {
-            RET(ff_sws_op_list_split_at(ops, &rest, idx));
+            RET(ff_sws_op_list_split_at(ops, &rest, idx,
+                                        ctx->flags & SWS_HALF_FLOAT));
             if (ff_sws_op_list_is_noop(ops)) {
                 /* Prevent infinite recursion by avoiding splitting in a way
                  * that does not meaningfully reduce the number of operations
@@ -778,6 +798,15 @@ fail:
     return ret;
 }
 
+const SwsOpList *ff_sws_pass_op_list(const SwsPass *pass)
+{
+    if (pass->run != op_pass_run)
+        return NULL;
+
+    const SwsOpPass *p = pass->priv;
+    return p->ops;
+}
+
 int ff_sws_compile_pass(SwsGraph *graph, const SwsOpBackend *backend,
                         SwsOpList **pops, int flags, SwsPass *input,
                         SwsPass **output)
@@ -795,7 +824,7 @@ int ff_sws_compile_pass(SwsGraph *graph, const SwsOpBackend *backend,
     }
 
     if (flags & SWS_OP_FLAG_OPTIMIZE) {
-        ret = ff_sws_op_list_optimize(ops);
+        ret = ff_sws_op_list_optimize_cached(ctx, &ops);
         if (ret < 0)
             goto out;
         av_log(ctx, AV_LOG_DEBUG, "Operation list after optimizing:\n");
@@ -176,6 +176,9 @@ enum SwsOpCompileFlags {
 
     /* Split off copied/cleared planes into separate subpasses */
     SWS_OP_FLAG_SPLIT_MEMCPY = 1 << 2,
+
+    /* Keep a copy of the op list in the pass, see ff_sws_pass_op_list() */
+    SWS_OP_FLAG_KEEP_OPS = 1 << 3,
 };
 
 /**
@@ -193,4 +196,12 @@ int ff_sws_compile_pass(SwsGraph *graph, const SwsOpBackend *backend,
                         SwsOpList **ops, int flags, SwsPass *input,
                         SwsPass **output);
 
+/**
+ * Returns the final operation list that was compiled into `pass`, or NULL
+ * if the pass was not created by ff_sws_compile_pass() with
+ * SWS_OP_FLAG_KEEP_OPS (or uses an opaque backend). Intended for profiling
+ * and debugging tools.
+ */
+const SwsOpList *ff_sws_pass_op_list(const SwsPass *pass);
+
 #endif /* SWSCALE_OPS_DISPATCH_H */
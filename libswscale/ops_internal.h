@@ -64,10 +64,13 @@ static inline void ff_sws_pack_op_decode(const SwsOp *op, uint64_t mask[4], int
  * @param index The index of the operation to split before. The operation
  *              itself will be absent from `ops1` and instead moved to the
  *              start of `ops2`.
+ * @param half_float Store the intermediate as SWS_PIXEL_F16 instead of
+ *                   SWS_PIXEL_F32, if all of its values fit.
  *
  * Returnse 0 or a negative error code.
  */
-int ff_sws_op_list_split_at(SwsOpList *ops1, SwsOpList **ops2, int index);
+int ff_sws_op_list_split_at(SwsOpList *ops1, SwsOpList **ops2, int index,
+                            bool half_float);
 
 /**
  * Reduce an op list into a reduced subset that operates only on a given
@@ -87,6 +87,20 @@ static bool op_commute_clear(SwsOp *op, SwsOp *next)
     return false;
 }
 
+/**
+ * Half floats are only ever converted to and from F32, and rounding through
+ * them is lossy, so only the (exact) F16 -> F32 -> F16 round trip may be
+ * merged into a single conversion.
+ */
+static bool convert_is_transitive(const SwsOp *op, const SwsOp *next)
+{
+    if (op->convert.to == SWS_PIXEL_F16)
+        return false;
+    if (op->type == SWS_PIXEL_F16 || next->convert.to == SWS_PIXEL_F16)
+        return op->type == next->convert.to;
+    return true;
+}
+
  /**
   * Try to commute a swizzle op with the next operation. Makes any adjustments
   * to the operations as needed, but does not perform the actual commutation.
@@ -556,7 +570,8 @@ retry:
 
             /* Transitive conversion */
             if (next->op == SWS_OP_CONVERT &&
-                op->convert.expand == next->convert.expand)
+                op->convert.expand == next->convert.expand &&
+                convert_is_transitive(op, next))
             {
                 av_assert1(op->convert.to == next->type);
                 op->convert.to = next->convert.to;
@@ -1066,6 +1081,15 @@ retry:
  */
 static enum AVPixelFormat get_planar_fmt(SwsPixelType type, int nb_planes)
 {
+    if (type == SWS_PIXEL_F16) {
+        switch (nb_planes) {
+        case 1: return AV_PIX_FMT_GRAYF16;
+        case 2: return AV_PIX_FMT_GBRPF16; // FIXME: no 2-plane planar fmt
+        case 3: return AV_PIX_FMT_GBRPF16;
+        case 4: return AV_PIX_FMT_GBRAPF16;
+        }
+    }
+
     switch (ff_sws_pixel_type_size(type)) {
     case 1:
         switch (nb_planes) {
@@ -1110,7 +1134,24 @@ static void get_input_size(const SwsOpList *ops, SwsFormat *fmt)
     }
 }
 
-int ff_sws_op_list_split_at(SwsOpList *ops1, SwsOpList **out_ops2, int index)
+/* Whether all needed output values of `op` are known to fit into a half float */
+static bool fits_f16(const SwsOp *op)
+{
+    const AVRational64 max = { 65504, 1 }, min = { -65504, 1 };
+    for (int i = 0; i < 4; i++) {
+        if (!SWS_OP_NEEDED(op, i))
+            continue;
+        if (!op->comps.min[i].den || !op->comps.max[i].den ||
+            av_cmp_q64(op->comps.min[i], min) < 0 ||
+            av_cmp_q64(op->comps.max[i], max) > 0)
+            return false;
+    }
+
+    return true;
+}
+
+int ff_sws_op_list_split_at(SwsOpList *ops1, SwsOpList **out_ops2, int index,
+                            bool half_float)
 {
     int ret;
     if (index <= 0 || index >= ops1->num_ops) {
@@ -1143,7 +1184,11 @@ int ff_sws_op_list_split_at(SwsOpList *ops1, SwsOpList **out_ops2, int index)
 
     /* Determine metadata for the intermediate format */
     const SwsPixelType type = op->type;
-    ops2->src.format = get_planar_fmt(type, nb_planes);
+    SwsPixelType storage = type;
+    if (half_float && type == SWS_PIXEL_F32 && fits_f16(prev))
+        storage = SWS_PIXEL_F16;
+
+    ops2->src.format = get_planar_fmt(storage, nb_planes);
     ops2->src.desc = av_pix_fmt_desc_get(ops2->src.format);
     get_input_size(ops1, &ops2->src);
     ops1->dst = ops2->src;
@@ -1170,9 +1215,19 @@ int ff_sws_op_list_split_at(SwsOpList *ops1, SwsOpList **out_ops2, int index)
             goto fail;
     }
 
+    if (storage != type) {
+        ret = ff_sws_op_list_append(ops1, &(SwsOp) {
+            .op         = SWS_OP_CONVERT,
+            .type       = type,
+            .convert.to = storage,
+        });
+        if (ret < 0)
+            goto fail;
+    }
+
     ret = ff_sws_op_list_append(ops1, &(SwsOp) {
         .op       = SWS_OP_WRITE,
-        .type     = type,
+        .type     = storage,
         .rw.elems = nb_planes,
     });
     if (ret < 0)
@@ -1180,7 +1235,7 @@ int ff_sws_op_list_split_at(SwsOpList *ops1, SwsOpList **out_ops2, int index)
 
     ret = ff_sws_op_list_insert_at(ops2, 0, &(SwsOp) {
         .op        = SWS_OP_READ,
-        .type      = type,
+        .type      = storage,
         .rw.elems  = nb_planes,
     });
     if (ret < 0)
@@ -1196,6 +1251,16 @@ int ff_sws_op_list_split_at(SwsOpList *ops1, SwsOpList **out_ops2, int index)
             goto fail;
     }
 
+    if (storage != type) {
+        ret = ff_sws_op_list_insert_at(ops2, 1, &(SwsOp) {
+            .op         = SWS_OP_CONVERT,
+            .type       = storage,
+            .convert.to = type,
+        });
+        if (ret < 0)
+            goto fail;
+    }
+
     ret = ff_sws_op_list_optimize(ops1);
     if (ret < 0)
         goto fail;
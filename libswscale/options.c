@@ -52,6 +52,7 @@ static const AVOption swscale_options[] = {
         { "error_diffusion", "error diffusion dither",        0,  AV_OPT_TYPE_CONST, { .i64 = SWS_ERROR_DIFFUSION}, .flags = VE, .unit = "sws_flags" },
         { "unstable",        "allow experimental new code",   0,  AV_OPT_TYPE_CONST, { .i64 = SWS_UNSTABLE       }, .flags = VE, .unit = "sws_flags" },
         { "strict",          "require all metadata to be set",0,  AV_OPT_TYPE_CONST, { .i64 = SWS_STRICT         }, .flags = VE, .unit = "sws_flags" },
+        { "half_float",      "half float intermediates",      0,  AV_OPT_TYPE_CONST, { .i64 = SWS_HALF_FLOAT     }, .flags = VE, .unit = "sws_flags" },
 
     { "scaler",          "set scaling algorithm",         OFFSET(scaler),       AV_OPT_TYPE_INT,    { .i64 = SWS_SCALE_AUTO     }, .flags = VE, .unit = "sws_scaler", .max = SWS_SCALE_NB - 1 },
     { "scaler_sub",      "set subsampling algorithm",     OFFSET(scaler_sub),   AV_OPT_TYPE_INT,    { .i64 = SWS_SCALE_AUTO     }, .flags = VE, .unit = "sws_scaler", .max = SWS_SCALE_NB - 1 },
@@ -118,6 +119,8 @@ static const AVOption swscale_options[] = {
         { "aarch64",     "AArch64 NEON kernels",          0,                 AV_OPT_TYPE_CONST,  { .i64  = SWS_BACKEND_AARCH64  }, .flags = VE, .unit = "sws_backend" },
         { "spirv",       "Vulkan SPIR-V backend",         0,                 AV_OPT_TYPE_CONST,  { .i64  = SWS_BACKEND_SPIRV    }, .flags = VE, .unit = "sws_backend" },
 
+    { "sws_cache_dir",   "directory to cache optimized operation lists in", OFFSET(cache_dir), AV_OPT_TYPE_STRING, { .str = NULL }, .flags = VE },
+
     { NULL }
 };
 
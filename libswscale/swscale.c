@@ -30,6 +30,7 @@
 #include "libavutil/intreadwrite.h"
 #include "libavutil/mem.h"
 #include "libavutil/mem_internal.h"
+#include "libavutil/opt.h"
 #include "libavutil/pixdesc.h"
 #include "libavutil/hwcontext.h"
 #include "config.h"
@@ -1497,48 +1498,18 @@ static int validate_params(SwsContext *ctx)
     return 0;
 }
 
-int sws_frame_setup(SwsContext *ctx, const AVFrame *dst, const AVFrame *src)
+/**
+ * (Re)initialize the pair of per-field graphs converting `src` to `dst`. If
+ * `dst_width` is not NULL, it is updated to the minimum required width of the
+ * output buffers.
+ */
+static int setup_graphs(SwsContext *ctx, SwsGraph *graphs[2], const AVFrame *dst,
+                        const AVFrame *src, int *dst_width)
 {
-    SwsInternal *s = sws_internal(ctx);
+    const SwsBackend backends = ff_sws_enabled_backends(ctx);
     const char *err_msg;
     int ret;
 
-    if (!src || !dst)
-        return AVERROR(EINVAL);
-    if ((ret = validate_params(ctx)) < 0)
-        return ret;
-
-    /* For now, if a single frame has a context, then both need a context */
-    if (!!src->hw_frames_ctx != !!dst->hw_frames_ctx) {
-        return AVERROR(ENOTSUP);
-    } else if (!!src->hw_frames_ctx) {
-        /* Both hardware frames must already be allocated */
-        if (!src->data[0] || !dst->data[0])
-            return AVERROR(EINVAL);
-
-        AVHWFramesContext *src_hwfc, *dst_hwfc;
-        src_hwfc = (AVHWFramesContext *)src->hw_frames_ctx->data;
-        dst_hwfc = (AVHWFramesContext *)dst->hw_frames_ctx->data;
-
-        /* Both frames must live on the same device */
-        if (src_hwfc->device_ref->data != dst_hwfc->device_ref->data)
-            return AVERROR(EINVAL);
-
-        /* Only Vulkan devices are supported */
-        AVHWDeviceContext *dev_ctx;
-        dev_ctx = (AVHWDeviceContext *)src_hwfc->device_ref->data;
-        if (dev_ctx->type != AV_HWDEVICE_TYPE_VULKAN)
-            return AVERROR(ENOTSUP);
-
-#if CONFIG_UNSTABLE && CONFIG_VULKAN
-        ret = ff_sws_vk_init(ctx, src_hwfc->device_ref);
-        if (ret < 0)
-            return ret;
-#endif
-    }
-
-    int dst_width = dst->width;
-    const SwsBackend backends = ff_sws_enabled_backends(ctx);
     for (int field = 0; field < 2; field++) {
         SwsFormat src_fmt = ff_fmt_from_frame(src, field);
         SwsFormat dst_fmt = ff_fmt_from_frame(dst, field);
@@ -1558,37 +1529,37 @@ int sws_frame_setup(SwsContext *ctx, const AVFrame *dst, const AVFrame *src)
             goto fail;
         }
 
-        if (!s->graph[field]) {
-            s->graph[field] = ff_sws_graph_alloc();
-            if (!s->graph[field]) {
+        if (!graphs[field]) {
+            graphs[field] = ff_sws_graph_alloc();
+            if (!graphs[field]) {
                 err_msg = "Failed allocating scaling graph";
                 ret = AVERROR(ENOMEM);
                 goto fail;
             }
         }
 
-        ret = ff_sws_graph_reinit(s->graph[field], ctx, &dst_fmt, &src_fmt);
+        ret = ff_sws_graph_reinit(graphs[field], ctx, &dst_fmt, &src_fmt);
         if (ret < 0) {
             err_msg = "Failed initializing scaling graph";
             goto fail;
         }
 
-        const SwsGraph *graph = s->graph[field];
+        const SwsGraph *graph = graphs[field];
         if (graph->incomplete && ctx->flags & SWS_STRICT) {
             err_msg = "Incomplete scaling graph";
             ret = AVERROR(EINVAL);
             goto fail;
         }
 
-        if (!graph->noop) {
+        if (!graph->noop && dst_width) {
             av_assert0(graph->num_passes);
             const SwsPass *last_pass = graph->passes[graph->num_passes - 1];
             const int aligned_w = ff_sws_pass_aligned_width(last_pass, dst->width);
-            dst_width = FFMAX(dst_width, aligned_w);
+            *dst_width = FFMAX(*dst_width, aligned_w);
         }
 
         if (!src_fmt.interlaced) {
-            ff_sws_graph_free(&s->graph[FIELD_BOTTOM]);
+            ff_sws_graph_free(&graphs[FIELD_BOTTOM]);
             break;
         }
 
@@ -1603,12 +1574,58 @@ int sws_frame_setup(SwsContext *ctx, const AVFrame *dst, const AVFrame *src)
                av_get_pix_fmt_name(dst_fmt.format), av_color_space_name(dst_fmt.csp),
                av_color_primaries_name(dst_fmt.color.prim), av_color_transfer_name(dst_fmt.color.trc));
 
-        for (int i = 0; i < FF_ARRAY_ELEMS(s->graph); i++)
-            ff_sws_graph_free(&s->graph[i]);
+        ff_sws_graph_free(&graphs[FIELD_TOP]);
+        ff_sws_graph_free(&graphs[FIELD_BOTTOM]);
+        return ret;
+    }
+
+    return 0;
+}
 
+int sws_frame_setup(SwsContext *ctx, const AVFrame *dst, const AVFrame *src)
+{
+    SwsInternal *s = sws_internal(ctx);
+    int ret;
+
+    if (!src || !dst)
+        return AVERROR(EINVAL);
+    if ((ret = validate_params(ctx)) < 0)
         return ret;
+
+    /* For now, if a single frame has a context, then both need a context */
+    if (!!src->hw_frames_ctx != !!dst->hw_frames_ctx) {
+        return AVERROR(ENOTSUP);
+    } else if (!!src->hw_frames_ctx) {
+        /* Both hardware frames must already be allocated */
+        if (!src->data[0] || !dst->data[0])
+            return AVERROR(EINVAL);
+
+        AVHWFramesContext *src_hwfc, *dst_hwfc;
+        src_hwfc = (AVHWFramesContext *)src->hw_frames_ctx->data;
+        dst_hwfc = (AVHWFramesContext *)dst->hw_frames_ctx->data;
+
+        /* Both frames must live on the same device */
+        if (src_hwfc->device_ref->data != dst_hwfc->device_ref->data)
+            return AVERROR(EINVAL);
+
+        /* Only Vulkan devices are supported */
+        AVHWDeviceContext *dev_ctx;
+        dev_ctx = (AVHWDeviceContext *)src_hwfc->device_ref->data;
+        if (dev_ctx->type != AV_HWDEVICE_TYPE_VULKAN)
+            return AVERROR(ENOTSUP);
+
+#if CONFIG_UNSTABLE && CONFIG_VULKAN
+        ret = ff_sws_vk_init(ctx, src_hwfc->device_ref);
+        if (ret < 0)
+            return ret;
+#endif
     }
 
+    int dst_width = dst->width;
+    ret = setup_graphs(ctx, s->graph, dst, src, &dst_width);
+    if (ret < 0)
+        return ret;
+
     if (!dst->hw_frames_ctx) {
         ret = ff_frame_pool_video_reinit(&s->frame_pool, dst_width, dst->height,
                                          dst->format, av_cpu_max_align());
@@ -1619,6 +1636,208 @@ int sws_frame_setup(SwsContext *ctx, const AVFrame *dst, const AVFrame *src)
     return 0;
 }
 
+/* Returns whether `out` can be produced by scaling `in`, i.e. whether the two
+ * frames only differ in their dimensions, with `in` being at least as large */
+static int can_cascade(const AVFrame *out, const AVFrame *in)
+{
+    if (in->format != out->format || in->width < out->width ||
+        in->height < out->height)
+        return 0;
+
+    for (int field = 0; field < 2; field++) {
+        SwsFormat in_fmt  = ff_fmt_from_frame(in,  field);
+        SwsFormat out_fmt = ff_fmt_from_frame(out, field);
+        in_fmt.width  = out_fmt.width;
+        in_fmt.height = out_fmt.height;
+        if (!ff_fmt_equal(&in_fmt, &out_fmt))
+            return 0;
+    }
+
+    return 1;
+}
+
+int sws_scale_frame_multi(SwsContext *sws, AVFrame *const dst[], int nb_dst,
+                          const AVFrame *src)
+{
+    SwsInternal *c = sws_internal(sws);
+    int ret;
+
+    if (!src || !dst || nb_dst <= 0)
+        return AVERROR(EINVAL);
+    if (c->is_legacy_init || src->hw_frames_ctx)
+        return AVERROR(ENOTSUP);
+    if ((ret = validate_params(sws)) < 0)
+        return ret;
+
+    if (nb_dst > c->nb_multi) {
+        SwsMultiOutput *multi = av_realloc_array(c->multi, nb_dst, sizeof(*multi));
+        if (!multi)
+            return AVERROR(ENOMEM);
+        memset(&multi[c->nb_multi], 0, (nb_dst - c->nb_multi) * sizeof(*multi));
+        c->multi    = multi;
+        c->nb_multi = nb_dst;
+    }
+
+    for (int i = 0; i < nb_dst; i++) {
+        if (!dst[i] || dst[i]->hw_frames_ctx)
+            return AVERROR(EINVAL);
+        c->multi[i].done = 0;
+    }
+
+    /* Generate the outputs in order of decreasing size, so that each output
+     * can be downscaled from the smallest larger output that was already
+     * generated, rather than from the (larger) source frame */
+    for (int n = 0; n < nb_dst; n++) {
+        int idx = -1, src_idx = -1;
+        for (int i = 0; i < nb_dst; i++) {
+            if (c->multi[i].done)
+                continue;
+            if (idx < 0 || (int64_t) dst[i]->width * dst[i]->height >
+                           (int64_t) dst[idx]->width * dst[idx]->height)
+                idx = i;
+        }
+
+        AVFrame *out = dst[idx];
+        for (int i = 0; i < nb_dst; i++) {
+            if (!c->multi[i].done || !can_cascade(out, dst[i]))
+                continue;
+            if (src_idx < 0 || (int64_t) dst[i]->width * dst[i]->height <
+                               (int64_t) dst[src_idx]->width * dst[src_idx]->height)
+                src_idx = i;
+        }
+
+        const AVFrame *in = src_idx >= 0 ? dst[src_idx] : src;
+        SwsGraph **graphs = c->multi[idx].graph;
+        ret = setup_graphs(sws, graphs, out, in, NULL);
+        if (ret < 0)
+            return ret;
+
+        if (!out->data[0]) {
+            ret = av_frame_get_buffer(out, 0);
+            if (ret < 0)
+                return ret;
+        }
+
+        for (int field = 0; field < (graphs[FIELD_BOTTOM] ? 2 : 1); field++) {
+            ret = ff_sws_graph_run(graphs[field], out, in);
+            if (ret < 0)
+                return ret;
+        }
+
+        c->multi[idx].done = 1;
+    }
+
+    return 0;
+}
+
+static int batch_worker(void *priv, int jobnr, int threadnr, int nb_jobs,
+                        int nb_threads)
+{
+    SwsInternal *c = priv;
+    int ret = sws_scale_frame(c->batch_ctx[threadnr], c->batch_dst[jobnr],
+                              c->batch_src[jobnr]);
+    return ret < 0 ? ret : 0; /* avpriv_slicethread_execute2() aborts on non-zero */
+}
+
+static void batch_uninit(SwsInternal *c)
+{
+    avpriv_slicethread_free(&c->batch_thread);
+    for (int i = 0; i < c->nb_batch_ctx; i++)
+        sws_freeContext(c->batch_ctx[i]);
+    av_freep(&c->batch_ctx);
+    c->nb_batch_ctx = 0;
+}
+
+/**
+ * (Re)create the frame threading context and the per-thread child contexts,
+ * and synchronize their options with `sws`. Returns the number of threads.
+ */
+static int batch_init(SwsContext *sws)
+{
+    SwsInternal *c = sws_internal(sws);
+    int ret;
+
+    if (!c->batch_thread || c->batch_threads != sws->threads) {
+        batch_uninit(c);
+        ret = avpriv_slicethread_create2(&c->batch_thread, (void *) c,
+                                         batch_worker, NULL, sws->threads);
+        if (ret < 0)
+            return ret;
+        c->batch_threads = sws->threads;
+
+        c->batch_ctx = av_calloc(ret, sizeof(*c->batch_ctx));
+        if (!c->batch_ctx)
+            goto fail;
+        for (int i = 0; i < ret; i++) {
+            SwsContext *child = c->batch_ctx[i] = sws_alloc_context();
+            if (!child)
+                goto fail;
+            sws_internal(child)->parent = sws;
+            c->nb_batch_ctx++;
+        }
+    }
+
+    /* Graphs are only reinitialized if the options actually changed */
+    for (int i = 0; i < c->nb_batch_ctx; i++) {
+        SwsContext *child = c->batch_ctx[i];
+        ret = av_opt_copy(child, sws);
+        if (ret < 0)
+            return ret;
+        child->threads = 1;
+    }
+
+    return c->nb_batch_ctx;
+
+fail:
+    batch_uninit(c);
+    return AVERROR(ENOMEM);
+}
+
+int sws_scale_frames(SwsContext *sws, AVFrame *const dst[],
+                     const AVFrame *const src[], int nb_frames)
+{
+    SwsInternal *c = sws_internal(sws);
+    int ret, sequential = nb_frames == 1 || sws->threads == 1;
+
+    if (!src || !dst || nb_frames <= 0)
+        return AVERROR(EINVAL);
+    if (c->is_legacy_init)
+        return AVERROR(ENOTSUP);
+    if ((ret = validate_params(sws)) < 0)
+        return ret;
+
+    for (int i = 0; i < nb_frames; i++) {
+        if (!src[i] || !dst[i])
+            return AVERROR(EINVAL);
+        if (src[i]->hw_frames_ctx || dst[i]->hw_frames_ctx)
+            sequential = 1; /* hardware frames are not threaded */
+    }
+
+    if (!sequential) {
+        ret = batch_init(sws);
+        if (ret == AVERROR(ENOSYS) || ret == 1)
+            sequential = 1;
+        else if (ret < 0)
+            return ret;
+    }
+
+    if (sequential) {
+        for (int i = 0; i < nb_frames; i++) {
+            ret = sws_scale_frame(sws, dst[i], src[i]);
+            if (ret < 0)
+                return ret;
+        }
+        return 0;
+    }
+
+    c->batch_dst = dst;
+    c->batch_src = src;
+    ret = avpriv_slicethread_execute2(c->batch_thread, nb_frames, 0);
+    c->batch_dst = NULL;
+    c->batch_src = NULL;
+    return ret;
+}
+
 /**
  * swscale wrapper, so we don't need to export the SwsContext.
  * Assumes planar YUV to be in YUV order instead of YVU.
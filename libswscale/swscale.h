@@ -184,6 +184,18 @@ typedef enum SwsFlags {
      */
     SWS_UNSTABLE = 1 << 20,
 
+    /**
+     * Store floating point intermediates between separate passes (e.g. the
+     * horizontal and vertical steps of a scaling chain) as half precision
+     * floats, halving the memory bandwidth spent on them. This reduces the
+     * precision of the intermediate values to 11 significant bits, so it may
+     * affect the output. Intermediates whose range does not fit into half
+     * precision are stored at full precision.
+     *
+     * Note: This is only relevant for the new code enabled by SWS_UNSTABLE.
+     */
+    SWS_HALF_FLOAT = 1 << 21,
+
     /**
      * Deprecated flags.
      */
@@ -311,6 +323,18 @@ typedef struct SwsContext {
      */
     SwsBackend backends;
 
+    /**
+     * Directory in which to cache optimized operation lists, or NULL to
+     * disable. The directory may be shared between any number of processes
+     * running the same library build, which then skip the optimization of
+     * conversions already seen by another process. The directory must not
+     * be writable by untrusted users.
+     *
+     * Note: This is only relevant for the new API (sws_scale_frame()), and
+     * only when SWS_UNSTABLE is set. Does not affect the output.
+     */
+    char *cache_dir;
+
     /* Remember to add new fields to graph.c:opts_equal() */
 } SwsContext;
 
@@ -438,6 +462,59 @@ int sws_is_noop(const AVFrame *dst, const AVFrame *src);
  */
 int sws_scale_frame(SwsContext *c, AVFrame *dst, const AVFrame *src);
 
+/**
+ * Scale source data from `src` into several destination frames at once, e.g.
+ * to generate multiple renditions of the same image.
+ *
+ * This is equivalent to calling `sws_scale_frame` once per destination frame,
+ * except that outputs are generated in order of decreasing size, and each
+ * output is downscaled from the smallest previously generated output that
+ * only differs from it in its dimensions, rather than from `src`. This avoids
+ * re-reading and re-converting the (possibly much larger) source image for
+ * every output, at the cost of slightly different results compared to
+ * scaling each output directly from the source.
+ *
+ * Only the dynamic (non-legacy) API and software frames are supported.
+ *
+ * @param ctx    The scaling context.
+ * @param dst    Array of `nb_dst` destination frames. Frames with no data
+ *               buffers allocated will be allocated using av_frame_get_buffer(),
+ *               in which case their width, height and format must be set.
+ * @param nb_dst Number of destination frames; must be positive.
+ * @param src    The source frame.
+ * @return >= 0 on success, a negative AVERROR code on failure. On failure,
+ *         the contents of the destination frames are unspecified.
+ */
+int sws_scale_frame_multi(SwsContext *ctx, AVFrame *const dst[], int nb_dst,
+                          const AVFrame *src);
+
+/**
+ * Scale a batch of independent frames, writing the result of scaling `src[i]`
+ * to `dst[i]`.
+ *
+ * This is equivalent to calling `sws_scale_frame` once per frame pair, except
+ * that whole frames are distributed across threads, rather than slices of a
+ * single frame. This avoids most of the per-frame setup and synchronization
+ * overhead, which dominates when converting many small frames, e.g. for
+ * thumbnails or preview ladders. The frames in a batch need not share the
+ * same properties.
+ *
+ * The number of frames processed in parallel is controlled by the `threads`
+ * option. Hardware frames are processed sequentially.
+ *
+ * Only the dynamic (non-legacy) API is supported.
+ *
+ * @param ctx       The scaling context.
+ * @param dst       Array of `nb_frames` destination frames, see
+ *                  `sws_scale_frame` for the allocation semantics.
+ * @param src       Array of `nb_frames` source frames.
+ * @param nb_frames Number of frames; must be positive.
+ * @return >= 0 on success, a negative AVERROR code on failure. On failure,
+ *         some of the destination frames may not have been written.
+ */
+int sws_scale_frames(SwsContext *ctx, AVFrame *const dst[],
+                     const AVFrame *const src[], int nb_frames);
+
 /**
  * Filter kernel cut-off value. Values below this (absolute) magnitude
  * are cut off from the main filter kernel. Note that the window is
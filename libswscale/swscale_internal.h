@@ -333,6 +333,12 @@ typedef void (*planarX2_YV12_fn)(uint8_t *dst, uint8_t *dst2,
 struct SwsSlice;
 struct SwsFilterDescriptor;
 
+/* Per-output state for sws_scale_frame_multi() */
+typedef struct SwsMultiOutput {
+    SwsGraph *graph[2]; /* top, bottom fields */
+    int done;           /* output was already written during this call */
+} SwsMultiOutput;
+
 /* This struct should be aligned on at least a 32-byte boundary. */
 struct SwsInternal {
     /* Currently active user-facing options. Also contains AVClass */
@@ -348,6 +354,10 @@ struct SwsInternal {
     /* Scaling graph, reinitialized dynamically as needed. */
     SwsGraph *graph[2]; /* top, bottom fields */
 
+    /* Retain the op list of compiled passes, for profiling tools. Must be
+     * set before the graph is (re)initialized. */
+    int keep_op_lists;
+
     // values passed to current sws_receive_slice() call
     int dst_slice_start;
     int dst_slice_height;
@@ -703,6 +713,18 @@ struct SwsInternal {
     int is_legacy_init;
 
     FFFramePool frame_pool; /* for sws_scale_frame() data allocations */
+
+    /* Scaling graphs used by sws_scale_frame_multi(), one set per output */
+    SwsMultiOutput *multi;
+    int          nb_multi;
+
+    /* Frame threading state used by sws_scale_frames() */
+    AVSliceThread *batch_thread;
+    SwsContext  **batch_ctx;     /* one single-threaded context per thread */
+    int        nb_batch_ctx;
+    int           batch_threads; /* value of `threads` batch_thread was created with */
+    AVFrame *const       *batch_dst;
+    const AVFrame *const *batch_src;
 };
 //FIXME check init (where 0)
 
@@ -712,7 +734,7 @@ static_assert(offsetof(SwsInternal, redDither) + DITHER32_INT == offsetof(SwsInt
 #if ARCH_X86_64
 /* x86 yuv2gbrp uses the SwsInternal for yuv coefficients
    if struct offsets change the asm needs to be updated too */
-static_assert(offsetof(SwsInternal, yuv2rgb_y_offset) == 40348,
+static_assert(offsetof(SwsInternal, yuv2rgb_y_offset) == 40364,
               "yuv2rgb_y_offset must be updated in x86 asm");
 #endif
 
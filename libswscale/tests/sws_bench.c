@@ -0,0 +1,796 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+/**
+ * End-to-end swscale benchmark. Sweeps over all combinations of the given
+ * format pairs, frame sizes, flags and thread counts, and reports the
+ * throughput of the whole conversion, of every pass in the resulting graph
+ * and (optionally) of every operation in the final, optimized op lists.
+ *
+ * Per-op timings are obtained by compiling and timing each prefix of a
+ * pass's op list (terminated by a planar write of the intermediate values)
+ * on the same backend, and attributing the difference between successive
+ * prefixes to the op in between. These are therefore approximate, and
+ * include any change in the cost of storing the intermediate result.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <inttypes.h>
+
+#include "libavutil/avassert.h"
+#include "libavutil/avstring.h"
+#include "libavutil/bprint.h"
+#include "libavutil/cpu.h"
+#include "libavutil/frame.h"
+#include "libavutil/mem.h"
+#include "libavutil/opt.h"
+#include "libavutil/parseutils.h"
+#include "libavutil/pixdesc.h"
+#include "libavutil/time.h"
+
+#include "libswscale/swscale.h"
+#include "libswscale/swscale_internal.h"
+#include "libswscale/format.h"
+#include "libswscale/graph.h"
+#include "libswscale/ops.h"
+#include "libswscale/ops_dispatch.h"
+
+#define MAX_LIST 64
+
+enum OutputFormat {
+    OUTPUT_TEXT,
+    OUTPUT_CSV,
+    OUTPUT_JSON,
+};
+
+struct size {
+    int src_w, src_h;
+    int dst_w, dst_h;
+};
+
+struct options {
+    enum AVPixelFormat src_fmts[MAX_LIST];
+    enum AVPixelFormat dst_fmts[MAX_LIST];
+    struct size sizes[MAX_LIST];
+    unsigned flags[MAX_LIST];
+    char flag_names[MAX_LIST][64];
+    int threads[MAX_LIST];
+    int nb_src_fmts;
+    int nb_dst_fmts;
+    int nb_sizes;
+    int nb_flags;
+    int nb_threads;
+    int backends;
+    int iters;
+    int ops;
+    enum OutputFormat output;
+};
+
+/* Parameters of a single benchmarked conversion */
+struct combo {
+    const char *src_fmt, *dst_fmt;
+    char src_size[32], dst_size[32];
+    const char *flags;
+    int threads;
+};
+
+/* A single line of output */
+struct record {
+    const char *kind; /* "total", "pass" or "op" */
+    int pass, op;     /* or -1 if not applicable */
+    const char *backend;
+    const char *desc;
+    double time_us;   /* average time per frame */
+    double mpix_s;    /* or <= 0 if not meaningful */
+};
+
+static const char *backend_name(SwsBackend backend)
+{
+    switch (backend) {
+    case SWS_BACKEND_LEGACY:  return "legacy";
+    case SWS_BACKEND_C:       return "c";
+    case SWS_BACKEND_MEMCPY:  return "memcpy";
+    case SWS_BACKEND_X86:     return "x86";
+    case SWS_BACKEND_AARCH64: return "aarch64";
+    case SWS_BACKEND_SPIRV:   return "spirv";
+    default:                  return "none";
+    }
+}
+
+static void print_csv_str(const char *str)
+{
+    putchar('"');
+    for (; *str; str++) {
+        if (*str == '"')
+            putchar('"');
+        putchar(*str);
+    }
+    putchar('"');
+}
+
+static void print_json_str(const char *key, const char *str)
+{
+    printf("\"%s\":\"", key);
+    for (; *str; str++) {
+        if (*str == '"' || *str == '\\')
+            putchar('\\');
+        if ((unsigned char) *str < 0x20)
+            printf("\\u%04x", *str);
+        else
+            putchar(*str);
+    }
+    printf("\",");
+}
+
+static void print_csv_header(void)
+{
+    printf("kind,src,dst,src_size,dst_size,flags,threads,pass,op,backend,desc,"
+           "time_us,mpix_s\n");
+}
+
+static void print_record(const struct options *opts, const struct combo *c,
+                         const struct record *r)
+{
+    switch (opts->output) {
+    case OUTPUT_TEXT:
+        if (r->pass < 0) {
+            printf("%s %s -> %s %s, flags=%s, threads=%d: ", c->src_fmt,
+                   c->src_size, c->dst_fmt, c->dst_size, c->flags, c->threads);
+        } else if (r->op < 0) {
+            printf("  pass #%d [%s] %s: ", r->pass, r->backend, r->desc);
+        } else {
+            printf("    op #%d: %-48s ", r->op, r->desc);
+        }
+        printf("%10.2f us", r->time_us);
+        if (r->mpix_s > 0)
+            printf(" %10.2f Mpix/s", r->mpix_s);
+        printf("\n");
+        break;
+    case OUTPUT_CSV:
+        printf("%s,%s,%s,%s,%s,%s,%d,", r->kind, c->src_fmt, c->dst_fmt,
+               c->src_size, c->dst_size, c->flags, c->threads);
+        if (r->pass >= 0)
+            printf("%d", r->pass);
+        printf(",");
+        if (r->op >= 0)
+            printf("%d", r->op);
+        printf(",%s,", r->backend ? r->backend : "");
+        print_csv_str(r->desc ? r->desc : "");
+        printf(",%.3f,", r->time_us);
+        if (r->mpix_s > 0)
+            printf("%.3f", r->mpix_s);
+        printf("\n");
+        break;
+    case OUTPUT_JSON:
+        printf("{");
+        print_json_str("kind",     r->kind);
+        print_json_str("src",      c->src_fmt);
+        print_json_str("dst",      c->dst_fmt);
+        print_json_str("src_size", c->src_size);
+        print_json_str("dst_size", c->dst_size);
+        print_json_str("flags",    c->flags);
+        printf("\"threads\":%d,", c->threads);
+        if (r->pass >= 0)
+            printf("\"pass\":%d,", r->pass);
+        if (r->op >= 0)
+            printf("\"op\":%d,", r->op);
+        if (r->backend)
+            print_json_str("backend", r->backend);
+        if (r->desc)
+            print_json_str("desc", r->desc);
+        printf("\"time_us\":%.3f", r->time_us);
+        if (r->mpix_s > 0)
+            printf(",\"mpix_s\":%.3f", r->mpix_s);
+        printf("}\n");
+        break;
+    }
+}
+
+/* Tag frames with a colorspace; not all backends support untagged YUV */
+static void set_colorspace(AVFrame *frame)
+{
+    const AVPixFmtDescriptor *desc = av_pix_fmt_desc_get(frame->format);
+
+    frame->color_primaries = AVCOL_PRI_BT709;
+    frame->color_trc       = AVCOL_TRC_BT709;
+    if (desc->flags & AV_PIX_FMT_FLAG_RGB) {
+        frame->colorspace  = AVCOL_SPC_RGB;
+        frame->color_range = AVCOL_RANGE_JPEG;
+    } else {
+        frame->colorspace  = AVCOL_SPC_BT709;
+        frame->color_range = AVCOL_RANGE_MPEG;
+    }
+}
+
+/* Fill `frame` with a smooth test pattern in its own pixel format */
+static int init_source(SwsContext *ctx, AVFrame *frame)
+{
+    AVFrame *ref = av_frame_alloc();
+    int ret;
+    if (!ref)
+        return AVERROR(ENOMEM);
+
+    ref->format = AV_PIX_FMT_RGBA;
+    ref->width  = frame->width;
+    ref->height = frame->height;
+    set_colorspace(ref);
+    ret = av_frame_get_buffer(ref, 0);
+    if (ret < 0)
+        goto end;
+
+    for (int y = 0; y < ref->height; y++) {
+        uint8_t *row = ref->data[0] + y * ref->linesize[0];
+        for (int x = 0; x < ref->width; x++) {
+            row[4 * x + 0] = x * 255 / ref->width;
+            row[4 * x + 1] = y * 255 / ref->height;
+            row[4 * x + 2] = (x + y) & 0xFF;
+            row[4 * x + 3] = 0xFF - (x & 0x7F);
+        }
+    }
+
+    ret = sws_scale_frame(ctx, frame, ref);
+
+end:
+    av_frame_free(&ref);
+    return ret;
+}
+
+static SwsPixelType op_output_type(const SwsOp *op)
+{
+    switch (op->op) {
+    case SWS_OP_READ:
+        return op->rw.filter.op ? op->rw.filter.type : op->type;
+    case SWS_OP_CONVERT:
+        return op->convert.to;
+    case SWS_OP_FILTER_H:
+    case SWS_OP_FILTER_V:
+        return op->filter.type;
+    default:
+        return op->type;
+    }
+}
+
+/* Unsubsampled planar format for storing intermediate values of `type` */
+static enum AVPixelFormat planar_format(SwsPixelType type)
+{
+    switch (type) {
+    case SWS_PIXEL_U8:  return AV_PIX_FMT_GBRAP;
+    case SWS_PIXEL_U16: return AV_PIX_FMT_GBRAP16;
+    case SWS_PIXEL_F16: return AV_PIX_FMT_GBRAPF16;
+    case SWS_PIXEL_U32:
+    case SWS_PIXEL_F32: return AV_PIX_FMT_GBRAPF32;
+    default:            return AV_PIX_FMT_NONE;
+    }
+}
+
+static const SwsOpBackend *find_backend(SwsBackend flags)
+{
+    for (int n = 0; ff_sws_op_backends[n]; n++) {
+        if (ff_sws_op_backends[n]->flags == flags)
+            return ff_sws_op_backends[n];
+    }
+    return NULL;
+}
+
+/**
+ * Compile `ops` into a single pass, and return the average time (in
+ * microseconds) needed to run it over the entire image. Takes over
+ * ownership of `ops`.
+ */
+static int time_op_list(SwsContext *ctx, const SwsOpBackend *backend,
+                        SwsOpList **ops, int iters, double *time_us)
+{
+    AVFrame *in = NULL, *out = NULL;
+    SwsGraph *graph = ff_sws_graph_alloc();
+    SwsPass *pass = NULL;
+    int ret;
+    if (!graph) {
+        ff_sws_op_list_free(ops);
+        return AVERROR(ENOMEM);
+    }
+
+    in  = av_frame_alloc();
+    out = av_frame_alloc();
+    if (!in || !out) {
+        ff_sws_op_list_free(ops);
+        ret = AVERROR(ENOMEM);
+        goto end;
+    }
+
+    in->format  = (*ops)->src.format;
+    in->width   = (*ops)->src.width;
+    in->height  = (*ops)->src.height;
+    out->format = (*ops)->dst.format;
+    out->width  = (*ops)->dst.width;
+    out->height = (*ops)->dst.height;
+    if ((ret = av_frame_get_buffer(in, 0))  < 0 ||
+        (ret = av_frame_get_buffer(out, 0)) < 0) {
+        ff_sws_op_list_free(ops);
+        goto end;
+    }
+
+    /* Arbitrary but finite values for all pixel types */
+    for (int i = 0; i < 4 && in->buf[i]; i++)
+        memset(in->buf[i]->data, 0x3C, in->buf[i]->size);
+
+    graph->ctx = ctx;
+    graph->num_threads = 1;
+    ret = ff_sws_compile_pass(graph, backend, ops, 0, NULL, &pass);
+    if (ret < 0)
+        goto end;
+    if (graph->num_passes != 1 || pass != graph->passes[0]) {
+        ret = AVERROR(ENOTSUP);
+        goto end;
+    }
+
+    SwsFrame src, dst;
+    ff_sws_frame_from_avframe(&src, in);
+    ff_sws_frame_from_avframe(&dst, out);
+    if (pass->setup && (ret = pass->setup(&dst, &src, pass)) < 0)
+        goto end;
+
+    pass->run(&dst, &src, 0, pass->lines, pass); /* warm up */
+    const int64_t start = av_gettime_relative();
+    for (int i = 0; i < iters; i++)
+        pass->run(&dst, &src, 0, pass->lines, pass);
+    *time_us = (double) (av_gettime_relative() - start) / iters;
+    ret = 0;
+
+end:
+    av_frame_free(&in);
+    av_frame_free(&out);
+    ff_sws_graph_free(&graph);
+    return ret;
+}
+
+static int bench_ops(const struct options *opts, const struct combo *c,
+                     SwsContext *ctx, const SwsPass *pass, int pass_idx)
+{
+    const SwsOpList *ops = ff_sws_pass_op_list(pass);
+    const SwsOpBackend *backend = find_backend(pass->backend);
+    if (!ops || !backend)
+        return 0;
+
+    const double pixels = (double) ops->dst.width * ops->dst.height;
+    double prev = 0.0;
+    AVBPrint bp;
+    int ret = 0;
+
+    av_bprint_init(&bp, 0, AV_BPRINT_SIZE_AUTOMATIC);
+    for (int i = 0; i < ops->num_ops; i++) {
+        const SwsOp *op = &ops->ops[i];
+        SwsOpList *prefix = ff_sws_op_list_duplicate(ops);
+        if (!prefix) {
+            ret = AVERROR(ENOMEM);
+            break;
+        }
+
+        if (op->op != SWS_OP_WRITE) {
+            /* Store all needed intermediate components as-is */
+            const SwsPixelType type = op_output_type(op);
+            int elems = 1;
+            for (int c = 0; c < 4; c++) {
+                if (SWS_OP_NEEDED(op, c))
+                    elems = c + 1;
+            }
+
+            ff_sws_op_list_remove_at(prefix, i + 1, prefix->num_ops - i - 1);
+            prefix->dst.format = planar_format(type);
+            for (int c = 0; c < 4; c++)
+                prefix->plane_dst[c] = c;
+
+            ret = ff_sws_op_list_append(prefix, &(SwsOp) {
+                .op   = SWS_OP_WRITE,
+                .type = type,
+                .rw   = { .mode = SWS_RW_PLANAR, .elems = elems },
+            });
+            if (ret < 0) {
+                ff_sws_op_list_free(&prefix);
+                break;
+            }
+            ff_sws_op_list_update_comps(prefix);
+        }
+
+        double time_us;
+        ret = time_op_list(ctx, backend, &prefix, opts->iters, &time_us);
+
+        av_bprint_clear(&bp);
+        ff_sws_op_desc(&bp, op);
+        struct record r = {
+            .kind    = "op",
+            .pass    = pass_idx,
+            .op      = i,
+            .backend = backend->name,
+            .desc    = bp.str,
+        };
+
+        if (ret < 0) {
+            av_log(NULL, AV_LOG_VERBOSE, "Failed timing op #%d of pass #%d: %s\n",
+                   i, pass_idx, av_err2str(ret));
+            ret = 0;
+            continue; /* try to time the next prefix instead */
+        }
+
+        /* Timing noise can make a prefix faster than a shorter one; never
+         * attribute a negative time to an op, and carry the difference over
+         * to the following ones instead */
+        r.time_us = FFMAX(time_us - prev, 0.0);
+        r.mpix_s  = r.time_us > 0 ? pixels / r.time_us : 0.0;
+        prev = FFMAX(prev, time_us);
+        print_record(opts, c, &r);
+    }
+
+    av_bprint_finalize(&bp, NULL);
+    return ret;
+}
+
+static int bench_combo(const struct options *opts, enum AVPixelFormat src_fmt,
+                       enum AVPixelFormat dst_fmt, const struct size *size,
+                       unsigned flags, const char *flag_names, int threads)
+{
+    SwsContext *ctx = sws_alloc_context();
+    SwsContext *ctx_src = sws_alloc_context();
+    AVFrame *src = av_frame_alloc();
+    AVFrame *dst = av_frame_alloc();
+    int64_t *pass_time = NULL;
+    struct combo c = {
+        .src_fmt = av_get_pix_fmt_name(src_fmt),
+        .dst_fmt = av_get_pix_fmt_name(dst_fmt),
+        .flags   = flag_names,
+        .threads = threads,
+    };
+    int ret;
+
+    if (!ctx || !ctx_src || !src || !dst) {
+        ret = AVERROR(ENOMEM);
+        goto end;
+    }
+
+    snprintf(c.src_size, sizeof(c.src_size), "%dx%d", size->src_w, size->src_h);
+    snprintf(c.dst_size, sizeof(c.dst_size), "%dx%d", size->dst_w, size->dst_h);
+
+    src->format = src_fmt;
+    src->width  = size->src_w;
+    src->height = size->src_h;
+    set_colorspace(src);
+    ret = init_source(ctx_src, src);
+    if (ret < 0)
+        goto end;
+
+    ctx->flags    = flags;
+    ctx->threads  = threads;
+    ctx->backends = opts->backends;
+    sws_internal(ctx)->keep_op_lists = opts->ops;
+    dst->format = dst_fmt;
+    dst->width  = size->dst_w;
+    dst->height = size->dst_h;
+    set_colorspace(dst);
+
+    /* Initializes the graph and allocates the output buffers */
+    ret = sws_scale_frame(ctx, dst, src);
+    if (ret == AVERROR(ENOTSUP) && opts->backends) {
+        /* e.g. subsampled formats with the ops backends; not an error */
+        fprintf(stderr, "%s %dx%d -> %s %dx%d: not supported by the selected "
+                "backends, skipped\n", c.src_fmt, size->src_w, size->src_h,
+                c.dst_fmt, size->dst_w, size->dst_h);
+        ret = 0;
+        goto end;
+    }
+    if (ret < 0)
+        goto end;
+
+    SwsGraph *graph = sws_internal(ctx)->graph[0];
+    if (!graph) {
+        ret = AVERROR(ENOTSUP);
+        goto end;
+    }
+
+    pass_time = av_calloc(FFMAX(graph->num_passes, 1), sizeof(*pass_time));
+    if (!pass_time) {
+        ret = AVERROR(ENOMEM);
+        goto end;
+    }
+
+    graph->pass_time = pass_time;
+    const int64_t start = av_gettime_relative();
+    for (int i = 0; i < opts->iters; i++) {
+        ret = sws_scale_frame(ctx, dst, src);
+        if (ret < 0)
+            goto end;
+    }
+    const int64_t total = av_gettime_relative() - start;
+    av_assert0(sws_internal(ctx)->graph[0] == graph && graph->pass_time == pass_time);
+    graph->pass_time = NULL;
+
+    const double time_us = (double) total / opts->iters;
+    print_record(opts, &c, &(struct record) {
+        .kind    = "total",
+        .pass    = -1,
+        .op      = -1,
+        .time_us = time_us,
+        .mpix_s  = time_us > 0 ? size->dst_w * size->dst_h / time_us : 0.0,
+    });
+
+    for (int i = 0; i < graph->num_passes; i++) {
+        const SwsPass *pass = graph->passes[i];
+        const int w = pass->output->width, h = pass->output->height;
+        const double pass_us = (double) pass_time[i] / opts->iters;
+        char desc[96];
+
+        int fused = -1;
+        for (int g = 0; g < graph->num_groups; g++) {
+            const SwsPassGroup *group = &graph->groups[g];
+            if (i > group->first_pass && i < group->first_pass + group->num_passes)
+                fused = group->first_pass;
+        }
+
+        /* Time spent on fused passes is accounted to the first pass */
+        if (fused >= 0) {
+            snprintf(desc, sizeof(desc), "%s %dx%d (fused with pass #%d)",
+                     av_get_pix_fmt_name(pass->format), w, h, fused);
+        } else {
+            snprintf(desc, sizeof(desc), "%s %dx%d",
+                     av_get_pix_fmt_name(pass->format), w, h);
+        }
+        print_record(opts, &c, &(struct record) {
+            .kind    = "pass",
+            .pass    = i,
+            .op      = -1,
+            .backend = backend_name(pass->backend),
+            .desc    = desc,
+            .time_us = pass_us,
+            .mpix_s  = pass_us > 0 ? w * h / pass_us : 0.0,
+        });
+
+        if (opts->ops) {
+            ret = bench_ops(opts, &c, ctx, pass, i);
+            if (ret < 0)
+                goto end;
+        }
+    }
+
+    ret = 0;
+
+end:
+    if (ret < 0) {
+        fprintf(stderr, "%s %dx%d -> %s %dx%d: %s\n", c.src_fmt, size->src_w,
+                size->src_h, c.dst_fmt, size->dst_w, size->dst_h, av_err2str(ret));
+    }
+    av_free(pass_time);
+    av_frame_free(&src);
+    av_frame_free(&dst);
+    sws_free_context(&ctx_src);
+    sws_free_context(&ctx);
+    return ret;
+}
+
+/* Split `str` at commas, invoking `parse` on each element */
+static int parse_list(const char *str, int *nb, int max, void *opaque,
+                      int (*parse)(void *opaque, int idx, const char *elem))
+{
+    char *buf = av_strdup(str), *saveptr = NULL;
+    int ret = 0;
+    if (!buf)
+        return AVERROR(ENOMEM);
+
+    *nb = 0;
+    for (char *elem = av_strtok(buf, ",", &saveptr); elem;
+         elem = av_strtok(NULL, ",", &saveptr)) {
+        if (*nb == max) {
+            ret = AVERROR(EINVAL);
+            break;
+        }
+        if ((ret = parse(opaque, *nb, elem)) < 0)
+            break;
+        (*nb)++;
+    }
+
+    av_free(buf);
+    return ret;
+}
+
+static int parse_fmt(void *opaque, int idx, const char *elem)
+{
+    enum AVPixelFormat *fmts = opaque;
+    fmts[idx] = av_get_pix_fmt(elem);
+    return fmts[idx] == AV_PIX_FMT_NONE ? AVERROR(EINVAL) : 0;
+}
+
+static int parse_size(void *opaque, int idx, const char *elem)
+{
+    struct size *size = &((struct size *) opaque)[idx];
+    char buf[64], *sep;
+    int ret;
+
+    av_strlcpy(buf, elem, sizeof(buf));
+    if ((sep = strchr(buf, ':')))
+        *sep++ = '\0';
+
+    ret = av_parse_video_size(&size->src_w, &size->src_h, buf);
+    if (ret < 0)
+        return ret;
+
+    size->dst_w = size->src_w;
+    size->dst_h = size->src_h;
+    if (sep)
+        return av_parse_video_size(&size->dst_w, &size->dst_h, sep);
+    return 0;
+}
+
+static int parse_flags(void *opaque, int idx, const char *elem)
+{
+    struct options *opts = opaque;
+    SwsContext *dummy = sws_alloc_context();
+    int ret, val;
+    if (!dummy)
+        return AVERROR(ENOMEM);
+
+    const AVOption *flags_opt = av_opt_find(dummy, "sws_flags", NULL, 0, 0);
+    ret = av_opt_eval_flags(dummy, flags_opt, elem, &val);
+    opts->flags[idx] = val;
+    av_strlcpy(opts->flag_names[idx], elem, sizeof(opts->flag_names[idx]));
+    sws_free_context(&dummy);
+    return ret;
+}
+
+static int parse_threads(void *opaque, int idx, const char *elem)
+{
+    int *threads = opaque;
+    char *end;
+    threads[idx] = strtol(elem, &end, 10);
+    return *end || threads[idx] < 0 ? AVERROR(EINVAL) : 0;
+}
+
+static int parse_options(int argc, char **argv, struct options *opts)
+{
+    int ret;
+
+    for (int i = 1; i < argc; i += 2) {
+        if (!strcmp(argv[i], "-help") || !strcmp(argv[i], "--help")) {
+            fprintf(stderr,
+                    "sws_bench [options...]\n"
+                    "   -help\n"
+                    "       This text\n"
+                    "   -src <pixfmt>[,<pixfmt>...]\n"
+                    "       Source pixel formats to benchmark (default: yuv420p)\n"
+                    "   -dst <pixfmt>[,<pixfmt>...]\n"
+                    "       Destination pixel formats to benchmark (default: rgba)\n"
+                    "   -s <size>[:<size>][,...]\n"
+                    "       Frame sizes (WxH or abbreviation) to benchmark (default: 1920x1080)\n"
+                    "       Optionally set destination frame size (after a ':' separator character).\n"
+                    "   -flags <flags>[,<flags>...]\n"
+                    "       Combinations of flags to benchmark (default: bicubic)\n"
+                    "   -threads <threads>[,<threads>...]\n"
+                    "       Thread counts to benchmark, 0 for automatic (default: 1)\n"
+                    "   -backends <backends>\n"
+                    "       Restrict to the given set of allowed swscale backends\n"
+                    "   -iters <iters>\n"
+                    "       Number of timed iterations for each measurement (default: 50)\n"
+                    "   -ops <1 or 0>\n"
+                    "       Report the throughput of each individual operation (default: 0)\n"
+                    "   -output <text, csv or json>\n"
+                    "       Output format; json prints one object per line (default: text)\n"
+                    "   -cpuflags <cpuflags>\n"
+                    "       Uses the specified cpuflags in the benchmarks\n"
+                    "   -v <level>\n"
+                    "       Enable log verbosity at given level\n"
+            );
+            exit(0);
+        }
+        if (argv[i][0] != '-' || i + 1 == argc)
+            goto bad_option;
+
+        const char *arg = argv[i + 1];
+        if (!strcmp(argv[i], "-src")) {
+            ret = parse_list(arg, &opts->nb_src_fmts, MAX_LIST, opts->src_fmts, parse_fmt);
+        } else if (!strcmp(argv[i], "-dst")) {
+            ret = parse_list(arg, &opts->nb_dst_fmts, MAX_LIST, opts->dst_fmts, parse_fmt);
+        } else if (!strcmp(argv[i], "-s")) {
+            ret = parse_list(arg, &opts->nb_sizes, MAX_LIST, opts->sizes, parse_size);
+        } else if (!strcmp(argv[i], "-flags")) {
+            ret = parse_list(arg, &opts->nb_flags, MAX_LIST, opts, parse_flags);
+        } else if (!strcmp(argv[i], "-threads")) {
+            ret = parse_list(arg, &opts->nb_threads, MAX_LIST, opts->threads, parse_threads);
+        } else if (!strcmp(argv[i], "-backends")) {
+            SwsContext *dummy = sws_alloc_context();
+            if (!dummy)
+                return AVERROR(ENOMEM);
+            const AVOption *backends_opt = av_opt_find(dummy, "sws_backends", NULL, 0, 0);
+            ret = av_opt_eval_flags(dummy, backends_opt, arg, &opts->backends);
+            sws_free_context(&dummy);
+        } else if (!strcmp(argv[i], "-iters")) {
+            opts->iters = atoi(arg);
+            ret = opts->iters > 0 ? 0 : AVERROR(EINVAL);
+        } else if (!strcmp(argv[i], "-ops")) {
+            opts->ops = atoi(arg);
+            ret = 0;
+        } else if (!strcmp(argv[i], "-output")) {
+            ret = 0;
+            if (!strcmp(arg, "text"))
+                opts->output = OUTPUT_TEXT;
+            else if (!strcmp(arg, "csv"))
+                opts->output = OUTPUT_CSV;
+            else if (!strcmp(arg, "json"))
+                opts->output = OUTPUT_JSON;
+            else
+                ret = AVERROR(EINVAL);
+        } else if (!strcmp(argv[i], "-cpuflags")) {
+            unsigned flags = av_get_cpu_flags();
+            ret = av_parse_cpu_caps(&flags, arg);
+            if (ret >= 0)
+                av_force_cpu_flags(flags);
+        } else if (!strcmp(argv[i], "-v")) {
+            av_log_set_level(atoi(arg));
+            ret = 0;
+        } else {
+bad_option:
+            fprintf(stderr, "bad option or argument missing (%s) see -help\n", argv[i]);
+            return AVERROR(EINVAL);
+        }
+
+        if (ret < 0) {
+            fprintf(stderr, "invalid argument for %s: %s\n", argv[i], arg);
+            return ret;
+        }
+    }
+
+    return 0;
+}
+
+int main(int argc, char **argv)
+{
+    struct options opts = {
+        .src_fmts    = { AV_PIX_FMT_YUV420P },
+        .dst_fmts    = { AV_PIX_FMT_RGBA },
+        .sizes       = {{ 1920, 1080, 1920, 1080 }},
+        .flags       = { SWS_BICUBIC },
+        .flag_names  = { "bicubic" },
+        .threads     = { 1 },
+        .nb_src_fmts = 1,
+        .nb_dst_fmts = 1,
+        .nb_sizes    = 1,
+        .nb_flags    = 1,
+        .nb_threads  = 1,
+        .iters       = 50,
+    };
+    int ret, failed = 0;
+
+    ret = parse_options(argc, argv, &opts);
+    if (ret < 0)
+        return 1;
+
+    if (opts.output == OUTPUT_CSV)
+        print_csv_header();
+
+    for (int s = 0; s < opts.nb_src_fmts; s++)
+    for (int d = 0; d < opts.nb_dst_fmts; d++)
+    for (int z = 0; z < opts.nb_sizes; z++)
+    for (int f = 0; f < opts.nb_flags; f++)
+    for (int t = 0; t < opts.nb_threads; t++) {
+        ret = bench_combo(&opts, opts.src_fmts[s], opts.dst_fmts[d],
+                          &opts.sizes[z], opts.flags[f], opts.flag_names[f],
+                          opts.threads[t]);
+        if (ret == AVERROR(ENOMEM))
+            return 1;
+        failed |= ret < 0;
+    }
+
+    return failed;
+}
@@ -283,6 +283,7 @@ static const char op_type_names[SWS_UOP_TYPE_NB][16] = {
     [SWS_UOP_TO_U8         ] = "to_u8",
     [SWS_UOP_TO_U16        ] = "to_u16",
     [SWS_UOP_TO_U32        ] = "to_u32",
+    [SWS_UOP_TO_F16        ] = "to_f16",
     [SWS_UOP_TO_F32        ] = "to_f32",
     [SWS_UOP_EXPAND_PAIR   ] = "expand_pair",
     [SWS_UOP_EXPAND_QUAD   ] = "expand_quad",
@@ -298,6 +299,7 @@ static const char pixel_type_names[SWS_PIXEL_TYPE_NB][4] = {
     [SWS_PIXEL_U8 ] = "u8",
     [SWS_PIXEL_U16] = "u16",
     [SWS_PIXEL_U32] = "u32",
+    [SWS_PIXEL_F16] = "f16",
     [SWS_PIXEL_F32] = "f32",
 };
 
@@ -321,6 +323,7 @@ static const char uop_types[SWS_UOP_TYPE_NB][32] = {
     [SWS_UOP_TO_U8         ] = "SWS_UOP_TO_U8",
     [SWS_UOP_TO_U16        ] = "SWS_UOP_TO_U16",
     [SWS_UOP_TO_U32        ] = "SWS_UOP_TO_U32",
+    [SWS_UOP_TO_F16        ] = "SWS_UOP_TO_F16",
     [SWS_UOP_TO_F32        ] = "SWS_UOP_TO_F32",
     [SWS_UOP_EXPAND_PAIR   ] = "SWS_UOP_EXPAND_PAIR",
     [SWS_UOP_EXPAND_QUAD   ] = "SWS_UOP_EXPAND_QUAD",
@@ -336,6 +339,7 @@ static const char pixel_types[SWS_PIXEL_TYPE_NB][32] = {
     [SWS_PIXEL_U8 ] = "SWS_PIXEL_U8",
     [SWS_PIXEL_U16] = "SWS_PIXEL_U16",
     [SWS_PIXEL_U32] = "SWS_PIXEL_U32",
+    [SWS_PIXEL_F16] = "SWS_PIXEL_F16",
     [SWS_PIXEL_F32] = "SWS_PIXEL_F32",
 };
 
@@ -40,12 +40,16 @@
 #include "libavutil/avassert.h"
 #include "libavutil/macros.h"
 #include "libavutil/hwcontext.h"
+#include "libavutil/imgutils.h"
 
 #include "libswscale/swscale.h"
 #include "libswscale/format.h"
 
 #define IMPL_NEW    0
 #define IMPL_LEGACY 1
+#define IMPL_BATCH  2
+
+#define BATCH_FRAMES 8
 
 struct options {
     enum AVPixelFormat src_fmt;
@@ -564,6 +568,111 @@ static int init_frame(AVFrame **pframe, const AVFrame *ref,
     return 0;
 }
 
+static int frames_differ(const AVFrame *a, const AVFrame *b)
+{
+    const AVPixFmtDescriptor *desc = av_pix_fmt_desc_get(a->format);
+    const int planes = av_pix_fmt_count_planes(a->format);
+
+    for (int p = 0; p < planes; p++) {
+        const int is_chroma = p == 1 || p == 2;
+        const int lines = is_chroma ? AV_CEIL_RSHIFT(a->height, desc->log2_chroma_h)
+                                    : a->height;
+        int bytes = av_image_get_linesize(a->format, a->width, p);
+        uint8_t mask = 0;
+        if (desc->flags & AV_PIX_FMT_FLAG_BITSTREAM) {
+            /* Ignore the padding bits after the last pixel */
+            const int pad = bytes * 8 - a->width * av_get_bits_per_pixel(desc);
+            if (pad) {
+                mask = 0xFF << pad;
+                bytes--;
+            }
+        }
+
+        for (int y = 0; y < lines; y++) {
+            const uint8_t *row_a = a->data[p] + y * a->linesize[p];
+            const uint8_t *row_b = b->data[p] + y * b->linesize[p];
+            if (memcmp(row_a, row_b, bytes) || (mask && ((row_a[bytes] ^ row_b[bytes]) & mask)))
+                return 1;
+        }
+    }
+
+    return 0;
+}
+
+/* Scales BATCH_FRAMES copies of `src` at once, and checks that all outputs
+ * are identical regardless of which thread produced them */
+static int scale_batch(AVFrame *dst, const AVFrame *src,
+                       const struct mode *mode, const struct options *opts,
+                       int64_t *out_time)
+{
+    AVFrame *dsts[BATCH_FRAMES] = { NULL };
+    const AVFrame *srcs[BATCH_FRAMES];
+
+    sws_src_dst->flags      = mode->flags;
+    sws_src_dst->dither     = mode->dither;
+    sws_src_dst->scaler     = mode->scaler;
+    sws_src_dst->scaler_sub = mode->scaler_sub;
+    sws_src_dst->threads    = opts->threads;
+    sws_src_dst->backends   = opts->backends;
+
+    int ret = sws_frame_setup(sws_src_dst, dst, src);
+    if (ret < 0) {
+        av_log(NULL, AV_LOG_ERROR, "Failed to setup %s ---> %s\n",
+               av_get_pix_fmt_name(src->format), av_get_pix_fmt_name(dst->format));
+        return ret;
+    }
+
+    for (int i = 0; i < BATCH_FRAMES; i++) {
+        srcs[i] = src;
+        ret = init_frame(&dsts[i], dst, dst->width, dst->height, dst->format);
+        if (ret < 0)
+            goto error;
+    }
+
+    int64_t time = av_gettime_relative();
+    for (int i = 0; ret >= 0 && i < opts->iters; i++) {
+        for (int j = 0; j < BATCH_FRAMES; j++) {
+            unref_buffers(dsts[j]);
+            if (opts->align_dst) {
+                ret = av_frame_get_buffer(dsts[j], opts->align_dst);
+                if (ret < 0)
+                    goto error;
+            }
+        }
+
+        ret = sws_scale_frames(sws_src_dst, dsts, srcs, BATCH_FRAMES);
+    }
+    /* Report the time per frame, for comparability with the other APIs */
+    *out_time = (av_gettime_relative() - time) / BATCH_FRAMES;
+    if (ret < 0) {
+        av_log(NULL, AV_LOG_ERROR, "Failed batch %s ---> %s\n",
+               av_get_pix_fmt_name(src->format), av_get_pix_fmt_name(dst->format));
+        goto error;
+    }
+
+    /* Legacy error diffusion carries the error over between frames unless
+     * SWS_BITEXACT is set, so low bit depth outputs may legitimately differ */
+    const AVPixFmtDescriptor *desc = av_pix_fmt_desc_get(dst->format);
+    const int check = (mode->flags & SWS_BITEXACT) || desc->comp[0].depth >= 8;
+    for (int i = 1; check && i < BATCH_FRAMES; i++) {
+        if (frames_differ(dsts[0], dsts[i])) {
+            av_log(NULL, AV_LOG_ERROR, "Batch output %d differs from output 0 "
+                   "for %s ---> %s\n", i, av_get_pix_fmt_name(src->format),
+                   av_get_pix_fmt_name(dst->format));
+            ret = -1;
+            goto error;
+        }
+    }
+
+    av_frame_unref(dst);
+    av_frame_move_ref(dst, dsts[0]);
+
+error:
+    for (int i = 0; i < BATCH_FRAMES; i++)
+        av_frame_free(&dsts[i]);
+    return ret;
+}
+
 /* Runs a series of ref -> src -> dst -> out, and compares out vs ref */
 static int run_test(enum AVPixelFormat src_fmt, enum AVPixelFormat dst_fmt,
                     int dst_w, int dst_h,
@@ -612,6 +721,7 @@ static int run_test(enum AVPixelFormat src_fmt, enum AVPixelFormat dst_fmt,
 
     ret = (opts->api == IMPL_LEGACY) ? scale_legacy(dst, src, mode, opts, &r.time)
         : hw_device_ctx              ? scale_hw(dst, src, mode, opts, &r.time)
+        : (opts->api == IMPL_BATCH)  ? scale_batch(dst, src, mode, opts, &r.time)
         :                              scale_new(dst, src, mode, opts, &r.time);
     if (ret < 0) {
         if (ret == AVERROR(ENOTSUP))
@@ -922,6 +1032,8 @@ static int parse_implementation(const char *str)
         return IMPL_LEGACY;
     if (!strcmp(str, "new"))
         return IMPL_NEW;
+    if (!strcmp(str, "batch"))
+        return IMPL_BATCH;
     return -1;
 }
 
@@ -966,8 +1078,9 @@ static int parse_options(int argc, char **argv, struct options *opts, FILE **fp)
                     "       If nonzero, allocate source buffers with a custom stride alignment\n"
                     "   -align_dst <alignment>\n"
                     "       If nonzero, allocate destination buffers with a custom stride alignment\n"
-                    "   -api <new or legacy>\n"
+                    "   -api <new, legacy or batch>\n"
                     "       Use selected swscale API for the main conversion (default: new)\n"
+                    "       'batch' converts several frames at once using sws_scale_frames()\n"
                     "   -hw <device>\n"
                     "       Use Vulkan hardware acceleration on the specified device for the main conversion\n"
                     "   -threads <threads>\n"
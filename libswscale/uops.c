@@ -55,6 +55,8 @@ static SwsPixel pixel_from_q64(SwsPixelType type, AVRational64 val)
     case SWS_PIXEL_U16: return (SwsPixel) { .u16 = val.num / val.den };
     case SWS_PIXEL_U32: return (SwsPixel) { .u32 = val.num / val.den };
     case SWS_PIXEL_F32: return (SwsPixel) { .f32 = (float) val.num / val.den };
+    case SWS_PIXEL_F16:
+        return (SwsPixel) { .f16 = ff_sws_f32_to_f16((float) val.num / val.den) };
     case SWS_PIXEL_NONE:
     case SWS_PIXEL_TYPE_NB: break;
     }
@@ -556,6 +558,7 @@ static bool is_expand_bit(SwsPixelType type, AVRational64 factor)
     case SWS_PIXEL_U8:  return factor.num == UINT8_MAX;
     case SWS_PIXEL_U16: return factor.num == UINT16_MAX;
     case SWS_PIXEL_U32: return factor.num == UINT32_MAX;
+    case SWS_PIXEL_F16:
     case SWS_PIXEL_F32: return false;
     case SWS_PIXEL_NONE:
     case SWS_PIXEL_TYPE_NB: break;
@@ -605,6 +608,7 @@ static int translate_op(SwsContext *ctx, SwsUOpList *uops, SwsUOpFlags flags,
             case SWS_PIXEL_U8:  uop.uop = SWS_UOP_TO_U8;  break;
             case SWS_PIXEL_U16: uop.uop = SWS_UOP_TO_U16; break;
             case SWS_PIXEL_U32: uop.uop = SWS_UOP_TO_U32; break;
+            case SWS_PIXEL_F16: uop.uop = SWS_UOP_TO_F16; break;
             case SWS_PIXEL_F32: uop.uop = SWS_UOP_TO_F32; break;
             }
         }
@@ -30,6 +30,7 @@
  ***************************************************************************/
 
 #include "libavutil/attributes.h"
+#include "libavutil/intfloat.h"
 
 typedef struct SwsContext       SwsContext;
 typedef struct SwsFilterWeights SwsFilterWeights;
@@ -41,6 +42,7 @@ typedef enum SwsPixelType {
     SWS_PIXEL_U8,
     SWS_PIXEL_U16,
     SWS_PIXEL_U32,
+    SWS_PIXEL_F16, /* IEEE-754 half precision; storage only, processed as F32 */
     SWS_PIXEL_F32,
     SWS_PIXEL_TYPE_NB
 } SwsPixelType;
@@ -53,6 +55,7 @@ static inline av_const int ff_sws_pixel_type_size(SwsPixelType type)
     case SWS_PIXEL_U8:  return sizeof(uint8_t);
     case SWS_PIXEL_U16: return sizeof(uint16_t);
     case SWS_PIXEL_U32: return sizeof(uint32_t);
+    case SWS_PIXEL_F16: return sizeof(uint16_t);
     case SWS_PIXEL_F32: return sizeof(float);
     case SWS_PIXEL_NONE: break;
     case SWS_PIXEL_TYPE_NB: break;
@@ -67,6 +70,7 @@ static inline av_const bool ff_sws_pixel_type_is_int(SwsPixelType type)
     case SWS_PIXEL_U16:
     case SWS_PIXEL_U32:
         return true;
+    case SWS_PIXEL_F16:
     case SWS_PIXEL_F32:
         return false;
     case SWS_PIXEL_NONE:
@@ -81,12 +85,50 @@ typedef union SwsPixel {
     uint8_t  u8;
     uint16_t u16;
     uint32_t u32;
+    uint16_t f16; /* raw IEEE-754 half precision bits */
     float    f32;
 } SwsPixel;
 
 /* Ensures (SwsPixel) {0} is properly initialized to all zeros */
 static_assert(sizeof(SwsPixel) == sizeof(char[4]), "SwsPixel size mismatch");
 
+/**
+ * Exact conversions between single and half precision floats. Rounds to
+ * nearest even and quiets NaNs, matching the behavior of the x86 F16C
+ * instructions (unlike the truncating tables in libavutil/float2half.h).
+ * Written without branches so that loops over them can be vectorized.
+ */
+static inline av_const uint16_t ff_sws_f32_to_f16(float val)
+{
+    const uint32_t bits = av_float2int(val);
+    const uint16_t sign = (bits >> 16) & 0x8000;
+    const uint32_t abs  = bits & 0x7FFFFFFF;
+
+    /* Normal results: rebias the exponent, round to nearest even */
+    const uint32_t norm = (abs - 0x38000000 + 0xFFF + ((abs >> 13) & 1)) >> 13;
+    const uint32_t nan  = 0x7E00 | ((abs >> 13) & 0x3FF);
+    const uint32_t half = abs < 0x47800000 ? norm :
+                          abs > 0x7F800000 ? nan  : 0x7C00;
+
+    /**
+     * Subnormal results: the addition aligns the lsb and rounds. Selected
+     * with a mask, since GCC will not if-convert floating point arithmetic.
+     */
+    const uint32_t sub  = av_float2int(av_int2float(abs) + 0.5f) - 0x3F000000;
+    const uint32_t mask = -(uint32_t) (abs < 0x38800000);
+    return sign | (sub & mask) | (half & ~mask);
+}
+
+static inline av_const float ff_sws_f16_to_f32(uint16_t val)
+{
+    const uint32_t sign = (uint32_t) (val & 0x8000) << 16;
+    const uint32_t bits = (uint32_t) (val & 0x7FFF) << 13;
+    /* Rebias the exponent; also normalizes subnormals */
+    const uint32_t abs  = av_float2int(av_int2float(bits) * 0x1p112f);
+    const uint32_t inf  = bits >= 0x0F800000 ? 0x7F800000 : 0;
+    return av_int2float(sign | abs | inf);
+}
+
 /**
  * Bit-mask of components. Exact meaning depends on the usage context.
  */
@@ -159,6 +201,7 @@ typedef enum SwsUOpType {
     SWS_UOP_TO_U8,           /* cast pixel values to SWS_PIXEL_U8  */
     SWS_UOP_TO_U16,          /* cast pixel values to SWS_PIXEL_U16 */
     SWS_UOP_TO_U32,          /* cast pixel values to SWS_PIXEL_U32 */
+    SWS_UOP_TO_F16,          /* cast pixel values to SWS_PIXEL_F16 */
     SWS_UOP_TO_F32,          /* cast pixel values to SWS_PIXEL_F32 */
 
     /* Arithmetic uops */
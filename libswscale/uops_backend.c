@@ -80,6 +80,7 @@
     SWS_FOR(TYPE, TO_U8,          REF_ENTRY)                \
     SWS_FOR(TYPE, TO_U16,         REF_ENTRY)                \
     SWS_FOR(TYPE, TO_U32,         REF_ENTRY)                \
+    SWS_FOR(TYPE, TO_F16,         REF_ENTRY)                \
     SWS_FOR(TYPE, TO_F32,         REF_ENTRY)                \
     SWS_FOR(TYPE, SCALE,          REF_ENTRY)                \
     SWS_FOR(TYPE, ADD,            REF_ENTRY)                \
@@ -101,6 +102,7 @@ static const SwsUOpTable uop_table = {
         REF_ALL_UOPS(U8)
         REF_ALL_UOPS(U16)
         REF_ALL_UOPS(U32)
+        REF_ALL_UOPS(F16)
         REF_ALL_UOPS(F32)
         NULL
     },
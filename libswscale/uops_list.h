@@ -44,6 +44,7 @@
     ENTRY(SWS_UOP_TO_U8,                "to_u8")                     \
     ENTRY(SWS_UOP_TO_U16,               "to_u16")                    \
     ENTRY(SWS_UOP_TO_U32,               "to_u32")                    \
+    ENTRY(SWS_UOP_TO_F16,               "to_f16")                    \
     ENTRY(SWS_UOP_TO_F32,               "to_f32")                    \
     ENTRY(SWS_UOP_SCALE,                "scale")                     \
     ENTRY(SWS_UOP_LINEAR,               "linear")                    \
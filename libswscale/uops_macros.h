@@ -257,6 +257,8 @@
 #define SWS_FOR_STRUCT_U8_TO_U32(MACRO, ...) \
     MACRO(__VA_ARGS__, u8_to_u32_x                             , .type = SWS_PIXEL_U8 , .uop = SWS_UOP_TO_U32          , .mask = 0x1) \
     MACRO(__VA_ARGS__, u8_to_u32_xyz                           , .type = SWS_PIXEL_U8 , .uop = SWS_UOP_TO_U32          , .mask = 0x7)
+#define SWS_FOR_U8_TO_F16(MACRO, ...)
+#define SWS_FOR_STRUCT_U8_TO_F16(MACRO, ...)
 #define SWS_FOR_U8_TO_F32(MACRO, ...) \
     MACRO(__VA_ARGS__, u8_to_f32_x                             , SWS_PIXEL_U8 , SWS_UOP_TO_F32          , 0x1) \
     MACRO(__VA_ARGS__, u8_to_f32_y                             , SWS_PIXEL_U8 , SWS_UOP_TO_F32          , 0x2) \
@@ -429,6 +431,7 @@
     MACRO(__VA_ARGS__, u16_permute_xyz_xz_zw                   , SWS_PIXEL_U16, SWS_UOP_PERMUTE         , 0x7, 2, 0, 2, 0, 0, 0, 0, 2, 3, 0, 0, 0, 0) \
     MACRO(__VA_ARGS__, u16_permute_xyz_yx_xw                   , SWS_PIXEL_U16, SWS_UOP_PERMUTE         , 0x7, 2, 1, 0, 0, 0, 0, 0, 0, 3, 0, 0, 0, 0) \
     MACRO(__VA_ARGS__, u16_permute_xyz_xyz_yzw                 , SWS_PIXEL_U16, SWS_UOP_PERMUTE         , 0x7, 3, 0, 1, 2, 0, 0, 0, 1, 2, 3, 0, 0, 0) \
+    MACRO(__VA_ARGS__, u16_permute_xyz_xzy_zyw                 , SWS_PIXEL_U16, SWS_UOP_PERMUTE         , 0x7, 3, 0, 2, 1, 0, 0, 0, 2, 1, 3, 0, 0, 0) \
     MACRO(__VA_ARGS__, u16_permute_xyz_xtyz_wyzt               , SWS_PIXEL_U16, SWS_UOP_PERMUTE         , 0x7, 4, 0, -1, 1, 2, 0, 0, 3, 1, 2, -1, 0, 0) \
     MACRO(__VA_ARGS__, u16_permute_xyw_x_z                     , SWS_PIXEL_U16, SWS_UOP_PERMUTE         , 0xb, 1, 0, 0, 0, 0, 0, 0, 2, 0, 0, 0, 0, 0) \
     MACRO(__VA_ARGS__, u16_permute_xzw_x_y                     , SWS_PIXEL_U16, SWS_UOP_PERMUTE         , 0xd, 1, 0, 0, 0, 0, 0, 0, 1, 0, 0, 0, 0, 0) \
@@ -451,6 +454,7 @@
     MACRO(__VA_ARGS__, u16_permute_xyz_xz_zw                   , .type = SWS_PIXEL_U16, .uop = SWS_UOP_PERMUTE         , .mask = 0x7, .par.move.num_moves = 2, .par.move.dst = {0, 2, 0, 0, 0, 0}, .par.move.src = {2, 3, 0, 0, 0, 0}) \
     MACRO(__VA_ARGS__, u16_permute_xyz_yx_xw                   , .type = SWS_PIXEL_U16, .uop = SWS_UOP_PERMUTE         , .mask = 0x7, .par.move.num_moves = 2, .par.move.dst = {1, 0, 0, 0, 0, 0}, .par.move.src = {0, 3, 0, 0, 0, 0}) \
     MACRO(__VA_ARGS__, u16_permute_xyz_xyz_yzw                 , .type = SWS_PIXEL_U16, .uop = SWS_UOP_PERMUTE         , .mask = 0x7, .par.move.num_moves = 3, .par.move.dst = {0, 1, 2, 0, 0, 0}, .par.move.src = {1, 2, 3, 0, 0, 0}) \
+    MACRO(__VA_ARGS__, u16_permute_xyz_xzy_zyw                 , .type = SWS_PIXEL_U16, .uop = SWS_UOP_PERMUTE         , .mask = 0x7, .par.move.num_moves = 3, .par.move.dst = {0, 2, 1, 0, 0, 0}, .par.move.src = {2, 1, 3, 0, 0, 0}) \
     MACRO(__VA_ARGS__, u16_permute_xyz_xtyz_wyzt               , .type = SWS_PIXEL_U16, .uop = SWS_UOP_PERMUTE         , .mask = 0x7, .par.move.num_moves = 4, .par.move.dst = {0, -1, 1, 2, 0, 0}, .par.move.src = {3, 1, 2, -1, 0, 0}) \
     MACRO(__VA_ARGS__, u16_permute_xyw_x_z                     , .type = SWS_PIXEL_U16, .uop = SWS_UOP_PERMUTE         , .mask = 0xb, .par.move.num_moves = 1, .par.move.dst = {0, 0, 0, 0, 0, 0}, .par.move.src = {2, 0, 0, 0, 0, 0}) \
     MACRO(__VA_ARGS__, u16_permute_xzw_x_y                     , .type = SWS_PIXEL_U16, .uop = SWS_UOP_PERMUTE         , .mask = 0xd, .par.move.num_moves = 1, .par.move.dst = {0, 0, 0, 0, 0, 0}, .par.move.src = {1, 0, 0, 0, 0, 0}) \
@@ -509,6 +513,8 @@
 #define SWS_FOR_STRUCT_U16_TO_U32(MACRO, ...) \
     MACRO(__VA_ARGS__, u16_to_u32_x                            , .type = SWS_PIXEL_U16, .uop = SWS_UOP_TO_U32          , .mask = 0x1) \
     MACRO(__VA_ARGS__, u16_to_u32_xyz                          , .type = SWS_PIXEL_U16, .uop = SWS_UOP_TO_U32          , .mask = 0x7)
+#define SWS_FOR_U16_TO_F16(MACRO, ...)
+#define SWS_FOR_STRUCT_U16_TO_F16(MACRO, ...)
 #define SWS_FOR_U16_TO_F32(MACRO, ...) \
     MACRO(__VA_ARGS__, u16_to_f32_x                            , SWS_PIXEL_U16, SWS_UOP_TO_F32          , 0x1) \
     MACRO(__VA_ARGS__, u16_to_f32_y                            , SWS_PIXEL_U16, SWS_UOP_TO_F32          , 0x2) \
@@ -598,6 +604,7 @@
 #define SWS_FOR_U16_CLEAR(MACRO, ...) \
     MACRO(__VA_ARGS__, u16_clear_x_x                           , SWS_PIXEL_U16, SWS_UOP_CLEAR           , 0x1, 0x00000, 0x00000) \
     MACRO(__VA_ARGS__, u16_clear_x_1                           , SWS_PIXEL_U16, SWS_UOP_CLEAR           , 0x1, 0x00001, 0x00000) \
+    MACRO(__VA_ARGS__, u16_clear_y_x                           , SWS_PIXEL_U16, SWS_UOP_CLEAR           , 0x2, 0x00000, 0x00000) \
     MACRO(__VA_ARGS__, u16_clear_y_1                           , SWS_PIXEL_U16, SWS_UOP_CLEAR           , 0x2, 0x00002, 0x00000) \
     MACRO(__VA_ARGS__, u16_clear_xy_xx                         , SWS_PIXEL_U16, SWS_UOP_CLEAR           , 0x3, 0x00000, 0x00000) \
     MACRO(__VA_ARGS__, u16_clear_xyz_xxx                       , SWS_PIXEL_U16, SWS_UOP_CLEAR           , 0x7, 0x00000, 0x00000) \
@@ -611,6 +618,7 @@
 #define SWS_FOR_STRUCT_U16_CLEAR(MACRO, ...) \
     MACRO(__VA_ARGS__, u16_clear_x_x                           , .type = SWS_PIXEL_U16, .uop = SWS_UOP_CLEAR           , .mask = 0x1, .par.clear.one = 0x0, .par.clear.zero = 0x0) \
     MACRO(__VA_ARGS__, u16_clear_x_1                           , .type = SWS_PIXEL_U16, .uop = SWS_UOP_CLEAR           , .mask = 0x1, .par.clear.one = 0x1, .par.clear.zero = 0x0) \
+    MACRO(__VA_ARGS__, u16_clear_y_x                           , .type = SWS_PIXEL_U16, .uop = SWS_UOP_CLEAR           , .mask = 0x2, .par.clear.one = 0x0, .par.clear.zero = 0x0) \
     MACRO(__VA_ARGS__, u16_clear_y_1                           , .type = SWS_PIXEL_U16, .uop = SWS_UOP_CLEAR           , .mask = 0x2, .par.clear.one = 0x2, .par.clear.zero = 0x0) \
     MACRO(__VA_ARGS__, u16_clear_xy_xx                         , .type = SWS_PIXEL_U16, .uop = SWS_UOP_CLEAR           , .mask = 0x3, .par.clear.one = 0x0, .par.clear.zero = 0x0) \
     MACRO(__VA_ARGS__, u16_clear_xyz_xxx                       , .type = SWS_PIXEL_U16, .uop = SWS_UOP_CLEAR           , .mask = 0x7, .par.clear.one = 0x0, .par.clear.zero = 0x0) \
@@ -783,6 +791,8 @@
     MACRO(__VA_ARGS__, u32_to_u16_yzw                          , .type = SWS_PIXEL_U32, .uop = SWS_UOP_TO_U16          , .mask = 0xe)
 #define SWS_FOR_U32_TO_U32(MACRO, ...)
 #define SWS_FOR_STRUCT_U32_TO_U32(MACRO, ...)
+#define SWS_FOR_U32_TO_F16(MACRO, ...)
+#define SWS_FOR_STRUCT_U32_TO_F16(MACRO, ...)
 #define SWS_FOR_U32_TO_F32(MACRO, ...) \
     MACRO(__VA_ARGS__, u32_to_f32_y                            , SWS_PIXEL_U32, SWS_UOP_TO_F32          , 0x2) \
     MACRO(__VA_ARGS__, u32_to_f32_z                            , SWS_PIXEL_U32, SWS_UOP_TO_F32          , 0x4) \
@@ -851,6 +861,112 @@
 #define SWS_FOR_STRUCT_U32_DITHER(MACRO, ...)
 #define SWS_FOR_U32_LUT_3D(MACRO, ...)
 #define SWS_FOR_STRUCT_U32_LUT_3D(MACRO, ...)
+#define SWS_FOR_F16_READ_PLANAR(MACRO, ...)
+#define SWS_FOR_STRUCT_F16_READ_PLANAR(MACRO, ...)
+#define SWS_FOR_F16_READ_PLANAR_FH(MACRO, ...) \
+    MACRO(__VA_ARGS__, f16_read_planar_fh_x_f32                , SWS_PIXEL_F16, SWS_UOP_READ_PLANAR_FH  , 0x1, SWS_PIXEL_F32) \
+    MACRO(__VA_ARGS__, f16_read_planar_fh_xy_f32               , SWS_PIXEL_F16, SWS_UOP_READ_PLANAR_FH  , 0x3, SWS_PIXEL_F32) \
+    MACRO(__VA_ARGS__, f16_read_planar_fh_xyz_f32              , SWS_PIXEL_F16, SWS_UOP_READ_PLANAR_FH  , 0x7, SWS_PIXEL_F32) \
+    MACRO(__VA_ARGS__, f16_read_planar_fh_xyzw_f32             , SWS_PIXEL_F16, SWS_UOP_READ_PLANAR_FH  , 0xf, SWS_PIXEL_F32)
+#define SWS_FOR_STRUCT_F16_READ_PLANAR_FH(MACRO, ...) \
+    MACRO(__VA_ARGS__, f16_read_planar_fh_x_f32                , .type = SWS_PIXEL_F16, .uop = SWS_UOP_READ_PLANAR_FH  , .mask = 0x1, .par.filter.type = SWS_PIXEL_F32) \
+    MACRO(__VA_ARGS__, f16_read_planar_fh_xy_f32               , .type = SWS_PIXEL_F16, .uop = SWS_UOP_READ_PLANAR_FH  , .mask = 0x3, .par.filter.type = SWS_PIXEL_F32) \
+    MACRO(__VA_ARGS__, f16_read_planar_fh_xyz_f32              , .type = SWS_PIXEL_F16, .uop = SWS_UOP_READ_PLANAR_FH  , .mask = 0x7, .par.filter.type = SWS_PIXEL_F32) \
+    MACRO(__VA_ARGS__, f16_read_planar_fh_xyzw_f32             , .type = SWS_PIXEL_F16, .uop = SWS_UOP_READ_PLANAR_FH  , .mask = 0xf, .par.filter.type = SWS_PIXEL_F32)
+#define SWS_FOR_F16_READ_PLANAR_FV(MACRO, ...) \
+    MACRO(__VA_ARGS__, f16_read_planar_fv_x_f32                , SWS_PIXEL_F16, SWS_UOP_READ_PLANAR_FV  , 0x1, SWS_PIXEL_F32) \
+    MACRO(__VA_ARGS__, f16_read_planar_fv_xy_f32               , SWS_PIXEL_F16, SWS_UOP_READ_PLANAR_FV  , 0x3, SWS_PIXEL_F32) \
+    MACRO(__VA_ARGS__, f16_read_planar_fv_xyz_f32              , SWS_PIXEL_F16, SWS_UOP_READ_PLANAR_FV  , 0x7, SWS_PIXEL_F32) \
+    MACRO(__VA_ARGS__, f16_read_planar_fv_xyzw_f32             , SWS_PIXEL_F16, SWS_UOP_READ_PLANAR_FV  , 0xf, SWS_PIXEL_F32)
+#define SWS_FOR_STRUCT_F16_READ_PLANAR_FV(MACRO, ...) \
+    MACRO(__VA_ARGS__, f16_read_planar_fv_x_f32                , .type = SWS_PIXEL_F16, .uop = SWS_UOP_READ_PLANAR_FV  , .mask = 0x1, .par.filter.type = SWS_PIXEL_F32) \
+    MACRO(__VA_ARGS__, f16_read_planar_fv_xy_f32               , .type = SWS_PIXEL_F16, .uop = SWS_UOP_READ_PLANAR_FV  , .mask = 0x3, .par.filter.type = SWS_PIXEL_F32) \
+    MACRO(__VA_ARGS__, f16_read_planar_fv_xyz_f32              , .type = SWS_PIXEL_F16, .uop = SWS_UOP_READ_PLANAR_FV  , .mask = 0x7, .par.filter.type = SWS_PIXEL_F32) \
+    MACRO(__VA_ARGS__, f16_read_planar_fv_xyzw_f32             , .type = SWS_PIXEL_F16, .uop = SWS_UOP_READ_PLANAR_FV  , .mask = 0xf, .par.filter.type = SWS_PIXEL_F32)
+#define SWS_FOR_F16_READ_PLANAR_FV_FMA(MACRO, ...) \
+    MACRO(__VA_ARGS__, f16_read_planar_fv_fma_x_f32            , SWS_PIXEL_F16, SWS_UOP_READ_PLANAR_FV_FMA, 0x1, SWS_PIXEL_F32) \
+    MACRO(__VA_ARGS__, f16_read_planar_fv_fma_xy_f32           , SWS_PIXEL_F16, SWS_UOP_READ_PLANAR_FV_FMA, 0x3, SWS_PIXEL_F32) \
+    MACRO(__VA_ARGS__, f16_read_planar_fv_fma_xyz_f32          , SWS_PIXEL_F16, SWS_UOP_READ_PLANAR_FV_FMA, 0x7, SWS_PIXEL_F32) \
+    MACRO(__VA_ARGS__, f16_read_planar_fv_fma_xyzw_f32         , SWS_PIXEL_F16, SWS_UOP_READ_PLANAR_FV_FMA, 0xf, SWS_PIXEL_F32)
+#define SWS_FOR_STRUCT_F16_READ_PLANAR_FV_FMA(MACRO, ...) \
+    MACRO(__VA_ARGS__, f16_read_planar_fv_fma_x_f32            , .type = SWS_PIXEL_F16, .uop = SWS_UOP_READ_PLANAR_FV_FMA, .mask = 0x1, .par.filter.type = SWS_PIXEL_F32) \
+    MACRO(__VA_ARGS__, f16_read_planar_fv_fma_xy_f32           , .type = SWS_PIXEL_F16, .uop = SWS_UOP_READ_PLANAR_FV_FMA, .mask = 0x3, .par.filter.type = SWS_PIXEL_F32) \
+    MACRO(__VA_ARGS__, f16_read_planar_fv_fma_xyz_f32          , .type = SWS_PIXEL_F16, .uop = SWS_UOP_READ_PLANAR_FV_FMA, .mask = 0x7, .par.filter.type = SWS_PIXEL_F32) \
+    MACRO(__VA_ARGS__, f16_read_planar_fv_fma_xyzw_f32         , .type = SWS_PIXEL_F16, .uop = SWS_UOP_READ_PLANAR_FV_FMA, .mask = 0xf, .par.filter.type = SWS_PIXEL_F32)
+#define SWS_FOR_F16_READ_PACKED(MACRO, ...)
+#define SWS_FOR_STRUCT_F16_READ_PACKED(MACRO, ...)
+#define SWS_FOR_F16_READ_NIBBLE(MACRO, ...)
+#define SWS_FOR_STRUCT_F16_READ_NIBBLE(MACRO, ...)
+#define SWS_FOR_F16_READ_BIT(MACRO, ...)
+#define SWS_FOR_STRUCT_F16_READ_BIT(MACRO, ...)
+#define SWS_FOR_F16_READ_PALETTE(MACRO, ...)
+#define SWS_FOR_STRUCT_F16_READ_PALETTE(MACRO, ...)
+#define SWS_FOR_F16_WRITE_PLANAR(MACRO, ...)
+#define SWS_FOR_STRUCT_F16_WRITE_PLANAR(MACRO, ...)
+#define SWS_FOR_F16_WRITE_PACKED(MACRO, ...)
+#define SWS_FOR_STRUCT_F16_WRITE_PACKED(MACRO, ...)
+#define SWS_FOR_F16_WRITE_NIBBLE(MACRO, ...)
+#define SWS_FOR_STRUCT_F16_WRITE_NIBBLE(MACRO, ...)
+#define SWS_FOR_F16_WRITE_BIT(MACRO, ...)
+#define SWS_FOR_STRUCT_F16_WRITE_BIT(MACRO, ...)
+#define SWS_FOR_F16_RW_SHUFFLE(MACRO, ...)
+#define SWS_FOR_STRUCT_F16_RW_SHUFFLE(MACRO, ...)
+#define SWS_FOR_F16_PERMUTE(MACRO, ...)
+#define SWS_FOR_STRUCT_F16_PERMUTE(MACRO, ...)
+#define SWS_FOR_F16_COPY(MACRO, ...)
+#define SWS_FOR_STRUCT_F16_COPY(MACRO, ...)
+#define SWS_FOR_F16_SWAP_BYTES(MACRO, ...)
+#define SWS_FOR_STRUCT_F16_SWAP_BYTES(MACRO, ...)
+#define SWS_FOR_F16_EXPAND_BIT(MACRO, ...)
+#define SWS_FOR_STRUCT_F16_EXPAND_BIT(MACRO, ...)
+#define SWS_FOR_F16_EXPAND_PAIR(MACRO, ...)
+#define SWS_FOR_STRUCT_F16_EXPAND_PAIR(MACRO, ...)
+#define SWS_FOR_F16_EXPAND_QUAD(MACRO, ...)
+#define SWS_FOR_STRUCT_F16_EXPAND_QUAD(MACRO, ...)
+#define SWS_FOR_F16_TO_U8(MACRO, ...)
+#define SWS_FOR_STRUCT_F16_TO_U8(MACRO, ...)
+#define SWS_FOR_F16_TO_U16(MACRO, ...)
+#define SWS_FOR_STRUCT_F16_TO_U16(MACRO, ...)
+#define SWS_FOR_F16_TO_U32(MACRO, ...)
+#define SWS_FOR_STRUCT_F16_TO_U32(MACRO, ...)
+#define SWS_FOR_F16_TO_F16(MACRO, ...)
+#define SWS_FOR_STRUCT_F16_TO_F16(MACRO, ...)
+#define SWS_FOR_F16_TO_F32(MACRO, ...) \
+    MACRO(__VA_ARGS__, f16_to_f32_x                            , SWS_PIXEL_F16, SWS_UOP_TO_F32          , 0x1) \
+    MACRO(__VA_ARGS__, f16_to_f32_xy                           , SWS_PIXEL_F16, SWS_UOP_TO_F32          , 0x3) \
+    MACRO(__VA_ARGS__, f16_to_f32_xyz                          , SWS_PIXEL_F16, SWS_UOP_TO_F32          , 0x7) \
+    MACRO(__VA_ARGS__, f16_to_f32_xyzw                         , SWS_PIXEL_F16, SWS_UOP_TO_F32          , 0xf)
+#define SWS_FOR_STRUCT_F16_TO_F32(MACRO, ...) \
+    MACRO(__VA_ARGS__, f16_to_f32_x                            , .type = SWS_PIXEL_F16, .uop = SWS_UOP_TO_F32          , .mask = 0x1) \
+    MACRO(__VA_ARGS__, f16_to_f32_xy                           , .type = SWS_PIXEL_F16, .uop = SWS_UOP_TO_F32          , .mask = 0x3) \
+    MACRO(__VA_ARGS__, f16_to_f32_xyz                          , .type = SWS_PIXEL_F16, .uop = SWS_UOP_TO_F32          , .mask = 0x7) \
+    MACRO(__VA_ARGS__, f16_to_f32_xyzw                         , .type = SWS_PIXEL_F16, .uop = SWS_UOP_TO_F32          , .mask = 0xf)
+#define SWS_FOR_F16_SCALE(MACRO, ...)
+#define SWS_FOR_STRUCT_F16_SCALE(MACRO, ...)
+#define SWS_FOR_F16_ADD(MACRO, ...)
+#define SWS_FOR_STRUCT_F16_ADD(MACRO, ...)
+#define SWS_FOR_F16_MIN(MACRO, ...)
+#define SWS_FOR_STRUCT_F16_MIN(MACRO, ...)
+#define SWS_FOR_F16_MAX(MACRO, ...)
+#define SWS_FOR_STRUCT_F16_MAX(MACRO, ...)
+#define SWS_FOR_F16_UNPACK(MACRO, ...)
+#define SWS_FOR_STRUCT_F16_UNPACK(MACRO, ...)
+#define SWS_FOR_F16_PACK(MACRO, ...)
+#define SWS_FOR_STRUCT_F16_PACK(MACRO, ...)
+#define SWS_FOR_F16_LSHIFT(MACRO, ...)
+#define SWS_FOR_STRUCT_F16_LSHIFT(MACRO, ...)
+#define SWS_FOR_F16_RSHIFT(MACRO, ...)
+#define SWS_FOR_STRUCT_F16_RSHIFT(MACRO, ...)
+#define SWS_FOR_F16_CLEAR(MACRO, ...)
+#define SWS_FOR_STRUCT_F16_CLEAR(MACRO, ...)
+#define SWS_FOR_F16_LINEAR(MACRO, ...)
+#define SWS_FOR_STRUCT_F16_LINEAR(MACRO, ...)
+#define SWS_FOR_F16_LINEAR_FMA(MACRO, ...)
+#define SWS_FOR_STRUCT_F16_LINEAR_FMA(MACRO, ...)
+#define SWS_FOR_F16_DITHER(MACRO, ...)
+#define SWS_FOR_STRUCT_F16_DITHER(MACRO, ...)
+#define SWS_FOR_F16_LUT_3D(MACRO, ...)
+#define SWS_FOR_STRUCT_F16_LUT_3D(MACRO, ...)
 #define SWS_FOR_F32_READ_PLANAR(MACRO, ...)
 #define SWS_FOR_STRUCT_F32_READ_PLANAR(MACRO, ...)
 #define SWS_FOR_F32_READ_PLANAR_FH(MACRO, ...) \
@@ -953,6 +1069,20 @@
     MACRO(__VA_ARGS__, f32_to_u32_xw                           , .type = SWS_PIXEL_F32, .uop = SWS_UOP_TO_U32          , .mask = 0x9) \
     MACRO(__VA_ARGS__, f32_to_u32_yzw                          , .type = SWS_PIXEL_F32, .uop = SWS_UOP_TO_U32          , .mask = 0xe) \
     MACRO(__VA_ARGS__, f32_to_u32_xyzw                         , .type = SWS_PIXEL_F32, .uop = SWS_UOP_TO_U32          , .mask = 0xf)
+#define SWS_FOR_F32_TO_F16(MACRO, ...) \
+    MACRO(__VA_ARGS__, f32_to_f16_x                            , SWS_PIXEL_F32, SWS_UOP_TO_F16          , 0x1) \
+    MACRO(__VA_ARGS__, f32_to_f16_xy                           , SWS_PIXEL_F32, SWS_UOP_TO_F16          , 0x3) \
+    MACRO(__VA_ARGS__, f32_to_f16_xyz                          , SWS_PIXEL_F32, SWS_UOP_TO_F16          , 0x7) \
+    MACRO(__VA_ARGS__, f32_to_f16_xw                           , SWS_PIXEL_F32, SWS_UOP_TO_F16          , 0x9) \
+    MACRO(__VA_ARGS__, f32_to_f16_yzw                          , SWS_PIXEL_F32, SWS_UOP_TO_F16          , 0xe) \
+    MACRO(__VA_ARGS__, f32_to_f16_xyzw                         , SWS_PIXEL_F32, SWS_UOP_TO_F16          , 0xf)
+#define SWS_FOR_STRUCT_F32_TO_F16(MACRO, ...) \
+    MACRO(__VA_ARGS__, f32_to_f16_x                            , .type = SWS_PIXEL_F32, .uop = SWS_UOP_TO_F16          , .mask = 0x1) \
+    MACRO(__VA_ARGS__, f32_to_f16_xy                           , .type = SWS_PIXEL_F32, .uop = SWS_UOP_TO_F16          , .mask = 0x3) \
+    MACRO(__VA_ARGS__, f32_to_f16_xyz                          , .type = SWS_PIXEL_F32, .uop = SWS_UOP_TO_F16          , .mask = 0x7) \
+    MACRO(__VA_ARGS__, f32_to_f16_xw                           , .type = SWS_PIXEL_F32, .uop = SWS_UOP_TO_F16          , .mask = 0x9) \
+    MACRO(__VA_ARGS__, f32_to_f16_yzw                          , .type = SWS_PIXEL_F32, .uop = SWS_UOP_TO_F16          , .mask = 0xe) \
+    MACRO(__VA_ARGS__, f32_to_f16_xyzw                         , .type = SWS_PIXEL_F32, .uop = SWS_UOP_TO_F16          , .mask = 0xf)
 #define SWS_FOR_F32_TO_F32(MACRO, ...)
 #define SWS_FOR_STRUCT_F32_TO_F32(MACRO, ...)
 #define SWS_FOR_F32_SCALE(MACRO, ...) \
@@ -53,6 +53,7 @@ static const struct {
     [SWS_PIXEL_U8]   = { "SWS_PIXEL_U8",   "U8_"  },
     [SWS_PIXEL_U16]  = { "SWS_PIXEL_U16",  "U16_" },
     [SWS_PIXEL_U32]  = { "SWS_PIXEL_U32",  "U32_" },
+    [SWS_PIXEL_F16]  = { "SWS_PIXEL_F16",  "F16_" },
     [SWS_PIXEL_F32]  = { "SWS_PIXEL_F32",  "F32_" },
 };
 
@@ -281,6 +282,7 @@ static const SwsFlags flags_list[] = {
     SWS_ACCURATE_RND,   /* may insert extra 1x1 dither ops (for accurate rounding) */
     SWS_BITEXACT,       /* prevents some FMA optimizations */
     SWS_ACCURATE_RND | SWS_BITEXACT,
+    SWS_HALF_FLOAT,     /* stores split intermediates as half floats */
 };
 
 /* Limit the range of av_tree_enumerate() to only matching uop and type */
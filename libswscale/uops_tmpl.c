@@ -439,6 +439,141 @@ DECL_CAST(U16, u16)
 DECL_CAST(U32, u32)
 DECL_CAST(F32, f32)
 
+#if IS_FLOAT
+/**
+ * Half precision floats are only used as a storage type, and only ever
+ * converted from/to F32, so both directions are implemented here.
+ */
+DECL_FUNC(to_f16, const SwsCompMask mask)
+{
+    block_t xx, yy, zz, ww;
+
+    SWS_LOOP
+    for (int i = 0; i < SWS_BLOCK_SIZE; i++) {
+        if (X) xx.u16[i] = ff_sws_f32_to_f16(x[i]);
+        if (Y) yy.u16[i] = ff_sws_f32_to_f16(y[i]);
+        if (Z) zz.u16[i] = ff_sws_f32_to_f16(z[i]);
+        if (W) ww.u16[i] = ff_sws_f32_to_f16(w[i]);
+    }
+
+    CONTINUE(&xx, &yy, &zz, &ww);
+}
+
+DECL_FUNC(from_f16, const SwsCompMask mask)
+{
+    const uint16_t *restrict hx = (const uint16_t *) x;
+    const uint16_t *restrict hy = (const uint16_t *) y;
+    const uint16_t *restrict hz = (const uint16_t *) z;
+    const uint16_t *restrict hw = (const uint16_t *) w;
+    block_t xx, yy, zz, ww;
+
+    SWS_LOOP
+    for (int i = 0; i < SWS_BLOCK_SIZE; i++) {
+        if (X) xx.f32[i] = ff_sws_f16_to_f32(hx[i]);
+        if (Y) yy.f32[i] = ff_sws_f16_to_f32(hy[i]);
+        if (Z) zz.f32[i] = ff_sws_f16_to_f32(hz[i]);
+        if (W) ww.f32[i] = ff_sws_f16_to_f32(hw[i]);
+    }
+
+    CONTINUE(&xx, &yy, &zz, &ww);
+}
+
+/**
+ * Filtered reads from half floats, e.g. from intermediate buffers between
+ * passes. Same as read_planar_fv() and read_planar_fh(), except for the
+ * conversion of each input value to F32.
+ */
+DECL_FUNC(read_planar_fv_f16, const SwsCompMask mask, const SwsPixelType type)
+{
+    av_assert2(type == SWS_PIXEL_F32);
+    const SwsOpExec *exec = iter->exec;
+    const float *restrict weights = impl->priv.ptr;
+    const int filter_size = impl->priv.i32[2];
+    const uint16_t *in0 = (const uint16_t *) iter->in[0];
+    const uint16_t *in1 = (const uint16_t *) iter->in[1];
+    const uint16_t *in2 = (const uint16_t *) iter->in[2];
+    const uint16_t *in3 = (const uint16_t *) iter->in[3];
+    weights += filter_size * iter->y;
+
+    block_t xs, ys, zs, ws;
+    if (X) memset(&xs.f32, 0, sizeof(xs.f32));
+    if (Y) memset(&ys.f32, 0, sizeof(ys.f32));
+    if (Z) memset(&zs.f32, 0, sizeof(zs.f32));
+    if (W) memset(&ws.f32, 0, sizeof(ws.f32));
+
+    for (int j = 0; j < filter_size; j++) {
+        const float weight = weights[j];
+
+        SWS_LOOP
+        for (int i = 0; i < SWS_BLOCK_SIZE; i++) {
+            if (X) xs.f32[i] += weight * ff_sws_f16_to_f32(in0[i]);
+            if (Y) ys.f32[i] += weight * ff_sws_f16_to_f32(in1[i]);
+            if (Z) zs.f32[i] += weight * ff_sws_f16_to_f32(in2[i]);
+            if (W) ws.f32[i] += weight * ff_sws_f16_to_f32(in3[i]);
+        }
+
+        if (X) in0 = (const uint16_t *) ((uintptr_t) in0 + exec->in_stride[0]);
+        if (Y) in1 = (const uint16_t *) ((uintptr_t) in1 + exec->in_stride[1]);
+        if (Z) in2 = (const uint16_t *) ((uintptr_t) in2 + exec->in_stride[2]);
+        if (W) in3 = (const uint16_t *) ((uintptr_t) in3 + exec->in_stride[3]);
+    }
+
+    if (X) iter->in[0] += sizeof(uint16_t) * SWS_BLOCK_SIZE;
+    if (Y) iter->in[1] += sizeof(uint16_t) * SWS_BLOCK_SIZE;
+    if (Z) iter->in[2] += sizeof(uint16_t) * SWS_BLOCK_SIZE;
+    if (W) iter->in[3] += sizeof(uint16_t) * SWS_BLOCK_SIZE;
+
+    CONTINUE(&xs, &ys, &zs, &ws);
+}
+
+DECL_FUNC(read_planar_fh_f16, const SwsCompMask mask, const SwsPixelType type)
+{
+    av_assert2(type == SWS_PIXEL_F32);
+    const SwsOpExec *exec = iter->exec;
+    const int *restrict weights = impl->priv.ptr;
+    const int filter_size = impl->priv.i32[2];
+    const float scale = 1.0f / SWS_FILTER_SCALE;
+    const int xpos = iter->x;
+    weights += filter_size * iter->x;
+
+    block_t xs, ys, zs, ws;
+    for (int i = 0; i < SWS_BLOCK_SIZE; i++) {
+        const int offset = exec->in_offset_x[xpos + i];
+        const uint16_t *start0 = (const uint16_t *) (iter->in[0] + offset);
+        const uint16_t *start1 = (const uint16_t *) (iter->in[1] + offset);
+        const uint16_t *start2 = (const uint16_t *) (iter->in[2] + offset);
+        const uint16_t *start3 = (const uint16_t *) (iter->in[3] + offset);
+
+        float sx = 0, sy = 0, sz = 0, sw = 0;
+        for (int j = 0; j < filter_size; j++) {
+            const int weight = weights[j];
+            if (X) sx += weight * ff_sws_f16_to_f32(start0[j]);
+            if (Y) sy += weight * ff_sws_f16_to_f32(start1[j]);
+            if (Z) sz += weight * ff_sws_f16_to_f32(start2[j]);
+            if (W) sw += weight * ff_sws_f16_to_f32(start3[j]);
+        }
+
+        if (X) xs.f32[i] = sx * scale;
+        if (Y) ys.f32[i] = sy * scale;
+        if (Z) zs.f32[i] = sz * scale;
+        if (W) ws.f32[i] = sw * scale;
+
+        weights += filter_size;
+    }
+
+    CONTINUE(&xs, &ys, &zs, &ws);
+}
+
+SWS_FOR(F32, TO_F16, DECL_IMPL, to_f16)
+SWS_FOR(F16, TO_F32, DECL_IMPL, from_f16)
+SWS_FOR(F16, READ_PLANAR_FV, DECL_IMPL, read_planar_fv_f16)
+SWS_FOR(F16, READ_PLANAR_FH, DECL_IMPL, read_planar_fh_f16)
+SWS_FOR_STRUCT(F32, TO_F16, DECL_ENTRY)
+SWS_FOR_STRUCT(F16, TO_F32, DECL_ENTRY)
+SWS_FOR_STRUCT(F16, READ_PLANAR_FV, DECL_ENTRY, .setup = fn(setup_filter_v) )
+SWS_FOR_STRUCT(F16, READ_PLANAR_FH, DECL_ENTRY, .setup = fn(setup_filter_h) )
+#endif /* IS_FLOAT */
+
 /********************
  * Bit manipulation *
  ********************/
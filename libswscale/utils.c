@@ -2258,8 +2258,18 @@ void sws_freeContext(SwsContext *sws)
 
     for (i = 0; i < FF_ARRAY_ELEMS(c->graph); i++)
         ff_sws_graph_free(&c->graph[i]);
+    for (i = 0; i < c->nb_multi; i++) {
+        ff_sws_graph_free(&c->multi[i].graph[FIELD_TOP]);
+        ff_sws_graph_free(&c->multi[i].graph[FIELD_BOTTOM]);
+    }
+    av_freep(&c->multi);
     ff_frame_pool_uninit(&c->frame_pool);
 
+    avpriv_slicethread_free(&c->batch_thread);
+    for (i = 0; i < c->nb_batch_ctx; i++)
+        sws_freeContext(c->batch_ctx[i]);
+    av_freep(&c->batch_ctx);
+
     for (i = 0; i < c->nb_slice_ctx; i++)
         sws_freeContext(c->slice_ctx[i]);
     av_freep(&c->slice_ctx);
@@ -2315,6 +2325,7 @@ void sws_freeContext(SwsContext *sws)
 
     ff_free_filters(c);
 
+    av_opt_free(sws);
     av_free(c);
 }
 
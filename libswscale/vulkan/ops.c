@@ -1126,6 +1126,9 @@ static int add_ops_spirv(SwsContext *sws, VulkanPriv *p, FFVulkanOpsCtx *s,
         int uid = cur_type == SWS_PIXEL_F32 ?
                   id->f32_p : id->u32_p;
 
+        if (op->type == SWS_PIXEL_F16 || cur_type == SWS_PIXEL_F16)
+            return AVERROR(ENOTSUP); /* TODO: half float storage */
+
         switch (op->op) {
         case SWS_OP_READ:
             if (op->rw.frac) {
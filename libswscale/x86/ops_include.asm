@@ -174,6 +174,8 @@ endstruc
         %assign BYTES 1
     %elifidn TYPE, SWS_PIXEL_U16
         %assign BYTES 2
+    %elifidn TYPE, SWS_PIXEL_F16
+        %assign BYTES 2
     %else
         %assign BYTES 4
     %endif
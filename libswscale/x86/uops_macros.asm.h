@@ -72,6 +72,7 @@
     {DEF_MACRO(TO_U8,               TYPE)}, \
     {DEF_MACRO(TO_U16,              TYPE)}, \
     {DEF_MACRO(TO_U32,              TYPE)}, \
+    {DEF_MACRO(TO_F16,              TYPE)}, \
     {DEF_MACRO(TO_F32,              TYPE)}, \
     {DEF_MACRO(SCALE,               TYPE)}, \
     {DEF_MACRO(LINEAR,              TYPE)}, \
@@ -89,4 +90,5 @@
 DEF_ALL_MACROS(U8)
 DEF_ALL_MACROS(U16)
 DEF_ALL_MACROS(U32)
+DEF_ALL_MACROS(F16)
 DEF_ALL_MACROS(F32)
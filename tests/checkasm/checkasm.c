@@ -301,6 +301,9 @@ static const CheckasmTest tests[] = {
     { "sw_yuv2yuv", checkasm_check_sw_yuv2yuv },
     { "sw_ops", checkasm_check_sw_ops },
 #endif
+#if CONFIG_SWRESAMPLE
+    { "swr_resample", checkasm_check_swr_resample },
+#endif
 #if CONFIG_AVUTIL
         { "aes",       checkasm_check_aes },
         { "crc",       checkasm_check_crc,   .uninit = checkasm_uninit_crc },
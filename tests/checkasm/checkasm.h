@@ -104,6 +104,7 @@ void checkasm_check_sw_xyz2rgb(void);
 void checkasm_check_sw_yuv2rgb(void);
 void checkasm_check_sw_yuv2yuv(void);
 void checkasm_check_sw_ops(void);
+void checkasm_check_swr_resample(void);
 void checkasm_check_takdsp(void);
 void checkasm_check_ttadsp(void);
 void checkasm_check_ttaencdsp(void);
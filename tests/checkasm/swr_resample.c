@@ -0,0 +1,173 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with FFmpeg; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <math.h>
+#include <string.h>
+
+#include "libavutil/common.h"
+#include "libavutil/intreadwrite.h"
+#include "libavutil/mem_internal.h"
+
+#include "libswresample/resample.h"
+
+#include "checkasm.h"
+
+#define PHASE_SHIFT 8
+#define PHASE_COUNT (1 << PHASE_SHIFT)
+#define MAX_FILTER  32
+#define MAX_OUT     256
+#define MAX_RATIO   3
+#define MAX_IN      (MAX_OUT * MAX_RATIO + MAX_FILTER)
+
+static const struct {
+    enum AVSampleFormat fmt;
+    const char *name;
+} formats[] = {
+    { AV_SAMPLE_FMT_S16P, "int16"  },
+    { AV_SAMPLE_FMT_S32P, "int32"  },
+    { AV_SAMPLE_FMT_FLTP, "float"  },
+    { AV_SAMPLE_FMT_DBLP, "double" },
+};
+
+static const int rates[][2] = {
+    { 48000, 44100 },
+    { 44100, 48000 },
+    { 96000, 44100 },
+    {  8000, 48000 },
+};
+
+/* Random filter taps that sum to about 1.0, zero padded up to filter_alloc */
+static void fill_filter_bank(ResampleContext *c)
+{
+    for (int p = 0; p <= c->phase_count; p++) {
+        for (int i = 0; i < c->filter_alloc; i++) {
+            const int idx = p * c->filter_alloc + i;
+            const double tap = i < c->filter_length
+                ? ((double) (rnd() & 0xFFFF) / 0x8000 - 1.0) / c->filter_length
+                : 0.0;
+            switch (c->format) {
+            case AV_SAMPLE_FMT_S16P:
+                ((int16_t *) c->filter_bank)[idx] = lrint(tap * (1 << 15));
+                break;
+            case AV_SAMPLE_FMT_S32P:
+                ((int32_t *) c->filter_bank)[idx] = lrint(tap * (1 << 30));
+                break;
+            case AV_SAMPLE_FMT_FLTP:
+                ((float *) c->filter_bank)[idx] = tap;
+                break;
+            case AV_SAMPLE_FMT_DBLP:
+                ((double *) c->filter_bank)[idx] = tap;
+                break;
+            }
+        }
+    }
+}
+
+static void fill_samples(uint8_t *buf, enum AVSampleFormat fmt, int len)
+{
+    for (int i = 0; i < len; i++) {
+        const double val = (double) rnd() / UINT_MAX * 2.0 - 1.0;
+        switch (fmt) {
+        case AV_SAMPLE_FMT_S16P: AV_WN16A(buf + 2 * i, rnd()); break;
+        case AV_SAMPLE_FMT_S32P: AV_WN32A(buf + 4 * i, rnd()); break;
+        case AV_SAMPLE_FMT_FLTP: ((float  *) buf)[i] = val;    break;
+        case AV_SAMPLE_FMT_DBLP: ((double *) buf)[i] = val;    break;
+        }
+    }
+}
+
+static int samples_equal(const uint8_t *a, const uint8_t *b,
+                         enum AVSampleFormat fmt, int len)
+{
+    switch (fmt) {
+    case AV_SAMPLE_FMT_FLTP:
+        /* SIMD implementations sum the products in a different order */
+        return float_near_abs_eps_array((const float *) a, (const float *) b,
+                                        1e-5f, len);
+    case AV_SAMPLE_FMT_DBLP:
+        return double_near_abs_eps_array((const double *) a, (const double *) b,
+                                         1e-12, len);
+    default:
+        return !memcmp(a, b, len * av_get_bytes_per_sample(fmt));
+    }
+}
+
+static void check_resample(int linear)
+{
+    LOCAL_ALIGNED_32(uint8_t, src,  [MAX_IN  * sizeof(double)]);
+    LOCAL_ALIGNED_32(uint8_t, dst0, [MAX_OUT * sizeof(double)]);
+    LOCAL_ALIGNED_32(uint8_t, dst1, [MAX_OUT * sizeof(double)]);
+    LOCAL_ALIGNED_32(uint8_t, bank, [(PHASE_COUNT + 1) * MAX_FILTER * sizeof(double)]);
+    const char *const kernel = linear ? "linear" : "common";
+
+    declare_func(int, ResampleContext *c, void *dst, const void *src,
+                 int n, int update_ctx);
+
+    for (int f = 0; f < FF_ARRAY_ELEMS(formats); f++) {
+        ResampleContext c = {
+            .filter_bank = bank,
+            .phase_count = PHASE_COUNT,
+            .format      = formats[f].fmt,
+            .felem_size  = av_get_bytes_per_sample(formats[f].fmt),
+            .linear      = linear,
+        };
+
+        swri_resample_dsp_init(&c);
+        if (!check_func(linear ? c.dsp.resample_linear : c.dsp.resample_common,
+                        "resample_%s_%s", kernel, formats[f].name))
+            continue;
+
+        for (int r = 0; r < FF_ARRAY_ELEMS(rates); r++) {
+            const int in_rate = rates[r][0], out_rate = rates[r][1];
+            const int n = 1 + rnd() % MAX_OUT;
+            ResampleContext c0, c1;
+            int ret0, ret1;
+
+            c.filter_length = 1 + rnd() % MAX_FILTER;
+            c.filter_alloc  = FFALIGN(c.filter_length, 8);
+            c.src_incr      = out_rate;
+            c.dst_incr      = in_rate * PHASE_COUNT;
+            c.ideal_dst_incr = c.dst_incr;
+            c.dst_incr_div  = c.dst_incr / c.src_incr;
+            c.dst_incr_mod  = c.dst_incr % c.src_incr;
+            c.index         = rnd() % PHASE_COUNT;
+            c.frac          = rnd() % c.src_incr;
+            fill_filter_bank(&c);
+            fill_samples(src, c.format, MAX_IN);
+
+            memset(dst0, 0, MAX_OUT * sizeof(double));
+            memset(dst1, 0, MAX_OUT * sizeof(double));
+            c0 = c1 = c;
+            ret0 = call_ref(&c0, dst0, src, n, 1);
+            ret1 = call_new(&c1, dst1, src, n, 1);
+            if (ret0 != ret1 || c0.index != c1.index || c0.frac != c1.frac ||
+                !samples_equal(dst0, dst1, c.format, n))
+                fail();
+        }
+
+        bench_new(&c, dst1, src, MAX_OUT, 0);
+    }
+
+    report("resample_%s", kernel);
+}
+
+void checkasm_check_swr_resample(void)
+{
+    check_resample(0);
+    check_resample(1);
+}
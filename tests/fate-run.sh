@@ -221,6 +221,24 @@ framemd5(){
     ffmpeg "$@" -bitexact -f framemd5 -
 }
 
+# Write the index cache of the input while seeking in it, then reopen the
+# input with the cache: print the stream parameters and the number of index
+# entries loaded from the cache, and seek again.
+index_cache(){
+    filename=$1
+    seek=$2
+    cachefile="${outdir}/${test}.idx"
+    logfile="${outdir}/${test}.log"
+    cleanfiles="$cleanfiles $cachefile $logfile"
+    rm -f $cachefile
+    ffmpeg -index_cache $(target_path $cachefile) -ss $seek -i $filename -map 0 -c copy -f null - || return
+    run ffprobe${PROGSUF}${EXECSUF} -bitexact -v verbose -index_cache $(target_path $cachefile) \
+        -of compact -show_entries stream=index,duration,avg_frame_rate,bit_rate:format=duration \
+        $filename 2> $logfile || return
+    sed -n 's/.*\(Loaded [0-9]* index entries\).*/\1/p' $logfile
+    framecrc -index_cache $(target_path $cachefile) -ss $seek -i $filename -map 0 -c copy
+}
+
 crc(){
     ffmpeg "$@" -f crc -
 }
@@ -67,6 +67,7 @@ FATE_CHECKASM = fate-checkasm-aacencdsp                                 \
                 fate-checkasm-sw_xyz2rgb                                \
                 fate-checkasm-sw_yuv2rgb                                \
                 fate-checkasm-sw_yuv2yuv                                \
+                fate-checkasm-swr_resample                              \
                 fate-checkasm-takdsp                                    \
                 fate-checkasm-ttadsp                                    \
                 fate-checkasm-ttaencdsp                                 \
@@ -189,6 +189,52 @@ fate-ts-timed-id3-hls-demux: CMD = ffprobe_demux $(TARGET_PATH)/tests/data/id3.m
 FATE_SAMPLES_DEMUX-$(call PARSERDEM, JPEGXS, IMAGE_JPEGXS_PIPE, CONCAT_PROTOCOL) += fate-jxs-concat-demux
 fate-jxs-concat-demux: CMD = framecrc "-i concat:$(TARGET_SAMPLES)/jxs/lena.jxs|$(TARGET_SAMPLES)/jxs/lena.jxs -c:v copy"
 
+# Sidecar index cache: written on a first open, used on the next one
+tests/data/index-cache.mkv tests/data/index-cache.mov: TAG = GEN
+tests/data/index-cache.mkv: ffmpeg$(PROGSSUF)$(EXESUF) | tests/data
+	$(M)$(TARGET_EXEC) $(TARGET_PATH)/$< -nostdin -v error \
+	    -f lavfi -i testsrc=s=64x48:r=25:d=4 -f lavfi -i sine=d=4 \
+	    -c:v mpeg4 -g 25 -c:a pcm_s16le \
+	    -flags +bitexact -fflags +bitexact \
+	    -f matroska $(TARGET_PATH)/$@ -y
+
+tests/data/index-cache.mov: ffmpeg$(PROGSSUF)$(EXESUF) | tests/data
+	$(M)$(TARGET_EXEC) $(TARGET_PATH)/$< -nostdin -v error \
+	    -f lavfi -i testsrc=s=64x48:r=25:d=4 -f lavfi -i sine=d=4 \
+	    -c:v mpeg4 -g 25 -c:a pcm_s16le \
+	    -movflags +frag_keyframe+empty_moov+default_base_moof \
+	    -flags +bitexact -fflags +bitexact \
+	    -f mov $(TARGET_PATH)/$@ -y
+
+tests/data/index-cache.ts: TAG = GEN
+tests/data/index-cache.ts: ffmpeg$(PROGSSUF)$(EXESUF) | tests/data
+	$(M)$(TARGET_EXEC) $(TARGET_PATH)/$< -nostdin -v error \
+	    -f lavfi -i testsrc=s=64x48:r=25:d=4 -f lavfi -i sine=d=4 \
+	    -c:v mpeg4 -g 25 -c:a mp2 \
+	    -flags +bitexact -fflags +bitexact \
+	    -f mpegts $(TARGET_PATH)/$@ -y
+
+INDEX_CACHE_DEPS = TESTSRC_FILTER SINE_FILTER MPEG4_ENCODER FRAMECRC_MUXER \
+                   NULL_MUXER FILE_PROTOCOL
+
+FATE_INDEX_CACHE-$(call ALLYES, $(INDEX_CACHE_DEPS) PCM_S16LE_ENCODER \
+                                MATROSKA_MUXER MATROSKA_DEMUXER) += fate-index-cache-matroska
+fate-index-cache-matroska: tests/data/index-cache.mkv
+fate-index-cache-matroska: CMD = index_cache $(TARGET_PATH)/tests/data/index-cache.mkv 2.5
+
+FATE_INDEX_CACHE-$(call ALLYES, $(INDEX_CACHE_DEPS) PCM_S16LE_ENCODER \
+                                MOV_MUXER MOV_DEMUXER) += fate-index-cache-mov
+fate-index-cache-mov: tests/data/index-cache.mov
+fate-index-cache-mov: CMD = index_cache $(TARGET_PATH)/tests/data/index-cache.mov 2.5
+
+FATE_INDEX_CACHE-$(call ALLYES, $(INDEX_CACHE_DEPS) MP2_ENCODER \
+                                MPEGTS_MUXER MPEGTS_DEMUXER) += fate-index-cache-mpegts
+fate-index-cache-mpegts: tests/data/index-cache.ts
+fate-index-cache-mpegts: CMD = index_cache $(TARGET_PATH)/tests/data/index-cache.ts 2.5
+
+FATE_FFMPEG_FFPROBE += $(FATE_INDEX_CACHE-yes)
+fate-index-cache: $(FATE_INDEX_CACHE-yes)
+
 FATE_SAMPLES_DEMUX += $(FATE_SAMPLES_DEMUX-yes)
 FATE_SAMPLES_FFMPEG += $(FATE_SAMPLES_DEMUX)
 FATE_FFPROBE_DEMUX   += $(FATE_FFPROBE_DEMUX-yes)
@@ -184,6 +184,12 @@ fate-filter-lavd-scalenorm: CMD = framecrc -f lavfi -graph_file $(TARGET_PATH)/t
 FATE_FILTER-$(call FILTERFRAMECRC, COLOR FORMAT SCALE CROP) += fate-filter-scale-fast-bilinear-wide-edge
 fate-filter-scale-fast-bilinear-wide-edge: CMD = framecrc -flags bitexact -lavfi color=c=red:s=40000x1:r=1:d=1,format=yuv444p,scale=40032:1:flags=fast_bilinear,crop=1:1:40031:0 -frames:v 1
 
+FATE_FILTER-$(call FILTERFRAMECRC, TESTSRC2 FORMAT SCALE_MULTI) += fate-filter-scale-multi
+fate-filter-scale-multi: CMD = framecrc -lavfi "testsrc2=r=5:d=1:s=320x240,format=yuv420p,scale_multi=sizes=160x120|-2x60|320x180"
+
+FATE_FILTER-$(call FILTERFRAMECRC, TESTSRC2 FORMAT SCALE_MULTI) += fate-filter-scale-multi-cascade
+fate-filter-scale-multi-cascade: CMD = framecrc -lavfi "testsrc2=r=5:d=1:s=320x240,format=yuv420p,scale_multi=sizes=160x120|-2x60|320x180:cascade=1"
+
 FATE_FILTER-$(call FILTERFRAMECRC, TESTSRC2 FEEDBACK HFLIP, LAVFI_INDEV) += fate-filter-feedback-hflip
 fate-filter-feedback-hflip: CMD = framecrc -f lavfi -i testsrc2=d=1 -vf "[in][hflipin]feedback=x=0:y=0:w=100:h=100[out][hflipout];[hflipout]hflip[hflipin]"
 
@@ -1047,6 +1047,53 @@ fate-swr-resample_exact_lin_async-s32p-8000-44100: SIZE_TOLERANCE = 96000 - 2035
 fate-swr-resample_exact_lin_async-s32p-8000-48000: CMP_TARGET = 10371.53
 fate-swr-resample_exact_lin_async-s32p-8000-48000: SIZE_TOLERANCE = 96000 - 20350
 
+define ARESAMPLE_MINPHASE
+FATE_SWR_RESAMPLE += fate-swr-resample_minphase-$(3)-$(1)-$(2)
+fate-swr-resample_minphase-$(3)-$(1)-$(2): tests/data/asynth-$(1)-1.wav
+fate-swr-resample_minphase-$(3)-$(1)-$(2): CMD = ffmpeg -i $(TARGET_PATH)/tests/data/asynth-$(1)-1.wav -af atrim=end_sample=10240,aresample=$(2):max_delay=8:internal_sample_fmt=$(3),aformat=$(3),aresample=$(1):max_delay=8:internal_sample_fmt=$(3) -f wav -c:a pcm_s16le -
+
+fate-swr-resample_minphase-$(3)-$(1)-$(2): CMP = stddev
+fate-swr-resample_minphase-$(3)-$(1)-$(2): CMP_UNIT = $(5)
+fate-swr-resample_minphase-$(3)-$(1)-$(2): FUZZ = 0.1
+fate-swr-resample_minphase-$(3)-$(1)-$(2): REF = tests/data/asynth-$(1)-1.wav
+endef
+
+fate-swr-resample_minphase-s16p-44100-48000: CMP_TARGET = 10.68
+fate-swr-resample_minphase-s16p-44100-48000: SIZE_TOLERANCE = 529200 - 20482
+
+fate-swr-resample_minphase-s16p-44100-8000: CMP_TARGET = 350.03
+fate-swr-resample_minphase-s16p-44100-8000: SIZE_TOLERANCE = 529200 - 20486
+
+fate-swr-resample_minphase-s16p-48000-44100: CMP_TARGET = 4.09
+fate-swr-resample_minphase-s16p-48000-44100: SIZE_TOLERANCE = 576000 - 20480
+
+fate-swr-resample_minphase-s16p-48000-8000: CMP_TARGET = 351.57
+fate-swr-resample_minphase-s16p-48000-8000: SIZE_TOLERANCE = 576000 - 20484
+
+fate-swr-resample_minphase-s16p-8000-44100: CMP_TARGET = 1142.37
+fate-swr-resample_minphase-s16p-8000-44100: SIZE_TOLERANCE = 96000 - 20480
+
+fate-swr-resample_minphase-s16p-8000-48000: CMP_TARGET = 1376.51
+fate-swr-resample_minphase-s16p-8000-48000: SIZE_TOLERANCE = 96000 - 20480
+
+fate-swr-resample_minphase-fltp-44100-48000: CMP_TARGET = 10.67
+fate-swr-resample_minphase-fltp-44100-48000: SIZE_TOLERANCE = 529200 - 20482
+
+fate-swr-resample_minphase-fltp-44100-8000: CMP_TARGET = 349.94
+fate-swr-resample_minphase-fltp-44100-8000: SIZE_TOLERANCE = 529200 - 20486
+
+fate-swr-resample_minphase-fltp-48000-44100: CMP_TARGET = 4.08
+fate-swr-resample_minphase-fltp-48000-44100: SIZE_TOLERANCE = 576000 - 20480
+
+fate-swr-resample_minphase-fltp-48000-8000: CMP_TARGET = 351.88
+fate-swr-resample_minphase-fltp-48000-8000: SIZE_TOLERANCE = 576000 - 20484
+
+fate-swr-resample_minphase-fltp-8000-44100: CMP_TARGET = 1142.35
+fate-swr-resample_minphase-fltp-8000-44100: SIZE_TOLERANCE = 96000 - 20480
+
+fate-swr-resample_minphase-fltp-8000-48000: CMP_TARGET = 1376.57
+fate-swr-resample_minphase-fltp-8000-48000: SIZE_TOLERANCE = 96000 - 20480
+
 $(call CROSS_TEST,$(SAMPLERATES),ARESAMPLE,s16p,s16le,s16)
 $(call CROSS_TEST,$(SAMPLERATES),ARESAMPLE,s32p,s32le,s16)
 $(call CROSS_TEST,$(SAMPLERATES),ARESAMPLE,fltp,f32le,s16)
@@ -1082,6 +1129,9 @@ $(call CROSS_TEST,$(SAMPLERATES_LITE),ARESAMPLE_EXACT_LIN_ASYNC,s32p,s32le,s16)
 $(call CROSS_TEST,$(SAMPLERATES_LITE),ARESAMPLE_EXACT_LIN_ASYNC,fltp,f32le,s16)
 $(call CROSS_TEST,$(SAMPLERATES_LITE),ARESAMPLE_EXACT_LIN_ASYNC,dblp,f64le,s16)
 
+$(call CROSS_TEST,$(SAMPLERATES_LITE),ARESAMPLE_MINPHASE,s16p,s16le,s16)
+$(call CROSS_TEST,$(SAMPLERATES_LITE),ARESAMPLE_MINPHASE,fltp,f32le,s16)
+
 FATE_SWR_RESAMPLE-$(call FILTERDEMDEC, ARESAMPLE ASETPTS ATRIM SINE, , PCM_S16LE, LAVFI_INDEV) += fate-swr-async-firstpts
 fate-swr-async-firstpts: CMD = framecrc -auto_conversion_filters -copyts -f lavfi -i "sine=r=1000:samples_per_frame=100,asetpts=PTS+S+S*floor(ld(1)/4)+st(1\,ld(1)+1)*0,atrim=end=2" -filter:a aresample=async=300:first_pts=0
 
@@ -1106,6 +1156,23 @@ fate-swr-custom-rematrix: REF = 2a14a44deb4ae26e3b474ddbfbc048f8
 
 FATE_SWR += $(FATE_SWR_CUSTOM_REMATRIX-yes)
 
+# must match the single threaded output
+FATE_SWR_THREADS-$(call FILTERDEMDECENCMUX, ARESAMPLE, WAV, PCM_S16LE, PCM_S16LE, PCM_S16LE) += fate-swr-resample-threads
+fate-swr-resample-threads: tests/data/asynth-44100-8.wav
+fate-swr-resample-threads: CMD = md5 -i $(TARGET_PATH)/tests/data/asynth-44100-8.wav -af aresample=48000:internal_sample_fmt=fltp:threads=4 -f s16le
+fate-swr-resample-threads: CMP = oneline
+fate-swr-resample-threads: REF = 7a72b7cdb71c66be4f3bb9b19f2145b0
+
+FATE_SWR += $(FATE_SWR_THREADS-yes)
+
+FATE_SWR_DOWNMIX-$(call FILTERDEMDECENCMUX, ARESAMPLE, WAV, PCM_S16LE, PCM_S16LE, PCM_S16LE) += fate-swr-downmix-resample
+fate-swr-downmix-resample: tests/data/asynth-44100-8.wav
+fate-swr-downmix-resample: CMD = md5 -i $(TARGET_PATH)/tests/data/asynth-44100-8.wav -af aresample=48000:ochl=stereo:osf=s16 -f s16le
+fate-swr-downmix-resample: CMP = oneline
+fate-swr-downmix-resample: REF = 20d888bd35e7aab76c91a2546306de60
+
+FATE_SWR += $(FATE_SWR_DOWNMIX-yes)
+
 FATE_SWR_22_2_LAYOUTS   = 9.1.6 9.1.4 7.2.3 7.1.4 7.1.2 5.1.4 5.1.2 7.1 5.1 stereo mono
 FATE_SWR_9_1_6_LAYOUTS  = 9.1.4 7.2.3 7.1.4 7.1.2 5.1.4 5.1.2 7.1 5.1 stereo mono
 FATE_SWR_9_1_4_LAYOUTS  = 7.2.3 7.1.4 7.1.2 5.1.4 5.1.2 7.1 5.1 stereo mono
@@ -41,6 +41,12 @@ FATE_LIBSWSCALE-$(CONFIG_UNSTABLE) += fate-sws-unstable
 fate-sws-unstable: libswscale/tests/swscale$(EXESUF)
 fate-sws-unstable: CMD = run libswscale/tests/swscale$(EXESUF) -backends unstable -p 0.02 -v 16
 
+# Same for batched conversions of small frames, which also checks that every
+# frame in the batch produces the same output
+FATE_LIBSWSCALE-$(CONFIG_UNSTABLE) += fate-sws-batch
+fate-sws-batch: libswscale/tests/swscale$(EXESUF)
+fate-sws-batch: CMD = run libswscale/tests/swscale$(EXESUF) -api batch -threads 4 -s 64x64 -backends unstable -p 0.01 -v 16
+
 ifneq ($(HAVE_BIGENDIAN),yes)
 
 # Disable on big endian because big endian platforms generate different op
@@ -326,6 +326,73 @@ tests/data/mov-vfr-bframes-derived-duration.mov: ffmpeg$(PROGSSUF)$(EXESUF) | te
 fate-mov-vfr-bframes-derived-duration: tests/data/mov-vfr-bframes-derived-duration.mov
 fate-mov-vfr-bframes-derived-duration: CMD = run ffprobe$(PROGSSUF)$(EXESUF) -show_packets -show_entries packet=pts,dts,duration -print_format compact -select_streams v -v 0 $(TARGET_PATH)/tests/data/mov-vfr-bframes-derived-duration.mov
 
+FATE_MOV_FFMPEG-$(call ALLYES, TESTSRC_FILTER SINE_FILTER RAWVIDEO_ENCODER \
+                              PCM_S16LE_ENCODER MOV_MUXER MOV_DEMUXER     \
+                              FRAMECRC_MUXER FILE_PROTOCOL) += fate-mov-mmap
+
+# Read packets straight from a memory mapping of the input file
+tests/data/mov-mmap.mov: TAG = GEN
+tests/data/mov-mmap.mov: ffmpeg$(PROGSSUF)$(EXESUF) | tests/data
+	$(M)$(TARGET_EXEC) $(TARGET_PATH)/$< -nostdin -v error \
+	    -f lavfi -i testsrc=s=64x48:r=25:d=1 -f lavfi -i sine=d=1 \
+	    -c:v rawvideo -pix_fmt uyvy422 -c:a pcm_s16le \
+	    -flags +bitexact -fflags +bitexact \
+	    -f mov $(TARGET_PATH)/$@ -y
+
+fate-mov-mmap: tests/data/mov-mmap.mov
+fate-mov-mmap: CMD = framecrc -mmap 1 -i $(TARGET_PATH)/tests/data/mov-mmap.mov -map 0 -c copy
+
+# Same input, read ahead through io_uring where available
+FATE_MOV_FFMPEG-$(call ALLYES, TESTSRC_FILTER SINE_FILTER RAWVIDEO_ENCODER \
+                              PCM_S16LE_ENCODER MOV_MUXER MOV_DEMUXER     \
+                              FRAMECRC_MUXER FILE_PROTOCOL) += fate-mov-io-uring
+fate-mov-io-uring: tests/data/mov-mmap.mov
+fate-mov-io-uring: CMD = framecrc -io_uring 1 -i $(TARGET_PATH)/tests/data/mov-mmap.mov -map 0 -c copy
+fate-mov-io-uring: REF = $(SRC_PATH)/tests/ref/fate/mov-mmap
+
+# Samples resolved from the sample tables without a full index, on an input
+# with B-frames (ctts), sparse keyframes (stss) and an AAC priming edit.
+# The AAC encoder is not bitexact across platforms, so each test is compared
+# to the output of the same command with the full index instead of a ref.
+tests/data/mov-lazy-index.mp4: TAG = GEN
+tests/data/mov-lazy-index.mp4: ffmpeg$(PROGSSUF)$(EXESUF) | tests/data
+	$(M)$(TARGET_EXEC) $(TARGET_PATH)/$< -nostdin -v error \
+	    -f lavfi -i testsrc=s=64x48:r=25:d=4 -f lavfi -i sine=d=4 \
+	    -c:v mpeg4 -bf 2 -g 40 -c:a aac -b:a 64k \
+	    -flags +bitexact -fflags +bitexact \
+	    -f mp4 $(TARGET_PATH)/$@ -y
+
+FATE_MOV_LAZY_INDEX = fate-mov-lazy-index fate-mov-lazy-index-ss-0.5 \
+                      fate-mov-lazy-index-ss-1.72 fate-mov-lazy-index-ss-3.3
+MOV_LAZY_INDEX_REFS = $(FATE_MOV_LAZY_INDEX:fate-%=tests/data/fate/%.full)
+
+$(MOV_LAZY_INDEX_REFS): TAG = GEN
+$(MOV_LAZY_INDEX_REFS): tests/data/fate/%.full: ffmpeg$(PROGSSUF)$(EXESUF) tests/data/mov-lazy-index.mp4 | tests/data/fate
+	$(M)$(TARGET_EXEC) $(TARGET_PATH)/$< -nostdin -v error -lazy_index 0 \
+	    $(subst -ss-,-ss ,$(*:mov-lazy-index%=%)) \
+	    -i $(TARGET_PATH)/tests/data/mov-lazy-index.mp4 -map 0 -c copy \
+	    -bitexact -f framecrc - > $(TARGET_PATH)/$@
+
+$(FATE_MOV_LAZY_INDEX): fate-%: tests/data/fate/%.full
+$(FATE_MOV_LAZY_INDEX): CMD = framecrc -lazy_index 1 $(subst -ss-,-ss ,$(@:fate-mov-lazy-index%=%)) \
+                              -i $(TARGET_PATH)/tests/data/mov-lazy-index.mp4 -map 0 -c copy
+$(FATE_MOV_LAZY_INDEX): REF = tests/data/fate/$(@:fate-%=%).full
+
+tests/data/fate/mov-lazy-index-seek.full: TAG = GEN
+tests/data/fate/mov-lazy-index-seek.full: libavformat/tests/seek$(EXESUF) tests/data/mov-lazy-index.mp4 | tests/data/fate
+	$(M)$(TARGET_EXEC) $(TARGET_PATH)/$< \
+	    $(TARGET_PATH)/tests/data/mov-lazy-index.mp4 -lazy_index 0 > $(TARGET_PATH)/$@
+
+fate-mov-lazy-index-seek: tests/data/fate/mov-lazy-index-seek.full
+fate-mov-lazy-index-seek: CMD = run libavformat/tests/seek$(EXESUF) \
+                                $(TARGET_PATH)/tests/data/mov-lazy-index.mp4 -lazy_index 1
+fate-mov-lazy-index-seek: REF = tests/data/fate/mov-lazy-index-seek.full
+
+FATE_MOV_FFMPEG-$(call ALLYES, TESTSRC_FILTER SINE_FILTER MPEG4_ENCODER   \
+                              AAC_ENCODER MP4_MUXER MOV_DEMUXER          \
+                              FRAMECRC_MUXER FILE_PROTOCOL) += $(FATE_MOV_LAZY_INDEX) \
+                                                             fate-mov-lazy-index-seek
+
 FATE_MOV_FFMPEG_FFPROBE-$(call TRANSCODE, FLAC, MP4 MOV, WAV_DEMUXER PCM_S16LE_DECODER) += fate-mov-mp4-iamf-stereo
 fate-mov-mp4-iamf-stereo: tests/data/asynth-44100-2.wav tests/data/streamgroups/audio_element-stereo tests/data/streamgroups/mix_presentation-stereo
 fate-mov-mp4-iamf-stereo: SRC = $(TARGET_PATH)/tests/data/asynth-44100-2.wav